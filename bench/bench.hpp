@@ -0,0 +1,70 @@
+#pragma once
+#include "domain/models/media_types.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace app::bench
+{
+    // Plain wall-clock benchmarks, one per change they were written for. Each registers
+    // itself with APP_BENCHMARK; streaming_app_bench runs those whose name contains one of
+    // its arguments, or all of them. Build with -DBUILD_BENCHMARKS=ON, in Release.
+    using BenchFunction = void (*)();
+
+    struct Registration
+    {
+        Registration(const char *name, BenchFunction run);
+    };
+
+#define APP_BENCHMARK(name)                                                  \
+    static void name();                                                      \
+    static const ::app::bench::Registration name##Registration(#name, name); \
+    static void name()
+
+    // Folds a result into a volatile, so the optimizer cannot drop the work that made it
+    void Consume(size_t value);
+
+    // Mean microseconds per call, over at least minTime and three calls, after one warm-up call
+    template <typename F>
+    double MeasureMicros(F &&body, std::chrono::milliseconds minTime = std::chrono::milliseconds(300))
+    {
+        body();
+        size_t calls = 0;
+        const auto start = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::steady_clock::duration::zero();
+        while (calls < 3 || elapsed < minTime)
+        {
+            body();
+            ++calls;
+            elapsed = std::chrono::steady_clock::now() - start;
+        }
+        return std::chrono::duration<double, std::micro>(elapsed).count() / static_cast<double>(calls);
+    }
+
+    // The same for work that consumes its input: prepare runs before each call, untimed
+    template <typename Prepare, typename F>
+    double MeasureMicrosAfter(Prepare &&prepare, F &&body, std::chrono::milliseconds minTime = std::chrono::milliseconds(300))
+    {
+        prepare();
+        body();
+        size_t calls = 0;
+        auto timed = std::chrono::steady_clock::duration::zero();
+        while (calls < 3 || timed < minTime)
+        {
+            prepare();
+            const auto start = std::chrono::steady_clock::now();
+            body();
+            timed += std::chrono::steady_clock::now() - start;
+            ++calls;
+        }
+        return std::chrono::duration<double, std::micro>(timed).count() / static_cast<double>(calls);
+    }
+
+    // One result line: what was measured, and the mean time per call
+    void Report(const std::string &label, double micros);
+
+    // TMDB-shaped items with unique ids, titles made of common words, 200-400 byte overviews
+    // and the usual optional fields, the same for a given seed
+    std::vector<domain::MediaMetadata> MakeCatalog(size_t count, uint32_t seed = 1);
+} // namespace app::bench
@@ -0,0 +1,108 @@
+#include "bench.hpp"
+#include <fmt/format.h>
+#include <random>
+#include <string_view>
+#include <utility>
+
+namespace app::bench
+{
+    namespace
+    {
+        std::vector<std::pair<const char *, BenchFunction>> &Benchmarks()
+        {
+            static std::vector<std::pair<const char *, BenchFunction>> benchmarks;
+            return benchmarks;
+        }
+
+        volatile size_t sink = 0;
+
+        constexpr const char *kWords[] = {
+            "star", "wars", "the", "return", "of", "king", "dark", "knight", "night", "blade", "runner", "lord",
+            "rings", "matrix", "alien", "life", "love", "war", "last", "first", "man", "woman", "city", "river",
+            "house", "game", "story", "world", "ghost", "storm", "winter", "summer", "secret", "lost", "empire",
+            "legend", "shadow", "fire", "ice", "dream", "home", "road", "sea", "sky", "moon", "sun", "heart", "time"};
+        constexpr const char *kGenres[] = {"Action", "Drama", "Comedy", "Thriller", "Horror", "Romance", "Documentary",
+                                           "Animation", "Science Fiction", "Fantasy", "Crime", "Family"};
+    }
+
+    Registration::Registration(const char *name, BenchFunction run)
+    {
+        Benchmarks().emplace_back(name, run);
+    }
+
+    void Consume(size_t value)
+    {
+        sink = sink + value;
+    }
+
+    void Report(const std::string &label, double micros)
+    {
+        if (micros >= 1000.0)
+            fmt::print("  {:<56} {:>10.2f} ms\n", label, micros / 1000.0);
+        else
+            fmt::print("  {:<56} {:>10.2f} us\n", label, micros);
+    }
+
+    std::vector<domain::MediaMetadata> MakeCatalog(size_t count, uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        const auto pick = [&random](const auto &list)
+        { return list[random() % std::size(list)]; };
+
+        std::vector<domain::MediaMetadata> items(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto &item = items[i];
+            item.id.id = std::to_string(100000 + i);
+            item.id.type = i % 4 ? domain::MediaType::Movie : domain::MediaType::TvShow;
+            item.id.source = "tmdb";
+
+            const size_t words = 1 + random() % 4;
+            for (size_t w = 0; w < words; ++w)
+            {
+                item.title += w ? " " : "";
+                item.title += pick(kWords);
+            }
+            if (i % 7 == 0)
+                item.title += fmt::format(" {}", 2 + random() % 4);
+            if (i % 5 == 0)
+                item.originalTitle = item.title + " (original)";
+
+            item.overview = fmt::format("{:x} ", random()) + std::string(200 + random() % 200, 'o');
+            for (size_t g = 1 + random() % 3; g > 0; --g)
+            {
+                item.genres.Add(pick(kGenres));
+            }
+            item.releaseDate = std::chrono::sys_days(std::chrono::days(random() % 20000));
+            item.rating = static_cast<float>(random() % 100) / 10.0f;
+            item.voteCount = static_cast<int>(random() % 20000);
+            item.popularity = static_cast<float>(random() % 10000) / 10.0f;
+            item.normalizedRating = item.rating / 10.0f;
+            item.posterPath = domain::ImagePath::FromUrl(fmt::format("https://image.tmdb.org/t/p/w500/p{:x}.jpg", random()));
+            if (i % 2)
+                item.backdropPath = domain::ImagePath::FromUrl(fmt::format("https://image.tmdb.org/t/p/w1280/b{:x}.jpg", random()));
+            if (i % 3)
+                item.externalIds.imdb = fmt::format("tt{:07}", random() % 9999999);
+            item.externalIds.tmdb = item.id.id;
+        }
+        return items;
+    }
+} // namespace app::bench
+
+int main(int argc, char **argv)
+{
+    for (const auto &[name, run] : app::bench::Benchmarks())
+    {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i)
+        {
+            selected = selected || std::string_view(name).find(argv[i]) != std::string_view::npos;
+        }
+        if (selected)
+        {
+            fmt::print("{}\n", name);
+            run();
+        }
+    }
+    return 0;
+}
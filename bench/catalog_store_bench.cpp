@@ -0,0 +1,62 @@
+#include "bench.hpp"
+#include "services/catalog/catalog_store.hpp"
+#include <fmt/format.h>
+
+namespace
+{
+    using namespace app;
+
+    // What answering a browse filter took before the store: a walk over the full rows
+    size_t WalkRows(const std::vector<domain::MediaMetadata> &items, const services::CatalogQuery &query)
+    {
+        size_t matches = 0;
+        for (const auto &item : items)
+        {
+            if (query.type && item.id.type != *query.type)
+                continue;
+            const int year = static_cast<int>(std::chrono::year_month_day(std::chrono::floor<std::chrono::days>(item.releaseDate)).year());
+            if ((query.minYear && year < query.minYear) || (query.maxYear && year > query.maxYear))
+                continue;
+            if (item.normalizedRating < query.minRating || item.voteCount < query.minVotes)
+                continue;
+            bool genre = query.genres.empty();
+            for (const auto &name : query.genres)
+            {
+                genre = genre || item.genres.Contains(name);
+            }
+            matches += genre;
+        }
+        return matches;
+    }
+}
+
+// CatalogStore's block scan over 1M rows, against walking the MediaMetadata rows
+APP_BENCHMARK(CatalogStoreMillionRows)
+{
+    const auto items = bench::MakeCatalog(1000000);
+    auto &store = services::CatalogStore::Instance();
+    store.Add(items);
+
+    services::CatalogQuery query;
+    query.type = domain::MediaType::Movie;
+    query.genres = {"Action"};
+    query.minYear = 1990;
+    query.maxYear = 2010;
+    query.minRating = 0.7f;
+    query.minVotes = 1000;
+
+    services::CatalogQuery ratingOnly;
+    ratingOnly.minRating = 0.9f;
+
+    fmt::print("  {} rows; type, genre, year range, rating and votes match {}\n", store.Size(), store.Filter(query).size());
+    bench::Report("walk over MediaMetadata, 5 predicates", bench::MeasureMicros([&]
+                                                                              { bench::Consume(WalkRows(items, query)); }));
+    bench::Report("CatalogStore::Filter, 5 predicates", bench::MeasureMicros([&]
+                                                                           { bench::Consume(store.Filter(query).size()); }));
+    bench::Report(fmt::format("CatalogStore::Filter, rating only ({} rows)", store.Filter(ratingOnly).size()),
+                  bench::MeasureMicros([&]
+                                       { bench::Consume(store.Filter(ratingOnly).size()); }));
+    bench::Report("CatalogStore::Browse, 5 predicates, top 50 by rating",
+                  bench::MeasureMicros([&]
+                                       { bench::Consume(store.Browse(query, {services::SortField::Rating, true}, 0, 50).total); }));
+}
@@ -0,0 +1,60 @@
+#include "bench.hpp"
+#include "core/utils/request_arena.hpp"
+#include "services/media/entity_resolver.hpp"
+#include <algorithm>
+#include <fmt/format.h>
+#include <random>
+
+namespace
+{
+    using namespace app;
+
+    // `providers` streams of the same titles, as each provider would return them: own ids and
+    // order, the IMDb id where the catalog has one, and the same title and year otherwise
+    std::vector<std::vector<domain::MediaMetadata>> SameTitles(const std::vector<domain::MediaMetadata> &titles, size_t providers)
+    {
+        std::mt19937 random(7);
+        std::vector<std::vector<domain::MediaMetadata>> streams(providers, titles);
+        for (size_t p = 0; p < providers; ++p)
+        {
+            for (auto &item : streams[p])
+            {
+                item.id.source = fmt::format("provider{}", p);
+                item.id.id = fmt::format("{}-{}", p, item.id.id);
+                item.externalIds.tmdb.clear();
+            }
+            std::shuffle(streams[p].begin(), streams[p].end(), random);
+        }
+        return streams;
+    }
+}
+
+// EntityResolver over the 10k items of one request, as the fan-out hands it over
+APP_BENCHMARK(EntityResolverTenThousandItems)
+{
+    const auto items = bench::MakeCatalog(10000);
+    const auto tripled = SameTitles(bench::MakeCatalog(3334), 3);
+
+    const auto measure = [](const std::vector<std::vector<domain::MediaMetadata>> &input, const char *label)
+    {
+        std::vector<std::vector<domain::MediaMetadata>> streams;
+        services::EntityResolver::Stats stats;
+        const double micros = bench::MeasureMicrosAfter([&]
+                                                        { streams = input; },
+                                                        [&]
+                                                        {
+                                                            utils::RequestArena arena;
+                                                            stats = services::EntityResolver::Resolve(streams, arena.Resource());
+                                                        });
+        bench::Report(fmt::format("{} -> {} items", label, stats.output), micros);
+    };
+
+    // In per-provider streams, as the service passes them
+    std::vector<std::vector<domain::MediaMetadata>> split(5);
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        split[i % split.size()].push_back(items[i]);
+    }
+    measure(split, "10000 items from 5 providers");
+    measure(tripled, "the same 3334 items from 3 providers");
+}
@@ -0,0 +1,121 @@
+#include "bench.hpp"
+#include "services/search/fuzzy_matcher.hpp"
+#include <algorithm>
+#include <fmt/format.h>
+#include <random>
+#include <unordered_set>
+
+namespace
+{
+    using namespace app;
+    using Kernel = services::FuzzyMatcher::Kernel;
+
+    const char *KernelName(Kernel kernel)
+    {
+        switch (kernel)
+        {
+        case Kernel::Avx2:
+            return "AVX2";
+        case Kernel::Sse2:
+            return "SSE2";
+        default:
+            return "scalar";
+        }
+    }
+
+    // Distinct titles of 1-4 words, a third of them common ones, drawn from 20k made-up words
+    // so that the trigram index sees a realistic spread rather than a handful of hot trigrams
+    std::vector<std::string> MakeTitles(size_t count, std::mt19937 &random)
+    {
+        static const char *const kCommon[] = {"the", "of", "and", "a", "part", "ii", "in", "man", "love", "night", "dark", "return"};
+
+        std::vector<std::string> vocabulary(20000);
+        for (auto &word : vocabulary)
+        {
+            const size_t length = 3 + random() % 7;
+            for (size_t i = 0; i < length; ++i)
+            {
+                word += static_cast<char>('a' + random() % 26);
+            }
+        }
+
+        std::unordered_set<std::string> seen;
+        std::vector<std::string> titles;
+        while (titles.size() < count)
+        {
+            std::string title;
+            const size_t words = 1 + random() % 4;
+            for (size_t w = 0; w < words; ++w)
+            {
+                if (w > 0)
+                    title += ' ';
+                title += random() % 3 == 0 ? kCommon[random() % std::size(kCommon)] : vocabulary[random() % vocabulary.size()];
+            }
+            title[0] = static_cast<char>(title[0] - 'a' + 'A');
+            if (seen.insert(title).second)
+                titles.push_back(std::move(title));
+        }
+        return titles;
+    }
+}
+
+// "Did you mean" suggestions over 100k titles, per query with one typo, for each
+// kernel this CPU can run. The target is well under a millisecond.
+APP_BENCHMARK(FuzzyMatcherHundredThousandTitles)
+{
+    using Clock = std::chrono::steady_clock;
+    constexpr size_t kTitles = 100000;
+    constexpr size_t kQueries = 500;
+
+    std::mt19937 random(5);
+    const auto titles = MakeTitles(kTitles, random);
+    services::FuzzyMatcher matcher;
+    for (const auto &title : titles)
+    {
+        matcher.Add(title, static_cast<float>(random() % 1000));
+    }
+
+    // The first 20 characters of a title with one of them mistyped, as the user types it
+    std::vector<std::string> queries(kQueries);
+    for (auto &query : queries)
+    {
+        query = titles[random() % titles.size()].substr(0, 20);
+        query[random() % query.size()] = 'z';
+    }
+
+    const Kernel best = services::FuzzyMatcher::DetectKernel();
+    fmt::print("  {} distinct titles, {} queries, this CPU runs {}\n", matcher.Size(), kQueries, KernelName(best));
+    for (const Kernel kernel : {Kernel::Scalar, Kernel::Sse2, Kernel::Avx2})
+    {
+        if (kernel > best)
+            break;
+
+        // One pass to warm up, then one timed query at a time for the percentiles
+        std::vector<double> micros;
+        size_t answered = 0;
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            micros.clear();
+            answered = 0;
+            for (const auto &query : queries)
+            {
+                const auto start = Clock::now();
+                const auto suggestions = matcher.Suggest(query, 5, kernel);
+                micros.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+                answered += !suggestions.empty();
+            }
+        }
+        bench::Consume(answered);
+
+        double total = 0.0;
+        for (const double m : micros)
+        {
+            total += m;
+        }
+        std::sort(micros.begin(), micros.end());
+        fmt::print("  {} kernel, {} of {} queries with a suggestion\n", KernelName(kernel), answered, kQueries);
+        bench::Report("mean", total / static_cast<double>(micros.size()));
+        bench::Report("p50", micros[micros.size() / 2]);
+        bench::Report("p99", micros[micros.size() * 99 / 100]);
+    }
+}
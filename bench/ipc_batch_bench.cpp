@@ -0,0 +1,159 @@
+#include "bench.hpp"
+#include "ipc/ipc_manager.hpp"
+#ifndef _WIN32
+#include "ipc/unix_socket_transport.hpp"
+#include <unistd.h>
+#endif
+#include <condition_variable>
+#include <fmt/format.h>
+#include <functional>
+#include <mutex>
+
+namespace
+{
+    using namespace app;
+    using ipc::json;
+
+    // The page's side: counts responses, plain or batched, and the messages they came in
+    class Peer
+    {
+    public:
+        void Receive(std::string_view message)
+        {
+            const auto envelope = json::parse(message);
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++messages_;
+            responses_ += envelope.contains("batch") ? envelope["batch"].size() : 1;
+            arrived_.notify_all();
+        }
+
+        void WaitFor(size_t responses)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            arrived_.wait(lock, [&]
+                          { return responses_ >= responses; });
+        }
+
+        std::pair<size_t, size_t> Counts()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return {responses_, messages_};
+        }
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable arrived_;
+        size_t responses_ = 0;
+        size_t messages_ = 0;
+    };
+
+    std::unique_ptr<ipc::IpcManager> MakeManager()
+    {
+        auto manager = std::make_unique<ipc::IpcManager>(4, 1024);
+        manager->RegisterHandler("echo", [](const json &payload, ipc::Responder respond)
+                                 { respond({{"success", true}, {"page", payload["page"]}}); });
+        return manager;
+    }
+
+    json Request(size_t i)
+    {
+        return {{"type", "echo"}, {"id", std::to_string(i)}, {"payload", {{"query", "star wars"}, {"page", i}}}};
+    }
+
+    // Screens of perScreen requests, each screen waiting for all of its responses before the
+    // next is sent, the way a page renders. Reports the time per screen and how many messages
+    // crossed the transport each way for it, the round trips batching saves.
+    void Screens(const char *transport, Peer &peer, const std::function<void(const std::string &)> &send, size_t perScreen)
+    {
+        constexpr size_t kRequests = 20000;
+        const size_t screens = kRequests / perScreen;
+
+        for (const bool batched : {false, true})
+        {
+            const auto [before, messagesBefore] = peer.Counts();
+            size_t sentMessages = 0;
+            const double micros = bench::MeasureMicros([&]
+                                                       {
+                const size_t sent = peer.Counts().first;
+                for (size_t screen = 0; screen < screens; ++screen)
+                {
+                    if (batched)
+                    {
+                        json batch = {{"type", "batch"}, {"payload", json::array()}};
+                        for (size_t i = 0; i < perScreen; ++i)
+                        {
+                            batch["payload"].push_back(Request(i));
+                        }
+                        send(batch.dump());
+                        ++sentMessages;
+                    }
+                    else
+                    {
+                        for (size_t i = 0; i < perScreen; ++i)
+                        {
+                            send(Request(i).dump());
+                        }
+                        sentMessages += perScreen;
+                    }
+                    peer.WaitFor(sent + (screen + 1) * perScreen);
+                } },
+                                                       std::chrono::milliseconds(0));
+            const auto [after, messagesAfter] = peer.Counts();
+            const double screensRun = static_cast<double>(after - before) / static_cast<double>(perScreen);
+            bench::Report(fmt::format("{}, {}/screen, {}: {:.0f} out, {:.0f} back", transport, perScreen,
+                                      batched ? "batched" : "unbatched", static_cast<double>(sentMessages) / screensRun,
+                                      static_cast<double>(messagesAfter - messagesBefore) / screensRun),
+                          micros / static_cast<double>(screens));
+        }
+    }
+}
+
+// A screen's requests sent one message each, against one batch per screen with the
+// responses coalesced. Times are per screen; LoopbackTransport costs nothing to cross, the
+// Unix socket stands in for WebView2's postMessage.
+APP_BENCHMARK(IpcBatchedEnvelopes)
+{
+    fmt::print("  messages each way and time, per screen\n");
+    {
+        Peer peer;
+        auto manager = MakeManager();
+        auto transport = std::make_unique<ipc::LoopbackTransport>();
+        auto *loopback = transport.get();
+        loopback->SetPeerHandler([&peer](std::string_view message)
+                                 { peer.Receive(message); });
+        manager->SetTransport(std::move(transport));
+        for (const size_t perScreen : {10, 50})
+        {
+            Screens("loopback", peer, [loopback](const std::string &message)
+                    { loopback->DeliverToHost(message); }, perScreen);
+        }
+    }
+
+#ifndef _WIN32
+    // Removed again by the listening side when it closes
+    const std::string path = fmt::format("/tmp/streaming_app_bench_{}.sock", ::getpid());
+    Peer peer;
+    auto manager = MakeManager();
+    auto host = ipc::UnixSocketTransport::Listen(path);
+    if (host.IsError())
+    {
+        fmt::print("  no Unix socket: {}\n", host.GetError().message);
+        return;
+    }
+    manager->SetTransport(std::move(host).Value());
+    auto connected = ipc::UnixSocketTransport::Connect(path);
+    if (connected.IsError())
+    {
+        fmt::print("  no Unix socket: {}\n", connected.GetError().message);
+        return;
+    }
+    auto driver = std::move(connected).Value();
+    driver->SetMessageHandler([&peer](std::string_view message)
+                              { peer.Receive(message); });
+    for (const size_t perScreen : {10, 50})
+    {
+        Screens("unix socket", peer, [&driver](const std::string &message)
+                { driver->Send(message); }, perScreen);
+    }
+#endif
+}
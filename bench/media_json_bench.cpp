@@ -0,0 +1,76 @@
+#include "bench.hpp"
+#include "app/ui/media_json.hpp"
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+namespace
+{
+    using namespace app;
+    using json = nlohmann::json;
+
+    // The movie list as MainWindow built it before JsonWriter, one json object per movie
+    json MoviesToJson(const std::vector<domain::MediaMetadata> &movies)
+    {
+        json movieArray = json::array();
+        for (const auto &movie : movies)
+        {
+            json movieJson = {
+                {"title", !movie.title.empty() ? movie.title : "Untitled"},
+                {"overview", !movie.overview.empty() ? movie.overview : "No overview available"},
+                {"rating", movie.rating},
+                {"voteCount", movie.voteCount},
+                {"id", fmt::format("{}:{}", movie.id.source, movie.id.id)}};
+            if (movie.posterPath.has_value() && !movie.posterPath->empty())
+                movieJson["poster"] = movie.posterPath->Url();
+            else
+                movieJson["poster"] = nullptr;
+
+            if (!movie.sourceRatings.empty())
+            {
+                json ratings = json::array();
+                for (const auto &rating : movie.sourceRatings)
+                {
+                    ratings.push_back({{"source", rating.source.Get()}, {"rating", rating.value}});
+                }
+                movieJson["ratings"] = std::move(ratings);
+            }
+            movieArray.push_back(std::move(movieJson));
+        }
+        return movieArray;
+    }
+}
+
+// A 500-movie response in its {id, payload} envelope, written by JsonWriter into a
+// reused buffer against building the nlohmann::json tree and dumping it
+APP_BENCHMARK(MediaJsonFiveHundredMovies)
+{
+    auto movies = bench::MakeCatalog(500);
+    for (size_t i = 0; i < movies.size(); i += 3)
+    {
+        // Merged titles carry each provider's rating
+        movies[i].sourceRatings = {{"IMDb", 7.3f, "", 1200}, {"RottenTomatoes", 81.0f, "", 90}};
+    }
+
+    size_t treeBytes = 0;
+    const double tree = bench::MeasureMicros([&]
+                                             {
+        const json response = {{"id", "42"}, {"payload", {{"success", true}, {"movies", MoviesToJson(movies)}}}};
+        const std::string text = response.dump();
+        treeBytes = text.size();
+        bench::Consume(text.size()); });
+
+    // As IpcManager::SendEnvelope writes it, into a buffer that keeps its capacity
+    std::string buffer;
+    const double writer = bench::MeasureMicros([&]
+                                               {
+        buffer.clear();
+        utils::JsonWriter out(buffer);
+        out.BeginObject().Key("id").String("42").Key("payload");
+        out.BeginObject().Field("success", true);
+        ui::WriteMovies(out.Key("movies"), movies);
+        out.EndObject().EndObject();
+        bench::Consume(buffer.size()); });
+
+    bench::Report(fmt::format("json tree + dump ({} KB)", treeBytes / 1024), tree);
+    bench::Report(fmt::format("JsonWriter + WriteMovies, reused buffer ({} KB)", buffer.size() / 1024), writer);
+}
@@ -0,0 +1,86 @@
+#include "bench.hpp"
+#include "services/cache/page_codec.hpp"
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+namespace
+{
+    using namespace app;
+
+    // The JSON the search index was saved as before it used PageCodec
+    nlohmann::json ToJson(const domain::MediaMetadata &item)
+    {
+        nlohmann::json json = {
+            {"id", item.id.id},
+            {"source", item.id.source.Get()},
+            {"type", static_cast<int>(item.id.type)},
+            {"title", item.title},
+            {"overview", item.overview},
+            {"genres", item.genres.Names()},
+            {"released", std::chrono::floor<std::chrono::days>(item.releaseDate).time_since_epoch().count()},
+            {"rating", item.rating},
+            {"votes", item.voteCount},
+            {"popularity", item.popularity},
+            {"normalizedRating", item.normalizedRating},
+            {"imdb", item.externalIds.imdb},
+            {"tmdb", item.externalIds.tmdb}};
+        if (item.originalTitle)
+            json["originalTitle"] = *item.originalTitle;
+        if (item.posterPath)
+            json["poster"] = item.posterPath->Url();
+        if (item.backdropPath)
+            json["backdrop"] = item.backdropPath->Url();
+        return json;
+    }
+}
+
+// A page as PageCodec bytes against nlohmann JSON, for a result page and a cache dump
+APP_BENCHMARK(PageCodecVersusJson)
+{
+    using app::bench::Consume;
+    using app::bench::Report;
+    using app::services::PageCodec;
+    using app::services::PageView;
+
+    for (const size_t count : {20, 1000})
+    {
+        const auto items = app::bench::MakeCatalog(count);
+        std::string json;
+        std::vector<uint8_t> page;
+
+        const double jsonEncode = app::bench::MeasureMicros([&]
+                                                            {
+            nlohmann::json array = nlohmann::json::array();
+            for (const auto &item : items)
+            {
+                array.push_back(ToJson(item));
+            }
+            json = array.dump(); });
+        const double pageEncode = app::bench::MeasureMicros([&]
+                                                            { page = PageCodec::Encode(items); });
+
+        const double jsonTitles = app::bench::MeasureMicros([&]
+                                                            {
+            for (const auto &item : nlohmann::json::parse(json))
+            {
+                Consume(item["title"].get_ref<const std::string &>().size());
+            } });
+        const double pageTitles = app::bench::MeasureMicros([&]
+                                                            {
+            const auto view = PageView::Open(page);
+            for (size_t i = 0; i < view.Value().size(); ++i)
+            {
+                Consume(view.Value()[i].Title().size());
+            } });
+        const double pageDecode = app::bench::MeasureMicros([&]
+                                                            { Consume(PageView::Open(page).Value().ToMetadata().size()); });
+
+        fmt::print("  {} items: JSON {} bytes, page {} bytes ({:.0f}%)\n", count, json.size(), page.size(),
+                   100.0 * static_cast<double>(page.size()) / static_cast<double>(json.size()));
+        Report("encode, JSON", jsonEncode);
+        Report("encode, page", pageEncode);
+        Report("read every title, JSON parse", jsonTitles);
+        Report("read every title, page view", pageTitles);
+        Report("decode to MediaMetadata, page", pageDecode);
+    }
+}
@@ -0,0 +1,80 @@
+#include "bench.hpp"
+#include "core/utils/request_arena.hpp"
+#include "services/media/result_merger.hpp"
+#include <algorithm>
+#include <fmt/format.h>
+#include <iterator>
+
+namespace
+{
+    using namespace app;
+    using Streams = std::vector<std::vector<domain::MediaMetadata>>;
+
+    Streams Split(const std::vector<domain::MediaMetadata> &items, size_t count)
+    {
+        Streams streams(count);
+        for (size_t i = 0; i < items.size(); ++i)
+        {
+            streams[i % count].push_back(items[i]);
+        }
+        return streams;
+    }
+}
+
+// ResultMerger over 5 provider streams of 1000 items, against concatenating them
+// and running a full std::sort, as UnifiedSearch did before
+APP_BENCHMARK(ResultMergerFiveByThousand)
+{
+    constexpr size_t kPage = 50;
+    const auto unsorted = Split(bench::MakeCatalog(5000), 5);
+
+    for (const auto &[name, order] : {std::pair{"popularity", services::SortOrder{services::SortField::Popularity, true}},
+                                      std::pair{"title", services::SortOrder{services::SortField::Title, false}}})
+    {
+        // Providers usually sort server-side
+        auto sorted = unsorted;
+        for (auto &stream : sorted)
+        {
+            std::stable_sort(stream.begin(), stream.end(), [order](const auto &a, const auto &b)
+                             { return services::ResultMerger::Before(services::ResultMerger::SortKey(a, order), a,
+                                                                     services::ResultMerger::SortKey(b, order), b, order); });
+        }
+
+        Streams streams;
+        const auto merge = [&](size_t limit)
+        {
+            return [&, limit]
+            {
+                utils::RequestArena arena;
+                services::ResultMerger merger(order, limit, arena.Resource());
+                for (auto &stream : streams)
+                {
+                    merger.AddStream(std::move(stream));
+                }
+                bench::Consume(merger.Take().size());
+            };
+        };
+        const auto fullSort = [&]
+        {
+            std::vector<domain::MediaMetadata> all;
+            for (auto &stream : streams)
+            {
+                std::move(stream.begin(), stream.end(), std::back_inserter(all));
+            }
+            std::sort(all.begin(), all.end(), [order](const auto &a, const auto &b)
+                      { return order.field == services::SortField::Title ? a.title < b.title : a.popularity > b.popularity; });
+            all.resize(std::min(all.size(), kPage));
+            bench::Consume(all.size());
+        };
+
+        fmt::print("  by {}\n", name);
+        bench::Report(fmt::format("merge sorted streams, top {}", kPage), bench::MeasureMicrosAfter([&]
+                                                                                                    { streams = sorted; }, merge(kPage)));
+        bench::Report("merge sorted streams, all 5000", bench::MeasureMicrosAfter([&]
+                                                                                  { streams = sorted; }, merge(0)));
+        bench::Report(fmt::format("merge unsorted streams, top {}", kPage), bench::MeasureMicrosAfter([&]
+                                                                                                      { streams = unsorted; }, merge(kPage)));
+        bench::Report(fmt::format("concatenate and std::sort, top {}", kPage), bench::MeasureMicrosAfter([&]
+                                                                                                         { streams = unsorted; }, fullSort));
+    }
+}
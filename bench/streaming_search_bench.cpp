@@ -0,0 +1,108 @@
+#include "bench.hpp"
+#include "services/media/media_service.hpp"
+#include <atomic>
+#include <fmt/format.h>
+#include <thread>
+
+namespace
+{
+    using namespace app;
+    using Page = utils::Result<std::vector<domain::MediaMetadata>>;
+
+    // Answers every request with the same page after a fixed delay
+    class DelayedProvider : public services::IMediaProvider
+    {
+    public:
+        DelayedProvider(std::string name, std::chrono::milliseconds delay, uint32_t seed)
+            : name_(std::move(name)), delay_(delay), items_(bench::MakeCatalog(20, seed))
+        {
+            for (auto &item : items_)
+            {
+                item.id.source = name_;
+            }
+        }
+
+        std::string GetProviderName() const override { return name_; }
+        std::string GetProviderVersion() const override { return "1"; }
+        services::ProviderCapabilities GetCapabilities() const override { return {{}, {}, {}, {}, true, true}; }
+
+        std::future<Page> GetCatalog(const std::string &, const services::MediaFilter &, int) override
+        {
+            return std::async(std::launch::async, [this, self = shared_from_this()]
+                              { return Fetch(); });
+        }
+        std::future<Page> SearchMedia(const std::string &, const services::MediaFilter &, int) override
+        {
+            return std::async(std::launch::async, [this, self = shared_from_this()]
+                              { return Fetch(); });
+        }
+        void GetCatalog(const std::string &, const services::MediaFilter &, int, PageCallback done) override
+        {
+            std::thread([this, self = shared_from_this(), done = std::move(done)]
+                        { done(Fetch()); })
+                .detach();
+        }
+        void SearchMedia(const std::string &, const services::MediaFilter &, int, PageCallback done) override
+        {
+            std::thread([this, self = shared_from_this(), done = std::move(done)]
+                        { done(Fetch()); })
+                .detach();
+        }
+        std::future<utils::Result<domain::MediaMetadata>> GetMediaDetails(const domain::MediaId &) override { return {}; }
+
+    private:
+        Page Fetch() const
+        {
+            std::this_thread::sleep_for(delay_);
+            return Page(items_);
+        }
+
+        std::string name_;
+        std::chrono::milliseconds delay_;
+        std::vector<domain::MediaMetadata> items_;
+    };
+}
+
+// Time to the first items with a fast and a slow provider, waiting for the merged
+// page against streaming each provider's items as they arrive
+APP_BENCHMARK(StreamingSearchTimeToFirstItems)
+{
+    using Clock = std::chrono::steady_clock;
+    constexpr int kRuns = 5;
+    constexpr auto kFast = std::chrono::milliseconds(20);
+    constexpr auto kSlow = std::chrono::milliseconds(400);
+
+    auto &service = services::MediaService::Instance();
+    service.RegisterProvider("bench-fast", std::make_unique<DelayedProvider>("bench-fast", kFast, 1));
+    service.RegisterProvider("bench-slow", std::make_unique<DelayedProvider>("bench-slow", kSlow, 2));
+
+    double waited = 0.0, firstItems = 0.0, complete = 0.0;
+    for (int run = 0; run < kRuns; ++run)
+    {
+        // Catalog pages of their own, so no run is answered from the cache or the local index
+        auto start = Clock::now();
+        bench::Consume(service.UnifiedSearch("", "popular", {}, 2 * run + 1).get().IsOk());
+        waited += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+        std::atomic<bool> first{true};
+        std::atomic<int64_t> firstAt{0};
+        start = Clock::now();
+        auto result = service.UnifiedSearchStreaming("", "popular", {}, 2 * run + 2,
+                                                     [&](const std::string &, const std::vector<domain::MediaMetadata> &)
+                                                     {
+                                                         if (first.exchange(false))
+                                                             firstAt = (Clock::now() - start).count();
+                                                     });
+        bench::Consume(result.get().IsOk());
+        complete += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        firstItems += std::chrono::duration<double, std::micro>(Clock::duration(firstAt.load())).count();
+    }
+
+    service.UnregisterProvider("bench-fast");
+    service.UnregisterProvider("bench-slow");
+
+    fmt::print("  providers answering after {}ms and {}ms, mean of {} searches\n", kFast.count(), kSlow.count(), kRuns);
+    bench::Report("first items, UnifiedSearch (the merged page)", waited / kRuns);
+    bench::Report("first items, UnifiedSearchStreaming", firstItems / kRuns);
+    bench::Report("merged page, UnifiedSearchStreaming", complete / kRuns);
+}
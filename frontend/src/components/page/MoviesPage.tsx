@@ -6,11 +6,13 @@ import { Card, CardContent, CardTitle, CardDescription } from "../ui/card";
 
 import Image from "next/image";
 const ipc = await import("@/lib/ipc").then((module) => module.ipc);
+// Only what the grid renders; the overview and the rest can be fetched per id with "movieFields"
+const GRID_FIELDS = ["title", "poster", "rating"];
 type Movie = {
   id: string;
   title: string;
-  description: string;
   poster: string;
+  rating: number;
 };
 
 export const MoviesPage = () => {
@@ -19,7 +21,7 @@ export const MoviesPage = () => {
 
   const LoadMovies = async () => {
     if (!initialLoad) {
-      const response = await ipc.send("movies");
+      const response = await ipc.send("movies", { fields: GRID_FIELDS });
       if (response) {
         setMovies(response.movies);
         console.log(movies);
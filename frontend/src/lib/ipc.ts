@@ -4,31 +4,80 @@ type IpcResponse<T> = {
   error?: string;
 };
 
+// Streamed requests receive any number of "partial" payloads before a final "complete" one
+type IpcStreamPayload = {
+  success: boolean;
+  stream?: "partial" | "complete";
+  [key: string]: any;
+};
+
+type IpcRequest = {
+  type: string;
+  id: string;
+  payload: any;
+};
+
 class IpcClient {
   private static instance: IpcClient;
   private messageHandlers: Map<string, (response: any) => void>;
+  private partialHandlers: Map<string, (payload: IpcStreamPayload) => void>;
   private messageCounter: number;
+  private outgoing: IpcRequest[] = [];
 
   private constructor() {
     console.log("Initializing IpcClient");
     this.messageHandlers = new Map();
+    this.partialHandlers = new Map();
     this.messageCounter = 0;
 
     if (typeof window !== "undefined" && window.chrome?.webview) {
       console.log("WebView detected, setting up message listener");
       window.chrome.webview.addEventListener("message", (event) => {
-        const { id, payload } = event.data;
-        const handler = this.messageHandlers.get(id);
-        if (handler) {
-          handler(payload);
-          this.messageHandlers.delete(id);
+        // Responses to batched requests may arrive coalesced: {batch: [{id, payload}, ...]}
+        if (Array.isArray(event.data?.batch)) {
+          for (const { id, payload } of event.data.batch) {
+            this.dispatch(id, payload);
+          }
+          return;
         }
+        const { id, payload } = event.data;
+        this.dispatch(id, payload);
       });
     } else {
       console.log("WebView not detected during IpcClient initialization");
     }
   }
 
+  private dispatch(id: string, payload: any) {
+    if (payload?.stream === "partial") {
+      this.partialHandlers.get(id)?.(payload);
+      return;
+    }
+    this.partialHandlers.delete(id);
+    const handler = this.messageHandlers.get(id);
+    if (handler) {
+      handler(payload);
+      this.messageHandlers.delete(id);
+    }
+  }
+
+  // Requests made in the same task go out together as one batch envelope, so a screen
+  // issuing several at once pays for one postMessage crossing instead of one each
+  private post(request: IpcRequest) {
+    this.outgoing.push(request);
+    if (this.outgoing.length === 1) {
+      queueMicrotask(() => {
+        const requests = this.outgoing;
+        this.outgoing = [];
+        window.chrome?.webview.postMessage(
+          requests.length === 1
+            ? requests[0]
+            : { type: "batch", payload: requests },
+        );
+      });
+    }
+  }
+
   static getInstance(): IpcClient {
     if (!IpcClient.instance) {
       IpcClient.instance = new IpcClient();
@@ -61,26 +110,74 @@ class IpcClient {
         resolve(response as IpcResponse<T>);
       });
 
-      // Add event listener for this specific message
-      window.chrome?.webview.addEventListener("message", (event) => {
-        const response = event.data;
-        console.log("Received WebView message:", response);
-        if (response.id === id) {
-          const handler = this.messageHandlers.get(id);
-          if (handler) {
-            handler(response.payload);
-            this.messageHandlers.delete(id);
-          }
-        }
-      });
+      this.post({ type, id, payload });
+    });
+  }
 
-      window.chrome?.webview.postMessage({
-        type,
-        id,
-        payload,
-      });
+  // Sends a request in streaming mode: onPartial runs for every partial payload and the
+  // promise resolves with the final "complete" payload.
+  async stream<T extends IpcStreamPayload>(
+    type: string,
+    payload: any,
+    onPartial: (partial: T) => void,
+  ): Promise<T> {
+    return new Promise((resolve) => {
+      const id = `msg_${++this.messageCounter}`;
+      this.partialHandlers.set(id, (partial) => onPartial(partial as T));
+      this.messageHandlers.set(id, (response) => resolve(response as T));
+
+      this.post({ type, id, payload: { ...payload, stream: true } });
     });
   }
+
+  // Events pushed by the backend for the given topics, e.g. "providerHealth" and
+  // "cacheRefreshed", until the returned function is called
+  subscribe(topics: string[], onEvent: (event: IpcStreamPayload) => void): () => void {
+    const id = `msg_${++this.messageCounter}`;
+    this.partialHandlers.set(id, onEvent);
+    this.messageHandlers.set(id, (response) => {
+      if (!response?.success) {
+        console.error(`Subscription ${id} ended:`, response?.error);
+      }
+    });
+    this.post({ type: "subscribe", id, payload: { topics } });
+    return () => {
+      void this.send("unsubscribe", { subscription: id });
+    };
+  }
 }
 
 export const ipc = IpcClient.getInstance();
+
+export type VersionedPage<T extends { id: string }> = {
+  version: number;
+  movies: T[];
+};
+
+// Applies the response to a request made with a "view": either the whole page, or a delta
+// on top of the version passed as "since". Unchanged movies keep their objects, so they
+// are not re-rendered. Returns undefined for a delta on another version; request the page
+// again without "since" then.
+export function applyPage<T extends { id: string }>(
+  current: VersionedPage<T> | undefined,
+  payload: any,
+): VersionedPage<T> | undefined {
+  if (Array.isArray(payload?.movies)) {
+    return { version: payload.version, movies: payload.movies };
+  }
+  if (!current || !payload?.delta || payload.base !== current.version) {
+    return undefined;
+  }
+  const { removed, inserted, changed, order } = payload.delta;
+  const gone = new Set<string>(removed);
+  const updated = new Map<string, T>(changed.map((movie: T) => [movie.id, movie]));
+  let movies = current.movies
+    .filter((movie) => !gone.has(movie.id))
+    .map((movie) => updated.get(movie.id) ?? movie)
+    .concat(inserted);
+  if (order) {
+    const byId = new Map(movies.map((movie) => [movie.id, movie]));
+    movies = order.map((id: string) => byId.get(id)!);
+  }
+  return { version: payload.version, movies };
+}
@@ -33,6 +33,8 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine
         DispatchMessage(&msg);
     }
 
+    app::services::MediaService::Instance().Shutdown();
+
     // Shutdown the logger
     app::utils::Logger::Shutdown();
     return 0;
@@ -2,16 +2,111 @@
 #include "utils/logger.hpp"
 #include "config/config_manager.hpp"
 #include "services/media/media_service.hpp"
+#include "services/cache/cache_manager.hpp"
+#include "services/catalog/catalog_store.hpp"
+#include "services/media/service_events.hpp"
+#include <algorithm>
+#include <filesystem>
 #include <fmt/format.h>
 
 namespace app::ui
 {
+    namespace
+    {
+        // {"success":true,"stream":"partial","provider":...,"movies":[...]}
+        void RespondPartial(const ipc::Responder &respond, const std::string &providerId, const std::vector<domain::MediaMetadata> &items, MovieFields fields)
+        {
+            respond.Write([&](utils::JsonWriter &writer)
+                          {
+                writer.BeginObject().Field("success", true).Field("stream", "partial").Field("provider", providerId);
+                WriteMovies(writer.Key("movies"), items, fields);
+                writer.EndObject(); });
+        }
+    }
+
+    MainWindow::MediaRequest MainWindow::ParseMediaRequest(const ipc::json &payload)
+    {
+        MediaRequest request;
+        request.catalogType = "popular";
+        request.filter.sortBy = "popularity"; // Default sort by popularity
+        request.filter.sortDesc = true;       // Sort in descending order
+
+        if (!payload.is_object())
+        {
+            return request;
+        }
+
+        request.query = payload.value("query", std::string());
+        request.catalogType = payload.value("catalog", request.catalogType);
+        request.page = payload.value("page", 1);
+        if (payload.contains("limit") && payload["limit"].is_number_unsigned())
+            request.limit = payload["limit"].get<size_t>();
+        if (payload.contains("genre") && payload["genre"].is_string())
+            request.filter.genre = payload["genre"].get<std::string>();
+        if (payload.contains("type") && payload["type"].is_string())
+            request.filter.type = payload["type"].get<std::string>();
+        if (payload.contains("year") && payload["year"].is_number_integer())
+            request.filter.year = payload["year"].get<int>();
+        if (payload.contains("sortBy") && payload["sortBy"].is_string())
+            request.filter.sortBy = payload["sortBy"].get<std::string>();
+        if (payload.contains("sortDesc") && payload["sortDesc"].is_boolean())
+            request.filter.sortDesc = payload["sortDesc"].get<bool>();
+        if (payload.contains("fields") && payload["fields"].is_array())
+            request.fields = MovieFields::FromNames(payload["fields"].get<std::vector<std::string>>());
+        if (payload.contains("session") && payload["session"].is_string())
+            request.session = payload["session"].get<std::string>();
+        if (payload.contains("view") && payload["view"].is_string())
+            request.view = payload["view"].get<std::string>();
+        if (payload.contains("since") && payload["since"].is_number_unsigned())
+            request.since = payload["since"].get<uint64_t>();
+        return request;
+    }
+
+    services::CatalogQuery MainWindow::ParseCatalogQuery(const ipc::json &payload)
+    {
+        auto query = services::CatalogQuery::FromFilter(ParseMediaRequest(payload).filter);
+        if (!payload.is_object())
+        {
+            return query;
+        }
+
+        if (payload.contains("genres") && payload["genres"].is_array())
+            query.genres = payload["genres"].get<std::vector<std::string>>();
+        query.matchAllGenres = payload.value("allGenres", false);
+        query.minYear = payload.value("yearFrom", query.minYear);
+        query.maxYear = payload.value("yearTo", query.maxYear);
+        query.minRating = payload.value("minRating", query.minRating);
+        query.minVotes = payload.value("minVotes", query.minVotes);
+        return query;
+    }
 
     MainWindow::MainWindow()
-        : ipcManager_(std::make_unique<ipc::IpcManager>()),
-          webview_(nullptr) {}
+        : ipcManager_(nullptr),
+          webview_(nullptr),
+          transport_(nullptr) {}
+
+    MainWindow::~MainWindow()
+    {
+        // Event handlers and searches outlive the window; nothing may reach the IPC manager once
+        // it is gone. Searches submitted from here on are answered at once.
+        services::MediaService::Instance().CancelAllSearches();
 
-    MainWindow::~MainWindow() = default;
+        std::vector<std::string> ids;
+        {
+            std::lock_guard<std::mutex> lock(subscriptionsMutex_);
+            for (const auto &[id, subscription] : subscriptions_)
+                ids.push_back(id);
+        }
+        for (const auto &id : ids)
+        {
+            CloseSubscription(id);
+        }
+
+        // Declared first, the IPC manager would be destroyed last: after the members its running
+        // handlers use, and the WebView its transport is attached to
+        ipcManager_.reset();
+        transport_ = nullptr;
+    }
 
     void MainWindow::InitializeWebView()
     {
@@ -23,17 +118,11 @@ namespace app::ui
             // Set up IPC handlers first
             SetupIpcHandlers();
             
-            // Connect WebView message handling to IPC manager
-            webview_->SetMessageCallback([this](const std::wstring& message) {
-                utils::Logger::Info("Forwarding message to IPC manager");
-                ipcManager_->HandleWebMessage(message);
-            });
-            
-            // Set up WebView callback in IPC manager
-            ipcManager_->SetWebViewCallback([this](const std::wstring& message) {
-                utils::Logger::Info("IPC manager sending response");
-                webview_->PostWebMessage(message);
-            });
+            // Messages from the page reach the IPC manager through the transport; replies from
+            // worker threads are posted back to the UI thread by it
+            auto transport = std::make_unique<WebViewTransport>(*webview_, hwnd_, WM_APP_FLUSH_IPC);
+            transport_ = transport.get();
+            ipcManager_->SetTransport(std::move(transport));
 
             // Get WebView URL from config
             auto urlResult = app::config::ConfigManager::Instance().Get<std::string>("webview.url");
@@ -70,6 +159,28 @@ namespace app::ui
             return false;
         }
 
+        // Persistent caches live next to the config unless configured otherwise
+        const auto cacheDir = app::config::ConfigManager::Instance().GetOrDefault<std::string>(
+            "cache_dir", utils::GetAppDataDirectory("StreamingApp") + "\\cache");
+        std::error_code ec;
+        std::filesystem::create_directories(cacheDir, ec);
+        if (ec)
+        {
+            utils::Logger::Warning("Failed to create cache directory " + cacheDir + ": " + ec.message());
+        }
+        else
+        {
+            cache::CacheManager::Instance().SetDirectory(cacheDir);
+        }
+
+        // Handlers run on a worker pool; a request arriving with the queue full is answered busy.
+        // Responses to batched requests are coalesced for up to the window.
+        const auto &config = app::config::ConfigManager::Instance();
+        ipcManager_ = std::make_unique<ipc::IpcManager>(
+            static_cast<size_t>(std::max(config.GetOrDefault<int>("ipc.workers", static_cast<int>(ipc::IpcManager::kDefaultWorkers)), 1)),
+            static_cast<size_t>(std::max(config.GetOrDefault<int>("ipc.queue_capacity", static_cast<int>(ipc::IpcManager::kDefaultQueueCapacity)), 1)),
+            std::chrono::milliseconds(std::max(config.GetOrDefault<int>("ipc.coalesce_window_ms", static_cast<int>(ipc::IpcManager::kDefaultCoalesceWindow.count())), 0)));
+
         if (!services::MediaService::Instance().Initialize(providersDirResult.Value()))
         {
             utils::Logger::Error("Failed to initialize MediaService");
@@ -89,70 +200,37 @@ namespace app::ui
     {
         utils::Logger::Info("Setting up IPC handlers...");
 
-        ipcManager_->RegisterHandler("movies", [](const ipc::json &payload, std::function<void(const ipc::json &)> respond)
+        // Runs on an IPC worker, so waiting for the providers here does not hold up the UI thread
+        ipcManager_->RegisterHandler("movies", [this](const ipc::json &payload, ipc::Responder respond)
                                      {
             try {
                 utils::Logger::Info("Processing 'movies' IPC request.");
+                const auto request = ParseMediaRequest(payload);
+                auto& mediaService = services::MediaService::Instance();
 
-                // Create a MediaFilter object
-                services::MediaFilter filter;
-                filter.sortBy = "popularity"; // Default sort by popularity
-                filter.sortDesc = true;       // Sort in descending order
+                if (payload.is_object() && payload.value("stream", false)) {
+                    StreamMovies(request, std::move(respond));
+                    return;
+                }
 
-                // Fetch movies from MediaService (page 1)
-                auto& mediaService = services::MediaService::Instance();
-                auto resultFuture = mediaService.UnifiedSearch("", "popular", filter, 1); // Add "popular" as catalogType
+                // Fetch movies from MediaService
+                auto resultFuture = mediaService.UnifiedSearch(request.query, request.catalogType, request.filter, request.page, request.limit);
 
                 auto result = resultFuture.get();
 
                 if (result.IsOk()) {
-                    ipc::json movieArray = ipc::json::array();
-
-                    // Combine results from both pages
-                    std::vector<domain::MediaMetadata> allMovies = result.Value();
-
-                    for (const auto& movie : allMovies) {
-                        try {
-                            // Safely extract values
-                            const std::string& safeTitle = !movie.title.empty() ? 
-                                movie.title : "Untitled";
-                            const std::string& safeOverview = !movie.overview.empty() ? 
-                                movie.overview : "No overview available";
-                            const std::string& safeId = fmt::format("{}:{}", 
-                                movie.id.source, movie.id.id);
-
-                            // Build movie JSON
-                            ipc::json movieJson = {
-                                {"title", safeTitle},
-                                {"overview", safeOverview},
-                                {"rating", movie.rating},
-                                {"voteCount", movie.voteCount},
-                                {"id", safeId}
-                            };
-
-                            // Handle optional poster path
-                            if (movie.posterPath.has_value() && !movie.posterPath->empty()) {
-                                movieJson["poster"] = *movie.posterPath;
-                            } else {
-                                movieJson["poster"] = nullptr;
-                            }
+                    const auto& page = result.Value();
 
-                            movieArray.push_back(movieJson);
-                            utils::Logger::Info(fmt::format("Processed: {}", safeTitle));
-                        }
-                        catch (const std::exception& ex) {
-                            utils::Logger::Error(fmt::format("Movie processing error: {}", ex.what()));
-                            continue; // Skip invalid entries
-                        }
-                    }
-
-                    // Send response
-                    ipc::json response = {
-                        {"success", true},
-                        {"movies", movieArray}
-                    };
-                    respond(response);
-                    utils::Logger::Info(fmt::format("Sent {} movies", movieArray.size()));
+                    // Written straight into the response. A partial page lists the providers that missed the deadline.
+                    respond.Write([&](utils::JsonWriter& writer) {
+                        writer.BeginObject().Field("success", true);
+                        WritePage(writer, request, page.items);
+                        writer.Field("partial", page.IsPartial());
+                        writer.Key("missingProviders").StringArray(page.missingProviders);
+                        writer.Key("suggestions").StringArray(page.suggestions);
+                        writer.EndObject();
+                    });
+                    utils::Logger::Info(fmt::format("Sent {} movies", page.items.size()));
                 }
                 else {
                     // Handle errors
@@ -167,6 +245,332 @@ namespace app::ui
                 utils::Logger::Error(fmt::format("IPC handler failed: {}", ex.what()));
                 respond({{"success", false}, {"error", ex.what()}});
             } });
+
+        SetupProviderHealthHandler();
+        SetupSearchHandler();
+        SetupBrowseHandler();
+        SetupFacetsHandler();
+        SetupMovieFieldsHandler();
+        SetupSubscriptionHandlers();
+    }
+
+    void MainWindow::WritePage(utils::JsonWriter &writer, const MediaRequest &request, const std::vector<domain::MediaMetadata> &items)
+    {
+        // A refreshed view gets only what changed since the version it holds
+        if (!request.view.empty())
+            pageVersions_.Write(writer, request.session, request.view, request.since, items, request.fields);
+        else
+            WriteMovies(writer.Key("movies"), items, request.fields);
+    }
+
+    void MainWindow::StreamMovies(const MediaRequest &request, ipc::Responder respond)
+    {
+        // Partial pages are posted as soon as each provider answers. This runs on an IPC
+        // worker; respond only queues the reply for the UI thread, as WebView2 is single-threaded.
+        auto resultFuture = services::MediaService::Instance().UnifiedSearchStreaming(
+            request.query, request.catalogType, request.filter, request.page,
+            [respond, fields = request.fields](const std::string &providerId, const std::vector<domain::MediaMetadata> &items)
+            { RespondPartial(respond, providerId, items, fields); },
+            request.limit);
+
+        ipc::json complete;
+        try {
+            auto result = resultFuture.get();
+            if (result.IsOk()) {
+                // Items were already delivered, so only the merged ordering is sent
+                ipc::json order = ipc::json::array();
+                const auto& page = result.Value();
+                for (const auto& movie : page.items) {
+                    order.push_back(fmt::format("{}:{}", movie.id.source, movie.id.id));
+                }
+                complete = {{"success", true}, {"stream", "complete"}, {"order", order},
+                            {"partial", page.IsPartial()}, {"missingProviders", page.missingProviders},
+                            {"suggestions", page.suggestions}};
+            } else {
+                complete = {{"success", false}, {"stream", "complete"}, {"error", result.GetError().message}};
+            }
+        } catch (const std::exception& ex) {
+            complete = {{"success", false}, {"stream", "complete"}, {"error", ex.what()}};
+        }
+        respond(complete);
+    }
+
+    void MainWindow::SetupSearchHandler()
+    {
+        // Search-as-you-type. Each keystroke sends a "search" for the same session; older queries
+        // of that session complete with superseded=true and their late items must be ignored.
+        // Runs inline: SubmitSearch returns at once, and keystrokes must reach it in order.
+        ipcManager_->RegisterHandler("search", [](const ipc::json &payload, ipc::Responder respond)
+                                     {
+            try {
+                const auto sessionId = payload.is_object() ? payload.value("session", std::string("default")) : std::string("default");
+                auto& mediaService = services::MediaService::Instance();
+                if (payload.is_object() && payload.value("cancel", false)) {
+                    mediaService.CancelSearch(sessionId);
+                    respond({{"success", true}, {"stream", "complete"}, {"superseded", true}});
+                    return;
+                }
+
+                const auto request = ParseMediaRequest(payload);
+                mediaService.SubmitSearch(
+                    sessionId,
+                    services::SearchRequest{request.query, request.catalogType, request.filter, request.page, request.limit},
+                    [respond, fields = request.fields](const std::string &source, const std::vector<domain::MediaMetadata> &items)
+                    { RespondPartial(respond, source, items, fields); },
+                    [respond](utils::Result<services::UnifiedSearchResult> result)
+                    {
+                        ipc::json complete;
+                        if (result.IsOk()) {
+                            ipc::json order = ipc::json::array();
+                            const auto& page = result.Value();
+                            for (const auto& movie : page.items) {
+                                order.push_back(fmt::format("{}:{}", movie.id.source, movie.id.id));
+                            }
+                            complete = {{"success", true}, {"stream", "complete"}, {"order", order},
+                                        {"partial", page.IsPartial()}, {"missingProviders", page.missingProviders},
+                                        {"suggestions", page.suggestions}};
+                        } else if (result.GetError().code == services::SearchController::kSupersededCode) {
+                            complete = {{"success", true}, {"stream", "complete"}, {"superseded", true}};
+                        } else {
+                            complete = {{"success", false}, {"stream", "complete"}, {"error", result.GetError().message}};
+                        }
+                        respond(complete);
+                    });
+            }
+            catch (const std::exception& ex) {
+                utils::Logger::Error(fmt::format("Search handler failed: {}", ex.what()));
+                respond({{"success", false}, {"stream", "complete"}, {"error", ex.what()}});
+            } },
+                                     ipc::IpcManager::Dispatch::Inline);
+    }
+
+    void MainWindow::SetupBrowseHandler()
+    {
+        // Filters everything fetched so far without going to the providers
+        ipcManager_->RegisterHandler("browse", [this](const ipc::json &payload, ipc::Responder respond)
+                                     {
+            try {
+                const auto request = ParseMediaRequest(payload);
+                const auto query = ParseCatalogQuery(payload);
+                size_t offset = 0;
+                size_t limit = 50;
+                if (payload.is_object()) {
+                    offset = payload.value("offset", offset);
+                    limit = payload.value("limit", limit);
+                }
+
+                const auto page = services::CatalogStore::Instance().Browse(
+                    query, services::ParseSortOrder(request.filter.sortBy, request.filter.sortDesc), offset, limit);
+                respond.Write([&](utils::JsonWriter& writer) {
+                    writer.BeginObject().Field("success", true);
+                    WritePage(writer, request, page.items);
+                    writer.Field("total", page.total).Field("offset", offset).EndObject();
+                });
+            }
+            catch (const std::exception& ex) {
+                utils::Logger::Error(fmt::format("Browse handler failed: {}", ex.what()));
+                respond({{"success", false}, {"error", ex.what()}});
+            } });
+    }
+
+    void MainWindow::SetupFacetsHandler()
+    {
+        // Counts for the browse filters, over the same query "browse" takes
+        ipcManager_->RegisterHandler("facets", [](const ipc::json &payload, std::function<void(const ipc::json &)> respond)
+                                     {
+            try {
+                const auto facets = services::CatalogStore::Instance().Facets(ParseCatalogQuery(payload));
+                const auto& counts = facets.counts;
+
+                ipc::json genres = ipc::json::array();
+                for (size_t bit = 0; bit < facets.genreNames.size(); ++bit) {
+                    if (counts.genres[bit]) {
+                        genres.push_back({{"name", facets.genreNames[bit]}, {"count", counts.genres[bit]}});
+                    }
+                }
+                std::sort(genres.begin(), genres.end(), [](const ipc::json& a, const ipc::json& b) {
+                    return a["count"].get<uint32_t>() > b["count"].get<uint32_t>();
+                });
+
+                ipc::json years = ipc::json::array();
+                for (size_t i = 0; i < counts.decades.size(); ++i) {
+                    if (counts.decades[i]) {
+                        const int from = services::FacetCounts::kFirstDecade + static_cast<int>(i) * 10;
+                        years.push_back({{"from", from}, {"to", from + 9}, {"count", counts.decades[i]}});
+                    }
+                }
+
+                ipc::json ratings = ipc::json::array();
+                for (size_t i = 0; i < counts.ratings.size(); ++i) {
+                    if (counts.ratings[i]) {
+                        ratings.push_back({{"min", i * 0.5}, {"count", counts.ratings[i]}});
+                    }
+                }
+
+                respond({{"success", true},
+                         {"total", counts.total},
+                         {"genres", genres},
+                         {"years", years},
+                         {"unknownYear", counts.unknownYear},
+                         {"ratings", ratings},
+                         {"types", {{"movie", counts.types[0]}, {"tv", counts.types[1]}, {"episode", counts.types[2]}}}});
+            }
+            catch (const std::exception& ex) {
+                utils::Logger::Error(fmt::format("Facets handler failed: {}", ex.what()));
+                respond({{"success", false}, {"error", ex.what()}});
+            } });
+    }
+
+    void MainWindow::SetupMovieFieldsHandler()
+    {
+        // The fields a projected "movies", "search" or "browse" response left out, for the given
+        // ids: {"ids": ["tmdb:603", ...], "fields": ["overview"]}. Ids not in the catalog (yet)
+        // come back in "missing".
+        ipcManager_->RegisterHandler("movieFields", [](const ipc::json &payload, ipc::Responder respond)
+                                     {
+            try {
+                if (!payload.is_object() || !payload.contains("ids") || !payload["ids"].is_array()) {
+                    respond({{"success", false}, {"error", "ids must be an array"}});
+                    return;
+                }
+                const auto ids = payload["ids"].get<std::vector<std::string>>();
+                const auto fields = ParseMediaRequest(payload).fields;
+                std::vector<std::string> missing;
+                const auto items = services::CatalogStore::Instance().Get(ids, &missing);
+
+                respond.Write([&](utils::JsonWriter& writer) {
+                    writer.BeginObject().Field("success", true);
+                    WriteMovies(writer.Key("movies"), items, fields);
+                    writer.Key("missing").StringArray(missing);
+                    writer.EndObject();
+                });
+            }
+            catch (const std::exception& ex) {
+                utils::Logger::Error(fmt::format("Movie fields handler failed: {}", ex.what()));
+                respond({{"success", false}, {"error", ex.what()}});
+            } });
+    }
+
+    void MainWindow::SetupSubscriptionHandlers()
+    {
+        // Server push instead of polling: {"topics": ["providerHealth", "cacheRefreshed"]}. Each
+        // event arrives as a partial response to the subscribe request, with "event" naming
+        // its topic, until {"subscription": <that request's id>} is sent as "unsubscribe".
+        ipcManager_->RegisterHandler("subscribe", [this](const ipc::json &payload, ipc::Responder respond)
+                                     {
+            try {
+                if (!payload.is_object() || !payload.contains("topics") || !payload["topics"].is_array()) {
+                    respond({{"success", false}, {"stream", "complete"}, {"error", "topics must be an array"}});
+                    return;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(subscriptionsMutex_);
+                    if (subscriptions_.contains(respond.Id())) {
+                        respond({{"success", false}, {"error", "Already subscribed with this id"}});
+                        return;
+                    }
+                }
+
+                auto subscription = std::make_shared<Subscription>();
+                subscription->complete = [respond] { respond({{"success", true}, {"stream", "complete"}}); };
+                const auto push = [subscription, respond](const ipc::json &event) {
+                    std::lock_guard<std::mutex> lock(subscription->mutex);
+                    if (!subscription->closed) {
+                        respond(event);
+                    }
+                };
+
+                auto& events = services::ServiceEvents::Instance();
+                for (const auto& topic : payload["topics"].get<std::vector<std::string>>()) {
+                    if (topic == "providerHealth") {
+                        const auto id = events.providerState.Subscribe([push](const services::ProviderStateChanged &event) {
+                            push({{"success", true}, {"stream", "partial"}, {"event", "providerHealth"},
+                                  {"provider", event.providerId}, {"state", services::ToString(event.state)}});
+                        });
+                        subscription->unsubscribe.push_back([id] { services::ServiceEvents::Instance().providerState.Unsubscribe(id); });
+                    } else if (topic == "cacheRefreshed") {
+                        const auto id = events.cacheRefreshed.Subscribe([push](const services::CacheRefreshed &event) {
+                            push({{"success", true}, {"stream", "partial"}, {"event", "cacheRefreshed"},
+                                  {"cacheKey", event.cacheKey}, {"items", event.items}, {"missingProviders", event.missingProviders}});
+                        });
+                        subscription->unsubscribe.push_back([id] { services::ServiceEvents::Instance().cacheRefreshed.Unsubscribe(id); });
+                    } else {
+                        for (const auto& unsubscribe : subscription->unsubscribe) {
+                            unsubscribe();
+                        }
+                        respond({{"success", false}, {"stream", "complete"}, {"error", "Unknown topic: " + topic}});
+                        return;
+                    }
+                }
+
+                std::lock_guard<std::mutex> lock(subscriptionsMutex_);
+                subscriptions_[respond.Id()] = std::move(subscription);
+            }
+            catch (const std::exception& ex) {
+                utils::Logger::Error(fmt::format("Subscribe handler failed: {}", ex.what()));
+                respond({{"success", false}, {"stream", "complete"}, {"error", ex.what()}});
+            } });
+
+        ipcManager_->RegisterHandler("unsubscribe", [this](const ipc::json &payload, ipc::Responder respond)
+                                     {
+            if (!payload.is_object() || !payload.contains("subscription") || !payload["subscription"].is_string()) {
+                respond({{"success", false}, {"error", "subscription must be a request id"}});
+                return;
+            }
+            CloseSubscription(payload["subscription"].get<std::string>());
+            respond({{"success", true}}); });
+    }
+
+    void MainWindow::CloseSubscription(const std::string &id)
+    {
+        std::shared_ptr<Subscription> subscription;
+        {
+            std::lock_guard<std::mutex> lock(subscriptionsMutex_);
+            const auto it = subscriptions_.find(id);
+            if (it == subscriptions_.end())
+                return;
+            subscription = std::move(it->second);
+            subscriptions_.erase(it);
+        }
+
+        // An event already being dispatched may still call the handlers; closed stops it here
+        {
+            std::lock_guard<std::mutex> lock(subscription->mutex);
+            subscription->closed = true;
+        }
+        for (const auto &unsubscribe : subscription->unsubscribe)
+        {
+            unsubscribe();
+        }
+        subscription->complete();
+    }
+
+    void MainWindow::SetupProviderHealthHandler()
+    {
+        ipcManager_->RegisterHandler("providerHealth", [](const ipc::json &, std::function<void(const ipc::json &)> respond)
+                                     {
+            try {
+                ipc::json providers = ipc::json::array();
+                for (const auto& health : services::MediaService::Instance().GetProviderHealth()) {
+                    providers.push_back({
+                        {"id", health.providerId},
+                        {"state", services::ToString(health.state)},
+                        {"degraded", health.state != services::CircuitState::Closed},
+                        {"samples", health.samples},
+                        {"errorRate", health.errorRate},
+                        {"p50Ms", health.p50.count()},
+                        {"p95Ms", health.p95.count()},
+                        {"p99Ms", health.p99.count()},
+                        {"budgetMs", health.budget.count()},
+                        {"consecutiveFailures", health.consecutiveFailures}
+                    });
+                }
+                respond({{"success", true}, {"providers", providers}});
+            }
+            catch (const std::exception& ex) {
+                utils::Logger::Error(fmt::format("Provider health handler failed: {}", ex.what()));
+                respond({{"success", false}, {"error", ex.what()}});
+            } });
     }
 
     std::wstring MainWindow::GetWindowTitle() const
@@ -183,6 +587,12 @@ namespace app::ui
     {
         switch (msg)
         {
+        case WM_APP_FLUSH_IPC:
+            if (transport_)
+            {
+                transport_->Flush();
+            }
+            return 0;
         case WM_SIZE:
             if (webview_)
             {
@@ -2,8 +2,18 @@
 #include "window_base.hpp"
 #include "ipc/ipc_manager.hpp"
 #include "webview_host.hpp"
+#include "webview_transport.hpp"
+#include "media_json.hpp"
+#include "page_versions.hpp"
 #include "utils/win32_utils.hpp"
+#include "services/media/media_service.hpp"
+#include "services/catalog/catalog_store.hpp"
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
 
 namespace app::ui
 {
@@ -22,12 +32,53 @@ namespace app::ui
         LRESULT HandleMessage(UINT msg, WPARAM wParam, LPARAM lParam) override;
 
     private:
+        // Posted by the transport when IPC responses are waiting to be handed to the WebView
+        static constexpr UINT WM_APP_FLUSH_IPC = WM_APP + 1;
+
+        struct MediaRequest
+        {
+            std::string query;
+            std::string catalogType;
+            services::MediaFilter filter;
+            int page = 1;
+            size_t limit = 0; // Top-k window, 0 returns everything the providers sent
+            MovieFields fields;
+            std::string session = "default"; // Whose copy of the view, like a search session
+            std::string view;                // Set to get versioned pages and deltas, see PageVersions
+            std::optional<uint64_t> since;   // Version of the view the page holds
+        };
+
         std::unique_ptr<ipc::IpcManager> ipcManager_;
         std::unique_ptr<WebViewHost> webview_;
+        WebViewTransport *transport_; // Owned by ipcManager_
+        PageVersions pageVersions_;
+
+        // A "subscribe" request. Its events are pushed as partial responses to it until it is closed.
+        struct Subscription
+        {
+            std::mutex mutex; // Held while pushing, so nothing is pushed once closed is set
+            bool closed = false;
+            std::vector<std::function<void()>> unsubscribe;
+            std::function<void()> complete; // Ends the stream on the page
+        };
+        std::mutex subscriptionsMutex_;
+        std::unordered_map<std::string, std::shared_ptr<Subscription>> subscriptions_; // By request id
 
         void InitializeWebView();
         void SetupIpcHandlers();
+        void SetupProviderHealthHandler();
+        void SetupSearchHandler();
+        void SetupBrowseHandler();
+        void SetupFacetsHandler();
+        void SetupMovieFieldsHandler();
+        void SetupSubscriptionHandlers();
+        void CloseSubscription(const std::string &id);
+        void StreamMovies(const MediaRequest &request, ipc::Responder respond);
+        void WritePage(utils::JsonWriter &writer, const MediaRequest &request, const std::vector<domain::MediaMetadata> &items);
         void OnSize(UINT width, UINT height);
+
+        static MediaRequest ParseMediaRequest(const ipc::json &payload);
+        static services::CatalogQuery ParseCatalogQuery(const ipc::json &payload);
     };
 
 } // namespace app::ui
@@ -0,0 +1,96 @@
+#include "media_json.hpp"
+#include <string_view>
+#include <utility>
+
+namespace app::ui
+{
+    namespace
+    {
+        // Keys, punctuation and numbers of one movie, plus headroom for escaping
+        constexpr size_t kMovieOverhead = 160;
+        constexpr size_t kRatingOverhead = 40;
+
+        size_t EstimateSize(const std::vector<domain::MediaMetadata> &movies, MovieFields fields)
+        {
+            size_t size = 2;
+            for (const auto &movie : movies)
+            {
+                size += kMovieOverhead + movie.id.source.Get().size() + movie.id.id.size();
+                if (fields.Has(MovieFields::Title))
+                    size += movie.title.size();
+                if (fields.Has(MovieFields::Overview))
+                    size += movie.overview.size();
+                if (fields.Has(MovieFields::Poster) && movie.posterPath)
+                    size += movie.posterPath->base.Get().size() + movie.posterPath->file.size();
+                if (fields.Has(MovieFields::Ratings))
+                    size += movie.sourceRatings.size() * kRatingOverhead;
+            }
+            return size;
+        }
+    }
+
+    MovieFields MovieFields::FromNames(const std::vector<std::string> &names)
+    {
+        static constexpr std::pair<std::string_view, uint32_t> kNames[] = {
+            {"title", Title}, {"overview", Overview}, {"rating", Rating}, {"voteCount", VoteCount}, {"poster", Poster}, {"ratings", Ratings}};
+
+        MovieFields fields{0};
+        for (const auto &name : names)
+        {
+            for (const auto &[known, field] : kNames)
+            {
+                if (name == known)
+                    fields.mask |= field;
+            }
+        }
+        return fields;
+    }
+
+    void WriteMovie(utils::JsonWriter &writer, const domain::MediaMetadata &movie, MovieFields fields)
+    {
+        writer.BeginObject();
+        writer.Key("id").String({movie.id.source.Get(), ":", movie.id.id});
+        if (fields.Has(MovieFields::Title))
+            writer.Field("title", !movie.title.empty() ? std::string_view(movie.title) : "Untitled");
+        if (fields.Has(MovieFields::Overview))
+            writer.Field("overview", !movie.overview.empty() ? std::string_view(movie.overview) : "No overview available");
+        if (fields.Has(MovieFields::Rating))
+            writer.Field("rating", movie.rating);
+        if (fields.Has(MovieFields::VoteCount))
+            writer.Field("voteCount", movie.voteCount);
+
+        if (fields.Has(MovieFields::Poster))
+        {
+            writer.Key("poster");
+            if (movie.posterPath.has_value() && !movie.posterPath->empty())
+                writer.String({movie.posterPath->base.Get(), movie.posterPath->file});
+            else
+                writer.Null();
+        }
+
+        // Titles merged from several providers carry each provider's rating
+        if (fields.Has(MovieFields::Ratings) && !movie.sourceRatings.empty())
+        {
+            writer.Key("ratings").BeginArray();
+            for (const auto &rating : movie.sourceRatings)
+            {
+                writer.BeginObject().Field("source", rating.source.Get()).Field("rating", rating.value).EndObject();
+            }
+            writer.EndArray();
+        }
+        writer.EndObject();
+    }
+
+    void WriteMovies(utils::JsonWriter &writer, const std::vector<domain::MediaMetadata> &movies, MovieFields fields)
+    {
+        auto &out = writer.Output();
+        out.reserve(out.size() + EstimateSize(movies, fields));
+
+        writer.BeginArray();
+        for (const auto &movie : movies)
+        {
+            WriteMovie(writer, movie, fields);
+        }
+        writer.EndArray();
+    }
+} // namespace app::ui
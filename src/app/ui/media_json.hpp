@@ -0,0 +1,42 @@
+#pragma once
+#include "domain/models/media_types.hpp"
+#include "utils/json_writer.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace app::ui
+{
+    // Which fields of a movie are written. A request can name only what it renders, e.g.
+    // "fields": ["title", "poster", "rating"] for the grid, and fetch the rest per id later.
+    // The id is always written.
+    struct MovieFields
+    {
+        enum : uint32_t
+        {
+            Title = 1 << 0,
+            Overview = 1 << 1,
+            Rating = 1 << 2,
+            VoteCount = 1 << 3,
+            Poster = 1 << 4,
+            Ratings = 1 << 5,
+            All = (1 << 6) - 1
+        };
+
+        uint32_t mask = All;
+
+        // Unknown names are ignored, so an older backend still answers a newer page
+        static MovieFields FromNames(const std::vector<std::string> &names);
+        bool Has(uint32_t field) const { return (mask & field) != 0; }
+    };
+
+    // One movie of the list below
+    void WriteMovie(utils::JsonWriter &writer, const domain::MediaMetadata &movie, MovieFields fields = {});
+
+    // The movie list the web UI renders, written straight to JSON:
+    // [{"id","title","overview","rating","voteCount","poster","ratings"?}, ...]
+    // limited to the requested fields. The output buffer is grown once, up front, for the
+    // whole list.
+    void WriteMovies(utils::JsonWriter &writer, const std::vector<domain::MediaMetadata> &movies,
+                     MovieFields fields = {});
+} // namespace app::ui
@@ -0,0 +1,164 @@
+#include "page_versions.hpp"
+#include <algorithm>
+#include <functional>
+#include <string_view>
+
+namespace app::ui
+{
+    void PageVersions::Write(utils::JsonWriter &writer, const std::string &session, const std::string &view,
+                             std::optional<uint64_t> since, const std::vector<domain::MediaMetadata> &items, MovieFields fields)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        SentPage page;
+        page.version = nextVersion_++;
+        page.fields = fields.mask;
+        page.lastUsed = ++clock_;
+        page.ids.reserve(items.size());
+        page.hashes.reserve(items.size());
+        page.movies.swap(spareMovies_);
+        page.offsets.swap(spareOffsets_);
+
+        page.movies.clear();
+        page.offsets.assign(1, 0);
+        for (const auto &item : items)
+        {
+            utils::JsonWriter movieWriter(page.movies);
+            WriteMovie(movieWriter, item, fields);
+            page.offsets.push_back(page.movies.size());
+            page.ids.push_back(item.id.source + ":" + item.id.id);
+            page.hashes.push_back(std::hash<std::string_view>{}(page.Movie(page.ids.size() - 1)));
+        }
+        const auto movie = [&page](size_t i)
+        { return page.Movie(i); };
+        const size_t fullBytes = page.movies.size() + items.size();
+
+        // Compared by id against the page the view was last sent, if that is what it holds
+        auto key = std::make_pair(session, view);
+        const auto it = views_.find(key);
+        const SentPage *base = nullptr;
+        if (it != views_.end() && since == it->second.version && it->second.fields == fields.mask)
+        {
+            base = &it->second;
+        }
+
+        std::vector<size_t> inserted, changed, removed;
+        bool reordered = false;
+        size_t deltaBytes = 0;
+        if (base)
+        {
+            std::unordered_map<std::string_view, size_t> oldRows;
+            oldRows.reserve(base->ids.size());
+            for (size_t j = 0; j < base->ids.size(); ++j)
+            {
+                oldRows.emplace(base->ids[j], j);
+            }
+
+            std::vector<bool> kept(base->ids.size(), false);
+            for (size_t i = 0; i < page.ids.size(); ++i)
+            {
+                const auto row = oldRows.find(page.ids[i]);
+                if (row == oldRows.end())
+                {
+                    inserted.push_back(i);
+                    deltaBytes += movie(i).size() + 1;
+                    continue;
+                }
+                kept[row->second] = true;
+                // A hash match alone could hide a change
+                if (base->hashes[row->second] != page.hashes[i] || base->Movie(row->second) != movie(i))
+                {
+                    changed.push_back(i);
+                    deltaBytes += movie(i).size() + 1;
+                }
+            }
+
+            // The order the page ends up with from removals and inserts alone
+            std::vector<std::string_view> implied;
+            implied.reserve(page.ids.size());
+            for (size_t j = 0; j < base->ids.size(); ++j)
+            {
+                if (kept[j])
+                    implied.push_back(base->ids[j]);
+                else
+                {
+                    removed.push_back(j);
+                    deltaBytes += base->ids[j].size() + 3;
+                }
+            }
+            for (const size_t i : inserted)
+            {
+                implied.push_back(page.ids[i]);
+            }
+            reordered = !std::equal(implied.begin(), implied.end(), page.ids.begin(), page.ids.end());
+            if (reordered)
+            {
+                for (const auto &id : page.ids)
+                {
+                    deltaBytes += id.size() + 3;
+                }
+            }
+
+            if (deltaBytes >= fullBytes)
+            {
+                base = nullptr;
+            }
+        }
+
+        writer.Output().reserve(writer.Output().size() + (base ? deltaBytes : fullBytes) + 64);
+        writer.Field("version", page.version);
+        if (base)
+        {
+            writer.Field("base", base->version);
+            writer.Key("delta").BeginObject();
+            writer.Key("removed").BeginArray();
+            for (const size_t j : removed)
+            {
+                writer.String(base->ids[j]);
+            }
+            writer.EndArray();
+            writer.Key("inserted").BeginArray();
+            for (const size_t i : inserted)
+            {
+                writer.Raw(movie(i));
+            }
+            writer.EndArray();
+            writer.Key("changed").BeginArray();
+            for (const size_t i : changed)
+            {
+                writer.Raw(movie(i));
+            }
+            writer.EndArray();
+            if (reordered)
+            {
+                writer.Key("order").StringArray(page.ids);
+            }
+            writer.EndObject();
+        }
+        else
+        {
+            writer.Key("movies").BeginArray();
+            for (size_t i = 0; i < page.ids.size(); ++i)
+            {
+                writer.Raw(movie(i));
+            }
+            writer.EndArray();
+        }
+
+        auto &slot = views_[std::move(key)];
+        spareMovies_.swap(slot.movies);
+        spareOffsets_.swap(slot.offsets);
+        slot = std::move(page);
+        if (views_.size() > kMaxViews)
+        {
+            Evict();
+        }
+    }
+
+    void PageVersions::Evict()
+    {
+        const auto oldest = std::min_element(views_.begin(), views_.end(), [](const auto &a, const auto &b)
+                                             { return a.second.lastUsed < b.second.lastUsed; });
+        views_.erase(oldest);
+    }
+} // namespace app::ui
@@ -0,0 +1,61 @@
+#pragma once
+#include "media_json.hpp"
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace app::ui
+{
+    // Versioned result pages, so a refreshed page costs only what changed. A request names
+    // its session and view (e.g. "home-grid") and the version of it the page holds; the page
+    // that was last sent for that view of that session is remembered, and the new one goes
+    // out as
+    //
+    //   "version":12,"base":11,"delta":{"removed":[id...],"inserted":[movie...],
+    //                                  "changed":[movie...],"order":[id...]}
+    //
+    // or, for a first request, a version the page no longer holds, other fields, or a delta
+    // that would not be smaller, in full as "version":12,"movies":[...]. "order" is only sent
+    // when the new order is not the old one with removed items dropped and inserted ones
+    // appended. A page must apply a delta only on top of its base version, otherwise ask
+    // again without one.
+    class PageVersions
+    {
+    public:
+        static constexpr size_t kMaxViews = 64; // Across sessions; least recently refreshed are forgotten
+
+        // Writes the page as fields of the response object being written
+        void Write(utils::JsonWriter &writer, const std::string &session, const std::string &view,
+                   std::optional<uint64_t> since, const std::vector<domain::MediaMetadata> &items, MovieFields fields);
+
+    private:
+        struct SentPage
+        {
+            uint64_t version = 0;
+            uint32_t fields = 0;
+            uint64_t lastUsed = 0;
+            std::vector<std::string> ids;
+            std::vector<size_t> hashes; // Of each movie's JSON; equal ones are confirmed on the bytes
+            std::string movies;         // Each movie's JSON, serialized once for hashing and for output
+            std::vector<size_t> offsets;
+
+            std::string_view Movie(size_t i) const { return std::string_view(movies).substr(offsets[i], offsets[i + 1] - offsets[i]); }
+        };
+
+        void Evict();
+
+        std::mutex mutex_;
+        std::map<std::pair<std::string, std::string>, SentPage> views_; // By session, then view
+        uint64_t nextVersion_ = 1; // Shared by all views, so a forgotten view never reuses a version
+        uint64_t clock_ = 0;
+
+        // Buffers of the last replaced page, reused for the next one
+        std::string spareMovies_;
+        std::vector<size_t> spareOffsets_;
+    };
+} // namespace app::ui
@@ -181,8 +181,6 @@ namespace app::ui
                     LPWSTR message;
                     args->get_WebMessageAsJson(&message);
 
-                    utils::Logger::Info("WebMessage received: " + utils::WideToUtf8(message));
-
                     if (messageCallback_)
                     {
                         messageCallback_(message);
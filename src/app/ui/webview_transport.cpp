@@ -0,0 +1,76 @@
+#include "webview_transport.hpp"
+#include "utils/win32_utils.hpp"
+#include "utils/logger.hpp"
+#include <utility>
+
+namespace app::ui
+{
+    WebViewTransport::WebViewTransport(WebViewHost &host, HWND window, UINT flushMessage)
+        : host_(host), window_(window), flushMessage_(flushMessage) {}
+
+    void WebViewTransport::SetMessageHandler(MessageHandler handler)
+    {
+        handler_ = std::move(handler);
+        host_.SetMessageCallback([this](const wchar_t *message)
+                                 {
+            utils::WideToUtf8(message, inbound_);
+            handler_(inbound_); });
+    }
+
+    void WebViewTransport::StopReceiving()
+    {
+        host_.SetMessageCallback(nullptr);
+    }
+
+    void WebViewTransport::Send(std::string_view message)
+    {
+        std::wstring wideMessage;
+        {
+            std::lock_guard<std::mutex> lock(outboundMutex_);
+            if (!spares_.empty())
+            {
+                wideMessage = std::move(spares_.back());
+                spares_.pop_back();
+            }
+        }
+        utils::Utf8ToWide(message, wideMessage);
+
+        bool post = false;
+        {
+            std::lock_guard<std::mutex> lock(outboundMutex_);
+            outbound_.push_back(std::move(wideMessage));
+            post = !std::exchange(flushPending_, true);
+        }
+        if (post && !PostMessage(window_, flushMessage_, 0, 0))
+        {
+            // Let the next message try again rather than leave this one stranded
+            utils::Logger::Warning("Failed to post IPC flush message");
+            std::lock_guard<std::mutex> lock(outboundMutex_);
+            flushPending_ = false;
+        }
+    }
+
+    void WebViewTransport::Flush()
+    {
+        std::deque<std::wstring> messages;
+        {
+            std::lock_guard<std::mutex> lock(outboundMutex_);
+            messages.swap(outbound_);
+            flushPending_ = false;
+        }
+        for (const auto &message : messages)
+        {
+            host_.PostWebMessage(message);
+        }
+
+        std::lock_guard<std::mutex> lock(outboundMutex_);
+        for (auto &message : messages)
+        {
+            if (spares_.size() == kMaxSpares)
+                break;
+            if (message.capacity() <= kMaxSpareCapacity)
+                spares_.push_back(std::move(message));
+        }
+    }
+
+} // namespace app::ui
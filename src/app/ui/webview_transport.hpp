@@ -0,0 +1,47 @@
+#pragma once
+#include "ipc/ipc_transport.hpp"
+#include "webview_host.hpp"
+#include <Windows.h>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace app::ui
+{
+    // The app's IPC transport: messages from the page arrive on the UI thread as UTF-16 and
+    // are passed on as UTF-8. WebView2 only accepts messages on the UI thread, so Send
+    // converts on the calling thread, queues, and posts flushMessage to the window once per
+    // batch; the window calls Flush when it gets it.
+    //
+    // Conversion buffers are reused: one for incoming messages, and outgoing ones go back to
+    // a spare list once posted, so steady traffic converts without allocating.
+    class WebViewTransport : public ipc::IpcTransport
+    {
+    public:
+        WebViewTransport(WebViewHost &host, HWND window, UINT flushMessage);
+
+        void SetMessageHandler(MessageHandler handler) override;
+        void Send(std::string_view message) override;
+        // UI thread, like the messages it stops
+        void StopReceiving() override;
+
+        // UI thread: posts every queued message to the page
+        void Flush();
+
+    private:
+        WebViewHost &host_;
+        HWND window_;
+        UINT flushMessage_;
+        static constexpr size_t kMaxSpares = 8;
+        static constexpr size_t kMaxSpareCapacity = 1 << 20; // Larger buffers are freed, not kept
+
+        MessageHandler handler_;
+        std::string inbound_; // UI thread only
+
+        std::mutex outboundMutex_;
+        std::deque<std::wstring> outbound_;
+        std::vector<std::wstring> spares_;
+        bool flushPending_ = false; // flushMessage_ is posted and Flush has not run since
+    };
+} // namespace app::ui
@@ -106,7 +106,8 @@ namespace app::config
             nlohmann::json defaultConfig = {
                 {"providers_dir", providersDir},
                 {"window", {{"width", 1280}, {"height", 720}}},
-                {"webview", {{"url", "http://localhost:3000"}}}};
+                {"webview", {{"url", "http://localhost:3000"}}},
+                {"search", {{"deadline_ms", 5000}, {"provider_budget_ms", 4000}, {"min_provider_budget_ms", 1000}, {"debounce_ms", 150}}}};
 
             utils::Logger::Info("Loading providers from: " + defaultConfig["providersDir"]);
 
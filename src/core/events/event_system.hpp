@@ -1,5 +1,35 @@
+#pragma once
+#include "utils/logger.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
 namespace app::events
 {
+    // Publishes events of one type to any number of handlers, from any thread.
+    //
+    // The handler list is immutable and replaced as a whole by Subscribe and Unsubscribe
+    // (copy-on-write). Dispatch only takes a snapshot of it, so it never waits for more than
+    // a pointer copy, never calls handlers under a lock, and handlers may subscribe or
+    // unsubscribe from inside a handler. A Dispatch already running keeps the list it
+    // started with: a handler can still be called once after Unsubscribe returns, and must
+    // cope with that.
+    //
+    // Post queues the event for the dispatcher's own thread instead, for publishers that
+    // must not run handler code, e.g. while holding a lock. Posts with the same non-empty
+    // coalescing key replace one another while they wait, so a burst of updates to one
+    // thing is delivered once, with the latest value, in the place of the first.
     template <typename EventType>
     class EventDispatcher
     {
@@ -7,28 +37,136 @@ namespace app::events
         using HandlerId = uint64_t;
         using Handler = std::function<void(const EventType &)>;
 
+        EventDispatcher() = default;
+
+        ~EventDispatcher()
+        {
+            {
+                std::lock_guard<std::mutex> lock(queueMutex_);
+                stopping_ = true;
+                queue_.clear(); // Handlers may already be gone
+            }
+            queueReady_.notify_all();
+            if (worker_.joinable())
+            {
+                worker_.join();
+            }
+        }
+
+        EventDispatcher(const EventDispatcher &) = delete;
+        EventDispatcher &operator=(const EventDispatcher &) = delete;
+
         HandlerId Subscribe(Handler handler)
         {
             const auto id = nextHandlerId_++;
-            handlers_[id] = std::move(handler);
+            std::lock_guard<std::mutex> lock(writeMutex_);
+            auto next = std::make_shared<HandlerList>(*handlers_.load());
+            next->emplace_back(id, std::make_shared<const Handler>(std::move(handler)));
+            handlers_.store(std::move(next));
             return id;
         }
 
         void Unsubscribe(HandlerId id)
         {
-            handlers_.erase(id);
+            std::lock_guard<std::mutex> lock(writeMutex_);
+            auto next = std::make_shared<HandlerList>(*handlers_.load());
+            std::erase_if(*next, [id](const auto &entry)
+                          { return entry.first == id; });
+            handlers_.store(std::move(next));
+        }
+
+        // Calls the handlers on this thread, in the order they subscribed
+        void Dispatch(const EventType &event) const
+        {
+            const auto handlers = handlers_.load();
+            for (const auto &[id, handler] : *handlers)
+            {
+                (*handler)(event);
+            }
         }
 
-        void Dispatch(const EventType &event)
+        // Returns at once; the event is dispatched on the dispatcher's thread, started on first use
+        void Post(EventType event, std::string coalesceKey = {})
         {
-            for (const auto &[id, handler] : handlers_)
             {
-                handler(event);
+                std::lock_guard<std::mutex> lock(queueMutex_);
+                if (stopping_)
+                {
+                    return;
+                }
+                if (!coalesceKey.empty())
+                {
+                    const auto pending = std::find_if(queue_.begin(), queue_.end(), [&](const Queued &queued)
+                                                      { return queued.key == coalesceKey; });
+                    if (pending != queue_.end())
+                    {
+                        pending->event = std::move(event);
+                        return;
+                    }
+                }
+                queue_.push_back(Queued{std::move(event), std::move(coalesceKey)});
+                if (!worker_.joinable())
+                {
+                    worker_ = std::thread([this]
+                                          { DispatchLoop(); });
+                }
             }
+            queueReady_.notify_one();
+        }
+
+        size_t HandlerCount() const
+        {
+            return handlers_.load()->size();
         }
 
     private:
-        std::unordered_map<HandlerId, Handler> handlers_;
+        using HandlerList = std::vector<std::pair<HandlerId, std::shared_ptr<const Handler>>>;
+
+        struct Queued
+        {
+            EventType event;
+            std::string key;
+        };
+
+        void DispatchLoop()
+        {
+            for (;;)
+            {
+                std::optional<Queued> next;
+                {
+                    std::unique_lock<std::mutex> lock(queueMutex_);
+                    queueReady_.wait(lock, [this]
+                                     { return stopping_ || !queue_.empty(); });
+                    if (stopping_)
+                    {
+                        return;
+                    }
+                    next.emplace(std::move(queue_.front()));
+                    queue_.pop_front();
+                }
+
+                // A failing handler must not take the thread, and every later event, with it
+                try
+                {
+                    Dispatch(next->event);
+                }
+                catch (const std::exception &e)
+                {
+                    utils::Logger::Error("Event handler failed: " + std::string(e.what()));
+                }
+            }
+        }
+
+        std::mutex writeMutex_; // Serializes Subscribe and Unsubscribe; Dispatch never takes it
+        // Not lock-free on libstdc++ or MSVC: loads and stores go through the standard library's
+        // own short lock, held only while the pointer is copied or swapped
+        std::atomic<std::shared_ptr<const HandlerList>> handlers_{std::make_shared<const HandlerList>()};
         static inline std::atomic<HandlerId> nextHandlerId_{0};
+
+        std::mutex queueMutex_;
+        std::condition_variable queueReady_;
+        std::deque<Queued> queue_;
+        bool stopping_ = false;
+        std::thread worker_;
     };
-}
\ No newline at end of file
+}
@@ -1,13 +1,67 @@
 #include "ipc_manager.hpp"
 #include "utils/logger.hpp"
+#include <algorithm>
 
 namespace app::ipc
 {
 
-    IpcManager::IpcManager() = default;
-    IpcManager::~IpcManager() = default;
+    namespace
+    {
+        constexpr std::string_view kBatchOpen = "{\"batch\":[";
+        constexpr std::string_view kBatchClose = "]}";
+    }
+
+    IpcManager::IpcManager(size_t workers, size_t queueCapacity, std::chrono::milliseconds coalesceWindow)
+        : queueCapacity_(std::max<size_t>(queueCapacity, 1)),
+          coalesceWindow_(coalesceWindow)
+    {
+        workers = std::max<size_t>(workers, 1);
+        workers_.reserve(workers);
+        for (size_t i = 0; i < workers; ++i)
+        {
+            workers_.emplace_back([this]
+                                  { WorkerLoop(); });
+        }
+        flusher_ = std::thread([this]
+                               { FlushLoop(); });
+    }
 
-    void IpcManager::HandleWebMessage(const std::wstring &message)
+    IpcManager::~IpcManager()
+    {
+        // Members outlive this body, so the transport would still be receiving while the
+        // workers below are joined. Nothing comes in from here on; responses still go out.
+        if (transport_)
+        {
+            transport_->StopReceiving();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(jobsMutex_);
+            stopping_ = true;
+            jobs_.clear(); // Nobody is left to read their responses
+        }
+        jobsReady_.notify_all();
+        for (auto &worker : workers_)
+        {
+            worker.join();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(outboxMutex_);
+            outboxStopping_ = true;
+        }
+        outboxReady_.notify_all();
+        flusher_.join();
+    }
+
+    void IpcManager::SetTransport(std::unique_ptr<IpcTransport> transport)
+    {
+        transport_ = std::move(transport);
+        transport_->SetMessageHandler([this](std::string_view message)
+                                      { HandleMessage(message); });
+    }
+
+    void IpcManager::HandleMessage(std::string_view message)
     {
         try
         {
@@ -16,95 +70,280 @@ namespace app::ipc
                 throw std::runtime_error("Empty message received");
             }
 
-            // Allocate a buffer for the converted UTF-8 string
-            int bufferSize = WideCharToMultiByte(CP_UTF8, 0, message.c_str(), static_cast<int>(message.length()),
-                                                 nullptr, 0, nullptr, nullptr);
+            json data = json::parse(message);
 
-            if (bufferSize <= 0)
+            if (data.value("type", std::string()) == "batch")
             {
-                throw std::runtime_error("Failed to calculate buffer size for UTF-8 conversion");
-            }
+                if (!data.contains("payload") || !data["payload"].is_array())
+                {
+                    throw std::runtime_error("Batch payload is not an array");
+                }
 
-            // Allocate buffer for the converted string (+1 for null terminator)
-            std::vector<char> utf8Buffer(bufferSize + 1);
+                // Held while the entries are submitted, so the responses of the first ones wait
+                // for the rest instead of being flushed on their own
+                ++batchedInFlight_;
+                for (auto &entry : data["payload"])
+                {
+                    try
+                    {
+                        if (!entry.is_object() || !entry.contains("type") || !entry.contains("id") || !entry.contains("payload"))
+                        {
+                            throw std::runtime_error("Missing required fields in batch entry");
+                        }
+                        Submit(entry["type"], entry["id"], std::move(entry["payload"]), true);
+                    }
+                    catch (const std::exception &e)
+                    {
+                        utils::Logger::Error("Failed to handle batched web message: " + std::string(e.what()));
+                        Reject(entry, e.what(), true);
+                    }
+                }
+                Finished(true);
+                return;
+            }
 
-            int result = WideCharToMultiByte(CP_UTF8, 0, message.c_str(), static_cast<int>(message.length()),
-                                             utf8Buffer.data(), bufferSize, nullptr, nullptr);
+            try
+            {
+                // Validate required fields
+                if (!data.contains("type") || !data.contains("id") || !data.contains("payload"))
+                {
+                    throw std::runtime_error("Missing required fields in message");
+                }
 
-            if (result <= 0)
+                Submit(data["type"], data["id"], std::move(data["payload"]), false);
+            }
+            catch (const std::exception &e)
             {
-                throw std::runtime_error("Failed to convert wide string to UTF-8");
+                utils::Logger::Error("Failed to handle web message: " + std::string(e.what()));
+                Reject(data, e.what(), false);
             }
+        }
+        catch (const std::exception &e)
+        {
+            utils::Logger::Error("Failed to handle web message: " + std::string(e.what()));
+        }
+    }
 
-            // Ensure null termination
-            utf8Buffer[bufferSize] = '\0';
+    void IpcManager::Reject(const json &request, const std::string &error, bool batched)
+    {
+        if (request.is_object() && request.contains("id") && request["id"].is_string())
+        {
+            SendResponse(request["id"], {{"success", false}, {"error", error}}, batched);
+        }
+    }
 
-            // Create string from buffer
-            std::string utf8Message(utf8Buffer.data(), bufferSize);
+    void IpcManager::Submit(const std::string &type, const std::string &id, json &&payload, bool batched)
+    {
+        const auto it = handlers_.find(type);
+        if (it == handlers_.end())
+        {
+            throw std::runtime_error("No handler registered for type: " + type);
+        }
 
-            // Parse JSON
-            json data = json::parse(utf8Message);
+        const Handler &handler = it->second;
+        if (batched)
+        {
+            ++batchedInFlight_;
+        }
+        if (handler.dispatch == Dispatch::Inline)
+        {
+            Run(handler, id, payload, batched);
+            Finished(batched);
+            return;
+        }
 
-            // Validate required fields
-            if (!data.contains("type") || !data.contains("id") || !data.contains("payload"))
+        bool queued = false;
+        {
+            std::lock_guard<std::mutex> lock(jobsMutex_);
+            if (jobs_.size() < queueCapacity_)
             {
-                throw std::runtime_error("Missing required fields in message");
+                jobs_.push_back(Job{&handler, id, std::move(payload), batched});
+                queued = true;
             }
+        }
+        if (queued)
+        {
+            jobsReady_.notify_one();
+            return;
+        }
 
-            std::string type = data["type"];
-            std::string id = data["id"];
-            json payload = data["payload"];
+        // Backpressure: the caller hears straight away instead of queueing behind a backlog
+        utils::Logger::Warning("IPC queue full, rejecting " + type + " request");
+        SendResponse(id, {{"success", false}, {"busy", true}, {"code", kBusyCode}, {"error", "Too many requests in flight, try again"}}, batched);
+        Finished(batched);
+    }
 
-            if (handlers_.find(type) != handlers_.end())
-            {
-                handlers_[type](payload, [this, id](const json &response)
-                                { SendResponse(id, response); });
-            }
-            else
+    void IpcManager::RegisterHandler(const std::string &type, IpcHandlerCallback handler, Dispatch dispatch)
+    {
+        handlers_[type] = Handler{std::move(handler), dispatch};
+    }
+
+    void IpcManager::WorkerLoop()
+    {
+        for (;;)
+        {
+            Job job;
             {
-                utils::Logger::Warning("No handler registered for type: " + type);
+                std::unique_lock<std::mutex> lock(jobsMutex_);
+                jobsReady_.wait(lock, [this]
+                                { return stopping_ || !jobs_.empty(); });
+                if (stopping_)
+                {
+                    return;
+                }
+                job = std::move(jobs_.front());
+                jobs_.pop_front();
             }
+            Run(*job.handler, job.id, job.payload, job.batched);
+            Finished(job.batched);
+        }
+    }
+
+    void IpcManager::Run(const Handler &handler, const std::string &id, const json &payload, bool batched)
+    {
+        try
+        {
+            handler.callback(payload, Responder(this, id, batched));
         }
         catch (const std::exception &e)
         {
-            utils::Logger::Error("Failed to handle web message: " + std::string(e.what()));
+            utils::Logger::Error("IPC handler failed: " + std::string(e.what()));
+            SendResponse(id, {{"success", false}, {"error", e.what()}}, batched);
         }
     }
 
-    void IpcManager::SetWebViewCallback(WebMessageCallback callback)
+    void IpcManager::Finished(bool batched)
     {
-        webviewCallback_ = std::move(callback);
+        // The last batched request has run: what it and the others answered goes out now
+        if (batched && --batchedInFlight_ == 0)
+        {
+            Flush();
+        }
     }
 
-    void IpcManager::RegisterHandler(const std::string &type, IpcHandlerCallback handler)
+    void IpcManager::SendResponse(const std::string &id, const json &response, bool batched)
     {
-        handlers_[type] = std::move(handler);
+        SendEnvelope(id, [&response](utils::JsonWriter &writer)
+                     { writer.Raw(response.dump()); }, batched);
     }
 
-    void IpcManager::SendResponse(const std::string &id, const json &response)
+    void IpcManager::SendEnvelope(const std::string &id, const std::function<void(utils::JsonWriter &)> &writePayload, bool batched)
     {
-        if (!webviewCallback_)
+        if (!transport_)
             return;
 
-        json message = {{"id", id}, {"payload", response}};
-        std::string utf8Message = message.dump();
+        // Serialized on the calling thread, so the receiving thread is left to receive. The
+        // buffer keeps its capacity between responses; a response sent while one is being
+        // written on the same thread, by a transport delivering synchronously, gets its own.
+        thread_local std::string reused;
+        thread_local bool reusedBusy = false;
+        std::string nested;
+        const bool outer = !reusedBusy;
+        std::string &buffer = outer ? reused : nested;
+        struct Release
+        {
+            bool active;
+            ~Release()
+            {
+                if (active)
+                    reusedBusy = false;
+            }
+        } release{outer};
+        reusedBusy = true;
+
+        buffer.clear();
+        utils::JsonWriter writer(buffer);
+        writer.BeginObject().Key("id").String(id).Key("payload");
+        writePayload(writer);
+        writer.EndObject();
+        if (batched)
+            AddToBatch(buffer);
+        else
+            transport_->Send(buffer);
+    }
+
+    void IpcManager::AddToBatch(std::string_view entry)
+    {
+        bool full = false;
+        bool first = false;
+        {
+            std::lock_guard<std::mutex> lock(outboxMutex_);
+            if (outboxEntries_ == 0)
+            {
+                outbox_.assign(kBatchOpen);
+                outboxDeadline_ = std::chrono::steady_clock::now() + coalesceWindow_;
+                first = true;
+            }
+            else
+            {
+                outbox_ += ',';
+            }
+            outbox_ += entry;
+            ++outboxEntries_;
+            full = outbox_.size() >= kMaxBatchBytes;
+        }
+
+        if (full)
+            Flush();
+        else if (first)
+            outboxReady_.notify_one();
+    }
 
-        // Convert UTF-8 to wide string properly
-        int wideLength = MultiByteToWideChar(CP_UTF8, 0, utf8Message.c_str(), -1, nullptr, 0);
-        if (wideLength == 0)
+    void IpcManager::Flush()
+    {
+        // Held across the send so two batches cannot overtake each other, which would let a
+        // final response arrive before a partial one of the same request
+        std::lock_guard<std::recursive_mutex> flushLock(flushMutex_);
+        std::string batch;
         {
-            utils::Logger::Error("Failed to calculate wide string length");
-            return;
+            std::lock_guard<std::mutex> lock(outboxMutex_);
+            if (outboxEntries_ == 0)
+                return;
+            batch.swap(outbox_);
+            outbox_.swap(spareOutbox_);
+            outboxEntries_ = 0;
         }
 
-        std::wstring wideMessage(wideLength - 1, L'\0'); // -1 to not include null terminator in string
-        if (MultiByteToWideChar(CP_UTF8, 0, utf8Message.c_str(), -1, &wideMessage[0], wideLength) == 0)
+        batch += kBatchClose;
+        transport_->Send(batch);
+
+        std::lock_guard<std::mutex> lock(outboxMutex_);
+        if (batch.capacity() > spareOutbox_.capacity() && batch.capacity() <= kMaxBatchBytes * 2)
+            spareOutbox_.swap(batch);
+    }
+
+    void IpcManager::FlushLoop()
+    {
+        // Sends what batched responses came in after their requests had run, e.g. streamed
+        // partials, once the coalescing window of the first of them has passed
+        std::unique_lock<std::mutex> lock(outboxMutex_);
+        for (;;)
         {
-            utils::Logger::Error("Failed to convert UTF-8 to wide string");
-            return;
+            outboxReady_.wait(lock, [this]
+                              { return outboxStopping_ || outboxEntries_ > 0; });
+            if (outboxStopping_)
+                return;
+
+            // Woken early when the batch was flushed, and maybe a new one started, in the meantime
+            const auto deadline = outboxDeadline_;
+            if (!outboxReady_.wait_until(lock, deadline, [this, deadline]
+                                         { return outboxStopping_ || outboxEntries_ == 0 || outboxDeadline_ != deadline; }))
+            {
+                lock.unlock();
+                Flush();
+                lock.lock();
+            }
         }
+    }
+
+    void Responder::operator()(const json &response) const
+    {
+        manager_->SendResponse(id_, response, batched_);
+    }
 
-        webviewCallback_(wideMessage);
+    void Responder::Write(const std::function<void(utils::JsonWriter &)> &writePayload) const
+    {
+        manager_->SendEnvelope(id_, writePayload, batched_);
     }
 
     void IpcManager::RegisterNavigationHandler()
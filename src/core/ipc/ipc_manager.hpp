@@ -1,17 +1,49 @@
 #pragma once
+#include "ipc_transport.hpp"
+#include "utils/json_writer.hpp"
 #include <unordered_map>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 #include <nlohmann/json.hpp>
-#include <Windows.h>
-#include <string>
 
 namespace app::ipc
 {
 
     using json = nlohmann::json;
-    using WebMessageCallback = std::function<void(const std::wstring &)>;
-    using IpcHandlerCallback = std::function<void(const json &, std::function<void(const json &)>)>;
+
+    class IpcManager;
+
+    // Answers one request. May be copied, and called from any thread any number of times.
+    // Converts to std::function<void(const json &)> for handlers that only reply with json.
+    class Responder
+    {
+    public:
+        void operator()(const json &response) const;
+        // Writes the payload straight into the response envelope, without building a json tree
+        void Write(const std::function<void(utils::JsonWriter &)> &writePayload) const;
+        // The id of the request being answered
+        const std::string &Id() const { return id_; }
+
+    private:
+        friend class IpcManager;
+        Responder(IpcManager *manager, std::string id, bool batched)
+            : manager_(manager), id_(std::move(id)), batched_(batched) {}
+
+        IpcManager *manager_;
+        std::string id_;
+        bool batched_; // Came in a batch, so goes out coalesced with other responses
+    };
+
+    using IpcHandlerCallback = std::function<void(const json &, Responder)>;
 
     struct NavigationRequest
     {
@@ -23,23 +55,107 @@ namespace app::ipc
         }
     };
 
+    // Dispatches UTF-8 JSON messages from a transport to handlers without blocking the
+    // thread the transport receives on, which for WebView2 is the UI thread.
+    //
+    // HandleMessage parses the message and queues the handler for a worker pool; when the
+    // queue is full the request is answered at once with a busy error (kBusyCode) instead
+    // of waiting. Responses, from whichever thread, are serialized there and given to the
+    // transport, which gets them to the peer on whatever thread that needs.
+    //
+    // A peer issuing several requests at once can send them as one message, so the crossing
+    // is paid once: {"type":"batch","payload":[{"type","id","payload"}, ...]}. Responses to
+    // batched requests are coalesced the same way, as {"batch":[{"id","payload"}, ...]}. They
+    // are sent as soon as no batched request is left running, or when the coalescing window
+    // after the first one has passed, for replies that arrive later from other threads.
+    //
+    // A request that cannot be dispatched, malformed or of an unknown type, is answered with
+    // {"success":false,"error":...} when it has an id, so its caller is never left waiting.
     class IpcManager
     {
     public:
-        IpcManager();
+        enum class Dispatch
+        {
+            Worker, // Runs on the pool, may block
+            Inline  // Runs on the receiving thread in arrival order; must return promptly
+        };
+
+        static constexpr size_t kDefaultWorkers = 4;
+        static constexpr size_t kDefaultQueueCapacity = 64;
+        static constexpr int kBusyCode = 503;
+        static constexpr std::chrono::milliseconds kDefaultCoalesceWindow{2};
+        static constexpr size_t kMaxBatchBytes = 1 << 20; // A larger outbound batch is sent at once
+
+        explicit IpcManager(size_t workers = kDefaultWorkers, size_t queueCapacity = kDefaultQueueCapacity,
+                            std::chrono::milliseconds coalesceWindow = kDefaultCoalesceWindow);
         ~IpcManager();
 
-        void HandleWebMessage(const std::wstring &message);
-        void SetWebViewCallback(WebMessageCallback callback);
-        void RegisterHandler(const std::string &type, IpcHandlerCallback handler);
+        IpcManager(const IpcManager &) = delete;
+        IpcManager &operator=(const IpcManager &) = delete;
+
+        // Set once, after the handlers are registered; messages start arriving from it right away
+        void SetTransport(std::unique_ptr<IpcTransport> transport);
+        void HandleMessage(std::string_view message);
+        // Handlers are looked up from the workers without a lock: register them all before the first message
+        void RegisterHandler(const std::string &type, IpcHandlerCallback handler, Dispatch dispatch = Dispatch::Worker);
         void RegisterNavigationHandler();
         void ValidateAndProcessNavigation(const NavigationRequest &request);
 
     private:
-        WebMessageCallback webviewCallback_;
-        std::unordered_map<std::string, IpcHandlerCallback> handlers_;
+        friend class Responder;
+
+        struct Handler
+        {
+            IpcHandlerCallback callback;
+            Dispatch dispatch = Dispatch::Worker;
+        };
+
+        struct Job
+        {
+            const Handler *handler;
+            std::string id;
+            json payload;
+            bool batched = false;
+        };
+
+        std::unordered_map<std::string, Handler> handlers_;
+
+        size_t queueCapacity_;
+        std::mutex jobsMutex_;
+        std::condition_variable jobsReady_;
+        std::deque<Job> jobs_;
+        bool stopping_ = false;
+        std::vector<std::thread> workers_;
+
+        // Outbound batch: "{\"batch\":[" and the entries so far, sent by Flush
+        const std::chrono::milliseconds coalesceWindow_;
+        std::atomic<size_t> batchedInFlight_{0}; // Batched requests not yet run, plus batches being read
+        std::recursive_mutex flushMutex_;         // Keeps batches in order; a transport may deliver synchronously
+        std::mutex outboxMutex_;
+        std::condition_variable outboxReady_;
+        std::string outbox_;
+        std::string spareOutbox_; // The last batch sent, to reuse its capacity
+        size_t outboxEntries_ = 0;
+        std::chrono::steady_clock::time_point outboxDeadline_;
+        bool outboxStopping_ = false;
+        std::thread flusher_;
+
+        // Destroyed after the destructor body has joined the workers and the flusher, so the
+        // body stops it receiving first
+        std::unique_ptr<IpcTransport> transport_;
 
-        void SendResponse(const std::string &id, const json &response);
+        void Submit(const std::string &type, const std::string &id, json &&payload, bool batched);
+        void WorkerLoop();
+        void Run(const Handler &handler, const std::string &id, const json &payload, bool batched);
+        void Finished(bool batched);
+        // Answers a request that could not be dispatched, if it carries an id to answer
+        void Reject(const json &request, const std::string &error, bool batched);
+        void SendResponse(const std::string &id, const json &response, bool batched);
+        // Writes {"id":..., "payload":...} into a per-thread buffer and sends it, or adds it to the outbound batch
+        void SendEnvelope(const std::string &id, const std::function<void(utils::JsonWriter &)> &writePayload, bool batched);
+        void AddToBatch(std::string_view entry);
+        void Flush();
+        void FlushLoop();
     };
 
 } // namespace app::ipc
@@ -0,0 +1,75 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace app::ipc
+{
+    // Carries UTF-8 JSON messages between the IpcManager and its one peer: the web page in
+    // the app, a test driver or a load generator headless.
+    class IpcTransport
+    {
+    public:
+        // One complete message, called on the transport's receiving thread
+        using MessageHandler = std::function<void(std::string_view message)>;
+
+        virtual ~IpcTransport() = default;
+
+        // Set once, before messages are expected; nothing is received before it is set
+        virtual void SetMessageHandler(MessageHandler handler) = 0;
+        // Sends one message to the peer. Safe to call from any thread.
+        virtual void Send(std::string_view message) = 0;
+        // Returns once the message handler is not running and will not be called again;
+        // sending still works. Must not be called from the message handler.
+        virtual void StopReceiving() = 0;
+    };
+
+    // In-process transport: the peer is the code holding it. Messages go both ways on the
+    // calling thread, so it adds nothing but the IpcManager's own cost to a measurement.
+    class LoopbackTransport : public IpcTransport
+    {
+    public:
+        // Called with every message the host sends, on the sending thread; must be thread-safe
+        using PeerHandler = std::function<void(std::string_view message)>;
+
+        void SetMessageHandler(MessageHandler handler) override { handler_ = std::move(handler); }
+        void Send(std::string_view message) override
+        {
+            if (peer_)
+            {
+                peer_(message);
+            }
+        }
+
+        void StopReceiving() override
+        {
+            receiving_ = false;
+            for (int delivering; (delivering = delivering_.load()) != 0;)
+            {
+                delivering_.wait(delivering);
+            }
+        }
+
+        void SetPeerHandler(PeerHandler peer) { peer_ = std::move(peer); }
+        // Delivers a message from the peer, as if received, on the calling thread
+        void DeliverToHost(std::string_view message)
+        {
+            ++delivering_;
+            if (receiving_ && handler_)
+            {
+                handler_(message);
+            }
+            if (--delivering_ == 0)
+            {
+                delivering_.notify_all();
+            }
+        }
+
+    private:
+        MessageHandler handler_;
+        PeerHandler peer_;
+        std::atomic<bool> receiving_{true};
+        std::atomic<int> delivering_{0}; // DeliverToHost calls in progress, on any thread
+    };
+} // namespace app::ipc
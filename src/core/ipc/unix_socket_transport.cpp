@@ -0,0 +1,282 @@
+#include "unix_socket_transport.hpp"
+#include "utils/logger.hpp"
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace app::ipc
+{
+    namespace
+    {
+#ifdef MSG_NOSIGNAL
+        constexpr int kSendFlags = MSG_NOSIGNAL; // A closed peer is an error, not SIGPIPE
+#else
+        constexpr int kSendFlags = 0;
+#endif
+
+        using TransportResult = utils::Result<std::unique_ptr<UnixSocketTransport>>;
+
+        bool MakeAddress(const std::string &path, sockaddr_un &address)
+        {
+            std::memset(&address, 0, sizeof(address));
+            address.sun_family = AF_UNIX;
+            if (path.empty() || path.size() >= sizeof(address.sun_path))
+            {
+                return false;
+            }
+            std::memcpy(address.sun_path, path.data(), path.size());
+            return true;
+        }
+
+        std::string LastError(const char *what)
+        {
+            return std::string(what) + ": " + std::strerror(errno);
+        }
+
+        bool SendAll(int fd, const char *data, size_t size)
+        {
+            while (size > 0)
+            {
+                const ssize_t sent = ::send(fd, data, size, kSendFlags);
+                if (sent < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return false;
+                }
+                data += sent;
+                size -= static_cast<size_t>(sent);
+            }
+            return true;
+        }
+    }
+
+    TransportResult UnixSocketTransport::Listen(const std::string &path)
+    {
+        sockaddr_un address;
+        if (!MakeAddress(path, address))
+        {
+            return TransportResult::Error("Invalid socket path: " + path);
+        }
+
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+        {
+            return TransportResult::Error(LastError("socket"));
+        }
+
+        ::unlink(path.c_str()); // A socket left behind by an earlier run
+        if (::bind(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 || ::listen(fd, 1) != 0)
+        {
+            const auto error = LastError("bind");
+            ::close(fd);
+            return TransportResult::Error(error);
+        }
+        return std::unique_ptr<UnixSocketTransport>(new UnixSocketTransport(fd, -1, path));
+    }
+
+    TransportResult UnixSocketTransport::Connect(const std::string &path)
+    {
+        sockaddr_un address;
+        if (!MakeAddress(path, address))
+        {
+            return TransportResult::Error("Invalid socket path: " + path);
+        }
+
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+        {
+            return TransportResult::Error(LastError("socket"));
+        }
+        if (::connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0)
+        {
+            const auto error = LastError("connect");
+            ::close(fd);
+            return TransportResult::Error(error);
+        }
+        return std::unique_ptr<UnixSocketTransport>(new UnixSocketTransport(-1, fd, std::string()));
+    }
+
+    UnixSocketTransport::UnixSocketTransport(int listenFd, int connectionFd, std::string path)
+        : listenFd_(listenFd), path_(std::move(path)), connectionFd_(connectionFd)
+    {
+        if (::pipe(stopPipe_) != 0)
+        {
+            utils::Logger::Error(LastError("pipe"));
+        }
+    }
+
+    UnixSocketTransport::~UnixSocketTransport()
+    {
+        StopReceiving();
+        SetConnection(-1);
+        for (const int fd : {stopPipe_[0], stopPipe_[1], listenFd_})
+        {
+            if (fd >= 0)
+                ::close(fd);
+        }
+        if (listenFd_ >= 0)
+        {
+            ::unlink(path_.c_str());
+        }
+    }
+
+    void UnixSocketTransport::SetMessageHandler(MessageHandler handler)
+    {
+        handler_ = std::move(handler);
+        if (!reader_.joinable())
+        {
+            reader_ = std::thread([this]
+                                  { ReadLoop(); });
+        }
+    }
+
+    void UnixSocketTransport::StopReceiving()
+    {
+        if (reader_.joinable())
+        {
+            const char stop = 0;
+            [[maybe_unused]] const auto written = ::write(stopPipe_[1], &stop, 1);
+            reader_.join();
+        }
+    }
+
+    void UnixSocketTransport::Send(std::string_view message)
+    {
+        if (message.size() > kMaxMessageBytes)
+        {
+            utils::Logger::Error("IPC message too large to send: " + std::to_string(message.size()) + " bytes");
+            return;
+        }
+
+        const uint32_t size = static_cast<uint32_t>(message.size());
+        const char header[4] = {static_cast<char>(size), static_cast<char>(size >> 8),
+                                static_cast<char>(size >> 16), static_cast<char>(size >> 24)};
+
+        // One writer at a time, so frames from different threads never interleave
+        std::lock_guard<std::mutex> lock(sendMutex_);
+        if (connectionFd_ < 0)
+        {
+            return;
+        }
+        if (!SendAll(connectionFd_, header, sizeof(header)) || !SendAll(connectionFd_, message.data(), message.size()))
+        {
+            utils::Logger::Warning(LastError("IPC send failed"));
+        }
+    }
+
+    void UnixSocketTransport::SetConnection(int fd)
+    {
+        std::lock_guard<std::mutex> lock(sendMutex_);
+        if (connectionFd_ >= 0)
+        {
+            ::close(connectionFd_);
+        }
+        connectionFd_ = fd;
+    }
+
+    void UnixSocketTransport::ReadLoop()
+    {
+        if (listenFd_ < 0)
+        {
+            ReadMessages(connectionFd_); // Stays open for sending until destruction
+            return;
+        }
+
+        for (int fd; (fd = Accept()) >= 0;)
+        {
+            SetConnection(fd);
+            if (!ReadMessages(fd))
+            {
+                return; // Stopped; the connection stays open for sending until destruction
+            }
+            SetConnection(-1);
+        }
+    }
+
+    bool UnixSocketTransport::WaitReadable(int fd)
+    {
+        pollfd fds[2] = {{fd, POLLIN, 0}, {stopPipe_[0], POLLIN, 0}};
+        for (;;)
+        {
+            if (::poll(fds, 2, -1) < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+            return fds[1].revents == 0;
+        }
+    }
+
+    int UnixSocketTransport::Accept()
+    {
+        while (WaitReadable(listenFd_))
+        {
+            const int fd = ::accept(listenFd_, nullptr, nullptr);
+            if (fd >= 0)
+            {
+                return fd;
+            }
+            if (errno != EINTR && errno != ECONNABORTED)
+            {
+                utils::Logger::Error(LastError("accept"));
+                return -1;
+            }
+        }
+        return -1;
+    }
+
+    // Reads frames until the peer closes (true) or the transport is stopped (false)
+    bool UnixSocketTransport::ReadMessages(int fd)
+    {
+        constexpr size_t kReadChunk = 64 * 1024;
+        std::string buffer;
+        for (;;)
+        {
+            // Every complete frame received so far, then whatever is left is kept for the next read
+            size_t start = 0;
+            while (buffer.size() - start >= 4)
+            {
+                const auto *header = reinterpret_cast<const uint8_t *>(buffer.data() + start);
+                const uint32_t size = uint32_t{header[0]} | uint32_t{header[1]} << 8 | uint32_t{header[2]} << 16 | uint32_t{header[3]} << 24;
+                if (size > kMaxMessageBytes)
+                {
+                    utils::Logger::Error("IPC frame of " + std::to_string(size) + " bytes, closing the connection");
+                    return true;
+                }
+                if (buffer.size() - start - 4 < size)
+                {
+                    break;
+                }
+                if (handler_)
+                {
+                    handler_(std::string_view(buffer.data() + start + 4, size));
+                }
+                start += 4 + size;
+            }
+            buffer.erase(0, start);
+
+            if (!WaitReadable(fd))
+            {
+                return false;
+            }
+            const size_t filled = buffer.size();
+            buffer.resize(filled + kReadChunk);
+            const ssize_t received = ::recv(fd, buffer.data() + filled, kReadChunk, 0);
+            if (received < 0 && errno == EINTR)
+            {
+                buffer.resize(filled);
+                continue;
+            }
+            if (received <= 0)
+            {
+                return true;
+            }
+            buffer.resize(filled + static_cast<size_t>(received));
+        }
+    }
+} // namespace app::ipc
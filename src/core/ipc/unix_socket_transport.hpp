@@ -0,0 +1,57 @@
+#pragma once
+#include "ipc_transport.hpp"
+#include "utils/result.hpp"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace app::ipc
+{
+    // IPC over a Unix domain stream socket, so the IPC and service stack can be driven
+    // without a browser window. Each message is framed as a u32 little-endian byte count
+    // followed by that many bytes of UTF-8.
+    //
+    // Both ends are a UnixSocketTransport: Listen for the host side, which serves one
+    // connection at a time (a new one is accepted once the last has closed), and Connect
+    // for a driver. Received messages are handed over on a reader thread of the transport.
+    class UnixSocketTransport : public IpcTransport
+    {
+    public:
+        static constexpr uint32_t kMaxMessageBytes = 64u << 20; // Larger frames close the connection
+
+        static utils::Result<std::unique_ptr<UnixSocketTransport>> Listen(const std::string &path);
+        static utils::Result<std::unique_ptr<UnixSocketTransport>> Connect(const std::string &path);
+
+        ~UnixSocketTransport() override;
+
+        UnixSocketTransport(const UnixSocketTransport &) = delete;
+        UnixSocketTransport &operator=(const UnixSocketTransport &) = delete;
+
+        void SetMessageHandler(MessageHandler handler) override;
+        // Dropped if no peer is connected
+        void Send(std::string_view message) override;
+        // The connection stays open for sending until destruction
+        void StopReceiving() override;
+
+    private:
+        UnixSocketTransport(int listenFd, int connectionFd, std::string path);
+
+        void ReadLoop();
+        bool ReadMessages(int fd);
+        bool WaitReadable(int fd);
+        int Accept();
+        void SetConnection(int fd);
+
+        const int listenFd_; // -1 for a client
+        const std::string path_;
+        int stopPipe_[2] = {-1, -1}; // Written on destruction to wake the reader
+
+        std::mutex sendMutex_;
+        int connectionFd_;
+
+        MessageHandler handler_;
+        std::thread reader_;
+    };
+} // namespace app::ipc
@@ -1,4 +1,6 @@
 #pragma once
+#include <algorithm>
+#include <chrono>
 #include <string>
 #include <curl/curl.h>
 #include <stdexcept>
@@ -9,7 +11,10 @@ namespace app::utils
     class HttpClient
     {
     public:
-        static std::string Get(const std::string &url)
+        // The timeout bounds how long an abandoned request (one whose caller already gave up
+        // on it) keeps a thread and a connection alive.
+        static std::string Get(const std::string &url,
+                               std::chrono::milliseconds timeout = std::chrono::seconds(15))
         {
             CURL *curl = curl_easy_init();
             std::string response;
@@ -17,6 +22,9 @@ namespace app::utils
             curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
             curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
             curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+            curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L); // Required for timeouts off the main thread
+            curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, static_cast<long>(std::min(timeout, std::chrono::milliseconds(5000)).count()));
+            curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, static_cast<long>(timeout.count()));
 
             CURLcode res = curl_easy_perform(curl);
             curl_easy_cleanup(curl);
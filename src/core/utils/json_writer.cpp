@@ -0,0 +1,252 @@
+#include "json_writer.hpp"
+#include <array>
+#include <charconv>
+#include <cmath>
+
+namespace app::utils
+{
+    namespace
+    {
+        // 0: copied as is, 1: escaped, 2: first byte of a multi-byte UTF-8 sequence, 3: invalid
+        constexpr std::array<uint8_t, 256> MakeByteClasses()
+        {
+            std::array<uint8_t, 256> classes{};
+            for (int c = 0; c < 0x20; ++c)
+                classes[c] = 1;
+            classes['"'] = 1;
+            classes['\\'] = 1;
+            for (int c = 0x80; c < 0x100; ++c)
+                classes[c] = c >= 0xC2 && c <= 0xF4 ? 2 : 3;
+            return classes;
+        }
+        constexpr auto kByteClasses = MakeByteClasses();
+
+        constexpr std::string_view kReplacement = "\xEF\xBF\xBD";
+
+        // Length of the well-formed UTF-8 sequence at text[i], or 0 if there is none
+        size_t SequenceLength(std::string_view text, size_t i)
+        {
+            const auto byte = [&](size_t k)
+            { return static_cast<uint8_t>(text[k]); };
+            const uint8_t lead = byte(i);
+            size_t length = lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+            uint8_t low = 0x80, high = 0xBF;
+            if (lead == 0xE0)
+                low = 0xA0; // Overlong
+            else if (lead == 0xED)
+                high = 0x9F; // Surrogates
+            else if (lead == 0xF0)
+                low = 0x90; // Overlong
+            else if (lead == 0xF4)
+                high = 0x8F; // Past U+10FFFF
+
+            if (i + length > text.size() || byte(i + 1) < low || byte(i + 1) > high)
+                return 0;
+            for (size_t k = 2; k < length; ++k)
+            {
+                if ((byte(i + k) & 0xC0) != 0x80)
+                    return 0;
+            }
+            return length;
+        }
+    }
+
+    JsonWriter &JsonWriter::BeginObject()
+    {
+        Separate();
+        out_ += '{';
+        needComma_ = false;
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::EndObject()
+    {
+        out_ += '}';
+        needComma_ = true;
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::BeginArray()
+    {
+        Separate();
+        out_ += '[';
+        needComma_ = false;
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::EndArray()
+    {
+        out_ += ']';
+        needComma_ = true;
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::Key(std::string_view key)
+    {
+        Separate();
+        out_ += '"';
+        AppendEscaped(key);
+        out_ += "\":";
+        needComma_ = false;
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::String(std::string_view value)
+    {
+        Separate();
+        out_ += '"';
+        AppendEscaped(value);
+        out_ += '"';
+        needComma_ = true;
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::String(std::initializer_list<std::string_view> parts)
+    {
+        Separate();
+        out_ += '"';
+        for (const auto part : parts)
+        {
+            AppendEscaped(part);
+        }
+        out_ += '"';
+        needComma_ = true;
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::Int(int64_t value)
+    {
+        Separate();
+        char buffer[24];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out_.append(buffer, result.ptr);
+        needComma_ = true;
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::UInt(uint64_t value)
+    {
+        Separate();
+        char buffer[24];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out_.append(buffer, result.ptr);
+        needComma_ = true;
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::Double(double value)
+    {
+        if (!std::isfinite(value))
+        {
+            return Null();
+        }
+        Separate();
+        char buffer[32];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out_.append(buffer, result.ptr);
+        needComma_ = true;
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::Float(float value)
+    {
+        if (!std::isfinite(value))
+        {
+            return Null();
+        }
+        Separate();
+        char buffer[32];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out_.append(buffer, result.ptr);
+        needComma_ = true;
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::Bool(bool value)
+    {
+        Separate();
+        out_ += value ? "true" : "false";
+        needComma_ = true;
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::Null()
+    {
+        Separate();
+        out_ += "null";
+        needComma_ = true;
+        return *this;
+    }
+
+    JsonWriter &JsonWriter::Raw(std::string_view json)
+    {
+        Separate();
+        out_ += json;
+        needComma_ = true;
+        return *this;
+    }
+
+    void JsonWriter::AppendEscaped(std::string_view text)
+    {
+        static constexpr char kHex[] = "0123456789abcdef";
+        size_t run = 0; // Start of the bytes that are copied unchanged
+        for (size_t i = 0; i < text.size();)
+        {
+            const uint8_t c = static_cast<uint8_t>(text[i]);
+            const uint8_t kind = kByteClasses[c];
+            if (kind == 0)
+            {
+                ++i;
+                continue;
+            }
+            if (kind == 2)
+            {
+                if (const size_t length = SequenceLength(text, i))
+                {
+                    i += length;
+                    continue;
+                }
+            }
+
+            out_.append(text.data() + run, i - run);
+            if (kind == 1)
+            {
+                switch (c)
+                {
+                case '"':
+                    out_ += "\\\"";
+                    break;
+                case '\\':
+                    out_ += "\\\\";
+                    break;
+                case '\n':
+                    out_ += "\\n";
+                    break;
+                case '\r':
+                    out_ += "\\r";
+                    break;
+                case '\t':
+                    out_ += "\\t";
+                    break;
+                case '\b':
+                    out_ += "\\b";
+                    break;
+                case '\f':
+                    out_ += "\\f";
+                    break;
+                default:
+                    out_ += "\\u00";
+                    out_ += kHex[c >> 4];
+                    out_ += kHex[c & 0xF];
+                    break;
+                }
+            }
+            else
+            {
+                out_ += kReplacement;
+            }
+            run = ++i;
+        }
+        out_.append(text.data() + run, text.size() - run);
+    }
+} // namespace app::utils
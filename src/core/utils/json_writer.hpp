@@ -0,0 +1,83 @@
+#pragma once
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace app::utils
+{
+    // Writes JSON text straight into a string, for responses too hot to build as a
+    // nlohmann::json tree first. Commas are placed automatically; the caller is trusted to
+    // nest Begin/End and Key/value correctly.
+    //
+    // Strings are escaped as RFC 8259 requires and must be UTF-8: each byte of an invalid
+    // sequence is written as U+FFFD rather than failing the whole response. Floating point
+    // values are written in their shortest round-trip form, NaN and infinities as null.
+    class JsonWriter
+    {
+    public:
+        // Appends to out, which is not cleared; reserve it to write without reallocating
+        explicit JsonWriter(std::string &out) : out_(out) {}
+
+        JsonWriter &BeginObject();
+        JsonWriter &EndObject();
+        JsonWriter &BeginArray();
+        JsonWriter &EndArray();
+        JsonWriter &Key(std::string_view key);
+
+        JsonWriter &String(std::string_view value);
+        // One string value made of several pieces, e.g. a URL from its base and file
+        JsonWriter &String(std::initializer_list<std::string_view> parts);
+        JsonWriter &Int(int64_t value);
+        JsonWriter &UInt(uint64_t value);
+        JsonWriter &Double(double value);
+        JsonWriter &Float(float value); // Shortest form for a float, so 7.3f is 7.3 and not 7.300000190734863
+        JsonWriter &Bool(bool value);
+        JsonWriter &Null();
+        // An already serialized JSON value, written as is
+        JsonWriter &Raw(std::string_view json);
+
+        template <typename Range>
+        JsonWriter &StringArray(const Range &values)
+        {
+            BeginArray();
+            for (const auto &value : values)
+            {
+                String(value);
+            }
+            return EndArray();
+        }
+
+        template <typename T>
+        JsonWriter &Field(std::string_view key, const T &value)
+        {
+            Key(key);
+            if constexpr (std::is_same_v<T, bool>)
+                return Bool(value);
+            else if constexpr (std::is_same_v<T, float>)
+                return Float(value);
+            else if constexpr (std::is_floating_point_v<T>)
+                return Double(value);
+            else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+                return Int(value);
+            else if constexpr (std::is_integral_v<T>)
+                return UInt(value);
+            else
+                return String(value);
+        }
+
+        std::string &Output() { return out_; }
+
+    private:
+        void Separate()
+        {
+            if (needComma_)
+                out_ += ',';
+        }
+        void AppendEscaped(std::string_view text);
+
+        std::string &out_;
+        bool needComma_ = false; // A value was just completed at the current level
+    };
+} // namespace app::utils
@@ -1,30 +1,245 @@
 #include "rating_normalizer.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <mutex>
 
 namespace app::services
 {
+    void RatingNormalizer::ProviderRatingMetrics::Add(float rating)
+    {
+        minRating = sampleSize ? std::min(minRating, rating) : rating;
+        maxRating = sampleSize ? std::max(maxRating, rating) : rating;
+        ++sampleSize;
+        const double delta = rating - mean;
+        mean += delta / static_cast<double>(sampleSize);
+        m2 += delta * (rating - mean);
+    }
+
+    void RatingNormalizer::ProviderRatingMetrics::Merge(const ProviderRatingMetrics &other)
+    {
+        if (!other.sampleSize)
+        {
+            return;
+        }
+        if (!sampleSize)
+        {
+            *this = other;
+            return;
+        }
+        const double total = static_cast<double>(sampleSize + other.sampleSize);
+        const double delta = other.mean - mean;
+        mean += delta * static_cast<double>(other.sampleSize) / total;
+        m2 += other.m2 + delta * delta * static_cast<double>(sampleSize) * static_cast<double>(other.sampleSize) / total;
+        minRating = std::min(minRating, other.minRating);
+        maxRating = std::max(maxRating, other.maxRating);
+        sampleSize += other.sampleSize;
+    }
+
     RatingNormalizer &RatingNormalizer::Instance()
     {
         static RatingNormalizer instance; // Singleton instance
         return instance;
     }
 
-    float RatingNormalizer::NormalizeRating(const std::string &source, float rating)
+    void RatingNormalizer::SetMethod(Method method, float priorVotes)
+    {
+        std::unique_lock lock(mutex_);
+        method_ = method;
+        priorVotes_ = std::max(priorVotes, 0.0f);
+    }
+
+    void RatingNormalizer::SetScale(const std::string &providerId, float maxRating)
+    {
+        if (maxRating <= 0.0f)
+        {
+            return;
+        }
+        std::unique_lock lock(mutex_);
+        auto &provider = providers_[providerId];
+        const float toCommon = kMaxRating / maxRating;
+        if (provider.toCommon != toCommon)
+        {
+            provider.toCommon = toCommon;
+            provider.metrics = {}; // Gathered at the old scale
+        }
+    }
+
+    float RatingNormalizer::DefaultScale(std::string_view providerId)
+    {
+        // Only consulted the first time a provider without a declared scale shows up
+        if (providerId == "tmdb" || providerId == "omdb")
+        {
+            return 10.0f;
+        }
+        return kMaxRating;
+    }
+
+    RatingNormalizer::Params RatingNormalizer::ParamsLocked(const Provider *provider, std::string_view providerId) const
+    {
+        Params params{};
+        params.method = method_;
+        params.priorVotes = priorVotes_;
+        params.toCommon = provider ? provider->toCommon : kMaxRating / DefaultScale(providerId);
+        params.targetMean = static_cast<float>(pooled_.mean);
+        params.targetStddev = static_cast<float>(std::sqrt(pooled_.Variance()));
+        if (provider)
+        {
+            const auto &metrics = provider->metrics;
+            params.mean = static_cast<float>(metrics.mean);
+            params.stddev = static_cast<float>(std::sqrt(metrics.Variance()));
+            params.hasMean = metrics.sampleSize > 0;
+            params.zScoreReady = metrics.sampleSize >= kMinZScoreSamples && params.stddev > 0.0f && params.targetStddev > 0.0f;
+        }
+        return params;
+    }
+
+    float RatingNormalizer::Unshrunk(const Params &params, float scaled)
+    {
+        if (params.method == Method::ZScore && params.zScoreReady)
+        {
+            const float z = (scaled - params.mean) / params.stddev;
+            return std::clamp(params.targetMean + z * params.targetStddev, 0.0f, kMaxRating);
+        }
+        return scaled;
+    }
+
+    float RatingNormalizer::Normalize(const Params &params, float scaled, float votes)
     {
-        // Example normalization logic
-        if (source == "tmdb")
+        if (params.method == Method::Bayesian && params.hasMean)
         {
-            // TMDB ratings are on a scale of 0-10, normalize to 0-5
-            return rating / 2.0f;
+            return (votes * scaled + params.priorVotes * params.mean) / (votes + params.priorVotes);
         }
-        else if (source == "omdb")
+        return Unshrunk(params, scaled);
+    }
+
+    float RatingNormalizer::NormalizeRating(const std::string &providerId, float rawRating, int votes) const
+    {
+        if (rawRating <= 0.0f)
         {
-            // OMDb ratings are on a scale of 0-10, normalize to 0-5
-            return rating / 2.0f;
+            return 0.0f;
         }
-        else
+        std::shared_lock lock(mutex_);
+        const auto it = providers_.find(providerId);
+        const auto params = ParamsLocked(it == providers_.end() ? nullptr : &it->second, providerId);
+        lock.unlock();
+        return Normalize(params, rawRating * params.toCommon, static_cast<float>(std::max(votes, 0)));
+    }
+
+    void RatingNormalizer::NormalizePage(std::vector<domain::MediaMetadata> &items)
+    {
+        for (size_t begin = 0; begin < items.size();)
+        {
+            // A provider page comes from one source and fits one block, so this is normally
+            // a single pass and a single lock
+            const auto &source = items[begin].id.source;
+            size_t end = begin + 1;
+            while (end < items.size() && end - begin < kPageBlock && items[end].id.source == source)
+            {
+                ++end;
+            }
+            const size_t count = end - begin;
+
+            // Gathered into columns, so the loops below are plain loops over floats
+            std::array<float, kPageBlock> scaled, votes, rated;
+            for (size_t i = 0; i < count; ++i)
+            {
+                const auto &item = items[begin + i];
+                scaled[i] = item.rating;
+                votes[i] = static_cast<float>(std::max(item.voteCount, 0));
+                rated[i] = item.rating > 0.0f ? 1.0f : 0.0f;
+            }
+
+            Params params;
+            {
+                std::unique_lock lock(mutex_);
+                auto [it, inserted] = providers_.try_emplace(source.Get());
+                if (inserted)
+                {
+                    it->second.toCommon = kMaxRating / DefaultScale(source.Get());
+                }
+
+                const float toCommon = it->second.toCommon;
+                float sum = 0.0f, ratedCount = 0.0f;
+                float low = std::numeric_limits<float>::max(), high = std::numeric_limits<float>::lowest();
+                for (size_t i = 0; i < count; ++i)
+                {
+                    scaled[i] *= toCommon;
+                    sum += scaled[i] * rated[i];
+                    ratedCount += rated[i];
+                    low = std::min(low, rated[i] ? scaled[i] : low);
+                    high = std::max(high, rated[i] ? scaled[i] : high);
+                }
+
+                // The block's own statistics, two-pass, then combined with what came before
+                ProviderRatingMetrics block;
+                if (ratedCount > 0.0f)
+                {
+                    const float mean = sum / ratedCount;
+                    float m2 = 0.0f;
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        m2 += (scaled[i] - mean) * (scaled[i] - mean) * rated[i];
+                    }
+                    block = {low, high, mean, m2, static_cast<uint64_t>(ratedCount)};
+                }
+                it->second.metrics.Merge(block);
+                pooled_.Merge(block);
+                params = ParamsLocked(&it->second, source.Get());
+            }
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                items[begin + i].normalizedRating = rated[i] ? Normalize(params, scaled[i], votes[i]) : 0.0f;
+            }
+            begin = end;
+        }
+    }
+
+    float RatingNormalizer::GetAggregateRating(const std::vector<domain::RatingSource> &ratings) const
+    {
+        std::shared_lock lock(mutex_);
+        double weighted = 0.0, totalVotes = 0.0, meanSum = 0.0;
+        size_t means = 0;
+        for (const auto &rating : ratings)
+        {
+            if (rating.value <= 0.0f)
+            {
+                continue;
+            }
+            const auto it = providers_.find(rating.source.Get());
+            const auto params = ParamsLocked(it == providers_.end() ? nullptr : &it->second, rating.source.Get());
+
+            const double votes = std::max(rating.votes, 1);
+            weighted += votes * Unshrunk(params, rating.value * params.toCommon);
+            totalVotes += votes;
+            if (params.hasMean)
+            {
+                meanSum += params.mean;
+                ++means;
+            }
+        }
+
+        if (totalVotes == 0.0)
+        {
+            return 0.0f;
+        }
+        if (method_ == Method::Bayesian && means)
+        {
+            const double prior = priorVotes_;
+            return static_cast<float>((weighted + prior * meanSum / static_cast<double>(means)) / (totalVotes + prior));
+        }
+        return static_cast<float>(weighted / totalVotes);
+    }
+
+    std::optional<RatingNormalizer::ProviderRatingMetrics> RatingNormalizer::GetMetrics(const std::string &providerId) const
+    {
+        std::shared_lock lock(mutex_);
+        if (const auto it = providers_.find(providerId); it != providers_.end())
         {
-            // Default normalization (no change)
-            return rating;
+            return it->second.metrics;
         }
+        return std::nullopt;
     }
-}
\ No newline at end of file
+}
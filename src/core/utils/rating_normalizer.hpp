@@ -1,25 +1,100 @@
+#pragma once
+#include "domain/models/media_types.hpp"
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 
 namespace app::services
 {
+    // Maps provider ratings onto one 0-5 scale so they can be compared and merged. Keeps
+    // running statistics of every provider's ratings, fed a page at a time.
     class RatingNormalizer
     {
     public:
+        enum class Method
+        {
+            Scale,   // Linear rescale of the provider's native scale
+            ZScore,  // The provider's distribution mapped onto that of all providers together
+            Bayesian // Rescaled, then pulled towards the provider's mean the fewer votes there are
+        };
+
+        // Running statistics of one provider's ratings, on the common scale. Welford's
+        // update for single ratings, Chan's combination to fold in a whole page at once.
+        struct ProviderRatingMetrics
+        {
+            float minRating = 0.0f;
+            float maxRating = 0.0f;
+            double mean = 0.0;
+            double m2 = 0.0; // Sum of squared deviations from the mean
+            uint64_t sampleSize = 0;
+
+            void Add(float rating);
+            void Merge(const ProviderRatingMetrics &other);
+            double Variance() const { return sampleSize > 1 ? m2 / static_cast<double>(sampleSize - 1) : 0.0; }
+        };
+
+        static constexpr float kMaxRating = 5.0f;
+        static constexpr float kDefaultPriorVotes = 100.0f;
+        static constexpr uint64_t kMinZScoreSamples = 30; // Below this, z-scores fall back to Scale
+        static constexpr size_t kPageBlock = 64;          // Items normalized per lock by NormalizePage
+
         static RatingNormalizer &Instance();
 
-        float NormalizeRating(const std::string &providerId, float rawRating);
-        float GetAggregateRating(const std::vector<std::pair<std::string, float>> &ratings);
+        // priorVotes is how many votes the provider mean counts for with Method::Bayesian
+        void SetMethod(Method method, float priorVotes = kDefaultPriorVotes);
+        // A provider's native maximum, e.g. 10 for TMDB; providers not set use 5, or 10 for tmdb and omdb
+        void SetScale(const std::string &providerId, float maxRating);
+
+        float NormalizeRating(const std::string &providerId, float rawRating, int votes = 0) const;
+
+        // Sets normalizedRating for a provider page and folds its ratings into the provider's
+        // statistics, looking the provider up once per run of items from the same source.
+        // Unrated items (rating 0) get 0 and are left out of the statistics.
+        void NormalizePage(std::vector<domain::MediaMetadata> &items);
+
+        // The normalized rating of a title merged from several providers: each provider's
+        // rating weighted by its votes, plus, for Method::Bayesian, the providers' mean
+        // rating weighted as priorVotes votes
+        float GetAggregateRating(const std::vector<domain::RatingSource> &ratings) const;
+
+        std::optional<ProviderRatingMetrics> GetMetrics(const std::string &providerId) const;
 
     private:
-        struct ProviderRatingMetrics
+        RatingNormalizer() = default;
+
+        struct Provider
         {
-            float minRating;
-            float maxRating;
-            float avgRating;
-            int sampleSize;
+            float toCommon = 1.0f; // kMaxRating / native maximum
+            ProviderRatingMetrics metrics;
         };
-        std::unordered_map<std::string, ProviderRatingMetrics> metrics_;
+
+        // What normalizing one provider's ratings needs, copied out under the lock
+        struct Params
+        {
+            Method method;
+            float toCommon;
+            float mean;
+            float stddev;
+            float targetMean;
+            float targetStddev;
+            float priorVotes;
+            bool hasMean;
+            bool zScoreReady;
+        };
+
+        Params ParamsLocked(const Provider *provider, std::string_view providerId) const;
+        static float DefaultScale(std::string_view providerId);
+        static float Normalize(const Params &params, float scaled, float votes);
+        static float Unshrunk(const Params &params, float scaled); // Normalize without the Bayesian prior
+
+        mutable std::shared_mutex mutex_;
+        Method method_ = Method::Bayesian;
+        float priorVotes_ = kDefaultPriorVotes;
+        std::unordered_map<std::string, Provider> providers_;
+        ProviderRatingMetrics pooled_; // All providers, the target of z-scores
     };
-}
\ No newline at end of file
+}
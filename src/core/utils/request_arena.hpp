@@ -0,0 +1,120 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+
+namespace app::utils
+{
+    // Forwards to another resource and counts what goes through, to see what an arena saves
+    class CountingResource : public std::pmr::memory_resource
+    {
+    public:
+        explicit CountingResource(std::pmr::memory_resource *upstream = std::pmr::new_delete_resource())
+            : upstream_(upstream) {}
+
+        size_t Allocations() const { return allocations_.load(std::memory_order_relaxed); }
+        size_t Bytes() const { return bytes_.load(std::memory_order_relaxed); }
+
+    private:
+        void *do_allocate(size_t bytes, size_t alignment) override
+        {
+            allocations_.fetch_add(1, std::memory_order_relaxed);
+            bytes_.fetch_add(bytes, std::memory_order_relaxed);
+            return upstream_->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void *p, size_t bytes, size_t alignment) override
+        {
+            upstream_->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+        {
+            return this == &other;
+        }
+
+        std::pmr::memory_resource *upstream_;
+        std::atomic<size_t> allocations_{0};
+        std::atomic<size_t> bytes_{0};
+    };
+
+    // Monotonic arena for the temporaries of one request: parsed JSON, lookup tables, sort
+    // scratch. Allocation is a pointer bump, deallocation a no-op, and the whole arena is
+    // released in a few frees when it goes out of scope. Nothing allocated from it may
+    // outlive it, so results that are kept are built in ordinary containers.
+    // Not thread-safe: one arena per thread of work.
+    class RequestArena
+    {
+    public:
+        static constexpr size_t kDefaultInitialBytes = 64 * 1024;
+
+        explicit RequestArena(size_t initialBytes = kDefaultInitialBytes)
+            : arena_(initialBytes, &upstream_) {}
+
+        RequestArena(const RequestArena &) = delete;
+        RequestArena &operator=(const RequestArena &) = delete;
+
+        std::pmr::memory_resource *Resource() { return &arena_; }
+
+        // Blocks taken from the heap so far, and their total size
+        size_t Blocks() const { return upstream_.Allocations(); }
+        size_t BlockBytes() const { return upstream_.Bytes(); }
+
+    private:
+        CountingResource upstream_;
+        std::pmr::monotonic_buffer_resource arena_;
+    };
+
+    // Points ArenaAllocator at an arena for the current thread while in scope. Scopes nest.
+    class ArenaScope
+    {
+    public:
+        explicit ArenaScope(RequestArena &arena) : previous_(Current()) { Current() = arena.Resource(); }
+        ~ArenaScope() { Current() = previous_; }
+
+        ArenaScope(const ArenaScope &) = delete;
+        ArenaScope &operator=(const ArenaScope &) = delete;
+
+        static std::pmr::memory_resource *&Current()
+        {
+            thread_local std::pmr::memory_resource *current = nullptr;
+            return current;
+        }
+
+    private:
+        std::pmr::memory_resource *previous_;
+    };
+
+    // For libraries that default-construct their allocators, nlohmann::basic_json among them,
+    // so a std::pmr::polymorphic_allocator cannot be handed in. Allocates from the current
+    // ArenaScope's arena, or the heap outside of any scope.
+    //
+    // The library also default-constructs an allocator to free, so values allocated inside a
+    // scope must be destroyed inside it: declare the scope before them.
+    template <typename T>
+    class ArenaAllocator
+    {
+    public:
+        using value_type = T;
+
+        ArenaAllocator() noexcept
+            : resource_(ArenaScope::Current() ? ArenaScope::Current() : std::pmr::new_delete_resource()) {}
+
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U> &other) noexcept : resource_(other.Resource()) {}
+
+        T *allocate(size_t n) { return static_cast<T *>(resource_->allocate(n * sizeof(T), alignof(T))); }
+        void deallocate(T *p, size_t n) { resource_->deallocate(p, n * sizeof(T), alignof(T)); }
+
+        std::pmr::memory_resource *Resource() const { return resource_; }
+
+        template <typename U>
+        bool operator==(const ArenaAllocator<U> &other) const { return resource_ == other.Resource(); }
+
+    private:
+        std::pmr::memory_resource *resource_;
+    };
+
+    using ArenaString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+} // namespace app::utils
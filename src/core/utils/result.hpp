@@ -1,4 +1,6 @@
 #pragma once
+#include <optional>
+#include <stdexcept>
 #include <variant>
 #include <string>
 #include <type_traits>
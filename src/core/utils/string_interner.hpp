@@ -0,0 +1,96 @@
+#pragma once
+#include <fmt/format.h>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+namespace app::utils
+{
+    // Process-wide table of strings that repeat across many items (provider ids, genre
+    // names, image URL bases). Each distinct string is stored once and never freed.
+    class StringInterner
+    {
+    public:
+        static StringInterner &Instance()
+        {
+            static StringInterner instance;
+            return instance;
+        }
+
+        // The returned pointer stays valid for the life of the process
+        const std::string *Intern(std::string_view text)
+        {
+            {
+                std::shared_lock lock(mutex_);
+                if (auto it = strings_.find(text); it != strings_.end())
+                {
+                    return &*it;
+                }
+            }
+            std::unique_lock lock(mutex_);
+            return &*strings_.emplace(text).first;
+        }
+
+        size_t Size() const
+        {
+            std::shared_lock lock(mutex_);
+            return strings_.size();
+        }
+
+    private:
+        StringInterner() = default;
+
+        struct Hash
+        {
+            using is_transparent = void;
+            size_t operator()(std::string_view text) const { return std::hash<std::string_view>{}(text); }
+        };
+
+        mutable std::shared_mutex mutex_;
+        std::unordered_set<std::string, Hash, std::equal_to<>> strings_; // Nodes never move
+    };
+
+    // A pointer-sized handle to an interned string. Copies are a pointer copy and equal
+    // strings compare by address.
+    class InternedString
+    {
+    public:
+        InternedString() : value_(Empty()) {}
+        InternedString(std::string_view text) : value_(Intern(text)) {}
+        InternedString(const std::string &text) : value_(Intern(text)) {}
+        InternedString(const char *text) : value_(Intern(text)) {}
+
+        const std::string &Get() const { return *value_; }
+        operator const std::string &() const { return *value_; }
+        bool empty() const { return value_->empty(); }
+
+        friend bool operator==(const InternedString &a, const InternedString &b) { return a.value_ == b.value_; }
+        friend bool operator==(const InternedString &a, std::string_view b) { return *a.value_ == b; }
+        friend bool operator==(const InternedString &a, const std::string &b) { return *a.value_ == b; }
+        friend bool operator==(const InternedString &a, const char *b) { return *a.value_ == b; }
+        friend std::string operator+(const InternedString &a, std::string_view b) { return *a.value_ + std::string(b); }
+        friend std::string operator+(std::string_view a, const InternedString &b) { return std::string(a) + *b.value_; }
+
+    private:
+        static const std::string *Intern(std::string_view text) { return StringInterner::Instance().Intern(text); }
+        static const std::string *Empty()
+        {
+            static const std::string *const empty = Intern({});
+            return empty;
+        }
+
+        const std::string *value_;
+    };
+} // namespace app::utils
+
+template <>
+struct fmt::formatter<app::utils::InternedString> : fmt::formatter<std::string_view>
+{
+    template <typename FormatContext>
+    auto format(const app::utils::InternedString &text, FormatContext &ctx) const
+    {
+        return fmt::formatter<std::string_view>::format(text.Get(), ctx);
+    }
+};
@@ -0,0 +1,322 @@
+#include "utf_transcoder.hpp"
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define APP_UTF_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define APP_TARGET_AVX2
+#else
+#define APP_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace app::utils
+{
+    namespace
+    {
+        constexpr char16_t kReplacement = 0xFFFD;
+
+        // One code point from UTF-16 at in[i], written to out; returns the new position
+        inline size_t EncodeOne(const char16_t *in, size_t i, size_t size, char *&out)
+        {
+            uint32_t c = in[i++];
+            if (c < 0x80)
+            {
+                *out++ = static_cast<char>(c);
+                return i;
+            }
+            if (c < 0x800)
+            {
+                *out++ = static_cast<char>(0xC0 | c >> 6);
+                *out++ = static_cast<char>(0x80 | (c & 0x3F));
+                return i;
+            }
+            if (c >= 0xD800 && c <= 0xDFFF)
+            {
+                if (c <= 0xDBFF && i < size && in[i] >= 0xDC00 && in[i] <= 0xDFFF)
+                {
+                    c = 0x10000 + ((c - 0xD800) << 10) + (in[i++] - 0xDC00);
+                    *out++ = static_cast<char>(0xF0 | c >> 18);
+                    *out++ = static_cast<char>(0x80 | (c >> 12 & 0x3F));
+                    *out++ = static_cast<char>(0x80 | (c >> 6 & 0x3F));
+                    *out++ = static_cast<char>(0x80 | (c & 0x3F));
+                    return i;
+                }
+                c = kReplacement; // Unpaired
+            }
+            *out++ = static_cast<char>(0xE0 | c >> 12);
+            *out++ = static_cast<char>(0x80 | (c >> 6 & 0x3F));
+            *out++ = static_cast<char>(0x80 | (c & 0x3F));
+            return i;
+        }
+
+        // One code point from UTF-8 at in[i], written to out; returns the new position. An
+        // invalid sequence yields one U+FFFD for the longest prefix that could have been valid.
+        inline size_t DecodeOne(const uint8_t *in, size_t i, size_t size, char16_t *&out)
+        {
+            const uint8_t lead = in[i++];
+            if (lead < 0x80)
+            {
+                *out++ = lead;
+                return i;
+            }
+
+            size_t length;
+            uint8_t low = 0x80, high = 0xBF; // Allowed range of the second byte
+            uint32_t c;
+            if (lead >= 0xC2 && lead <= 0xDF)
+            {
+                length = 2;
+                c = lead & 0x1F;
+            }
+            else if (lead >= 0xE0 && lead <= 0xEF)
+            {
+                length = 3;
+                c = lead & 0x0F;
+                low = lead == 0xE0 ? 0xA0 : 0x80;  // Overlong
+                high = lead == 0xED ? 0x9F : 0xBF; // Surrogates
+            }
+            else if (lead >= 0xF0 && lead <= 0xF4)
+            {
+                length = 4;
+                c = lead & 0x07;
+                low = lead == 0xF0 ? 0x90 : 0x80;  // Overlong
+                high = lead == 0xF4 ? 0x8F : 0xBF; // Past U+10FFFF
+            }
+            else
+            {
+                *out++ = kReplacement;
+                return i;
+            }
+
+            for (size_t k = 1; k < length; ++k, low = 0x80, high = 0xBF)
+            {
+                if (i == size || in[i] < low || in[i] > high)
+                {
+                    *out++ = kReplacement;
+                    return i;
+                }
+                c = c << 6 | (in[i++] & 0x3F);
+            }
+
+            if (c >= 0x10000)
+            {
+                c -= 0x10000;
+                *out++ = static_cast<char16_t>(0xD800 + (c >> 10));
+                *out++ = static_cast<char16_t>(0xDC00 + (c & 0x3FF));
+            }
+            else
+            {
+                *out++ = static_cast<char16_t>(c);
+            }
+            return i;
+        }
+
+        // Scalar up to end, then continues from wherever the last code point finished. The
+        // local copy of out keeps it in a register: stores through char * could alias it.
+        inline size_t EncodeUntil(const char16_t *in, size_t i, size_t end, size_t size, char *&out)
+        {
+            char *o = out;
+            while (i < end)
+            {
+                i = EncodeOne(in, i, size, o);
+            }
+            out = o;
+            return i;
+        }
+
+        inline size_t DecodeUntil(const uint8_t *in, size_t i, size_t end, size_t size, char16_t *&out)
+        {
+            char16_t *o = out;
+            while (i < end)
+            {
+                i = DecodeOne(in, i, size, o);
+            }
+            out = o;
+            return i;
+        }
+
+#ifdef APP_UTF_X86
+        // A block that is not all ASCII is handed to the scalar codec as a whole, then the
+        // vector loop resumes, so mostly-ASCII text stays on the fast path
+
+        size_t Utf16ToUtf8Sse2(const char16_t *in, size_t size, char *out)
+        {
+            char *const begin = out;
+            const __m128i nonAscii = _mm_set1_epi16(static_cast<short>(0xFF80));
+            const __m128i zero = _mm_setzero_si128();
+            size_t i = 0;
+            while (i + 16 <= size)
+            {
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 8));
+                const __m128i high = _mm_and_si128(_mm_or_si128(a, b), nonAscii);
+                if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) == 0xFFFF)
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_packus_epi16(a, b));
+                    out += 16;
+                    i += 16;
+                }
+                else
+                {
+                    i = EncodeUntil(in, i, i + 16, size, out);
+                }
+            }
+            EncodeUntil(in, i, size, size, out);
+            return static_cast<size_t>(out - begin);
+        }
+
+        size_t Utf8ToUtf16Sse2(const char *input, size_t size, char16_t *out)
+        {
+            const auto *in = reinterpret_cast<const uint8_t *>(input);
+            char16_t *const begin = out;
+            const __m128i zero = _mm_setzero_si128();
+            size_t i = 0;
+            while (i + 16 <= size)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+                if (_mm_movemask_epi8(v) == 0)
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_unpacklo_epi8(v, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 8), _mm_unpackhi_epi8(v, zero));
+                    out += 16;
+                    i += 16;
+                }
+                else
+                {
+                    i = DecodeUntil(in, i, i + 16, size, out);
+                }
+            }
+            DecodeUntil(in, i, size, size, out);
+            return static_cast<size_t>(out - begin);
+        }
+
+        APP_TARGET_AVX2 size_t Utf16ToUtf8Avx2(const char16_t *in, size_t size, char *out)
+        {
+            char *const begin = out;
+            const __m256i nonAscii = _mm256_set1_epi16(static_cast<short>(0xFF80));
+            size_t i = 0;
+            while (i + 32 <= size)
+            {
+                const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+                const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i + 16));
+                if (_mm256_testz_si256(_mm256_or_si256(a, b), nonAscii))
+                {
+                    // packus works per 128-bit lane; the permute puts the quarters back in order
+                    const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), packed);
+                    out += 32;
+                    i += 32;
+                }
+                else
+                {
+                    i = EncodeUntil(in, i, i + 32, size, out);
+                }
+            }
+            EncodeUntil(in, i, size, size, out);
+            return static_cast<size_t>(out - begin);
+        }
+
+        APP_TARGET_AVX2 size_t Utf8ToUtf16Avx2(const char *input, size_t size, char16_t *out)
+        {
+            const auto *in = reinterpret_cast<const uint8_t *>(input);
+            char16_t *const begin = out;
+            size_t i = 0;
+            while (i + 32 <= size)
+            {
+                const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+                if (_mm256_movemask_epi8(v) == 0)
+                {
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1)));
+                    out += 32;
+                    i += 32;
+                }
+                else
+                {
+                    i = DecodeUntil(in, i, i + 32, size, out);
+                }
+            }
+            DecodeUntil(in, i, size, size, out);
+            return static_cast<size_t>(out - begin);
+        }
+#endif
+    }
+
+    UtfTranscoder::Kernel UtfTranscoder::DetectKernel()
+    {
+#ifdef APP_UTF_X86
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        const bool osSavesYmm = (info[2] & (1 << 27)) && ((_xgetbv(0) & 0x6) == 0x6);
+        __cpuidex(info, 7, 0);
+        const bool avx2 = osSavesYmm && (info[1] & (1 << 5));
+#else
+        const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+        return avx2 ? Kernel::Avx2 : Kernel::Sse2; // SSE2 is part of x86-64
+#else
+        return Kernel::Scalar;
+#endif
+    }
+
+    UtfTranscoder::Kernel UtfTranscoder::Active()
+    {
+        static const Kernel kernel = DetectKernel();
+        return kernel;
+    }
+
+    size_t UtfTranscoder::Utf16ToUtf8(const char16_t *in, size_t size, char *out, Kernel kernel)
+    {
+        switch (kernel)
+        {
+#ifdef APP_UTF_X86
+        case Kernel::Avx2:
+            return Utf16ToUtf8Avx2(in, size, out);
+        case Kernel::Sse2:
+            return Utf16ToUtf8Sse2(in, size, out);
+#endif
+        default:
+        {
+            char *const begin = out;
+            EncodeUntil(in, 0, size, size, out);
+            return static_cast<size_t>(out - begin);
+        }
+        }
+    }
+
+    size_t UtfTranscoder::Utf8ToUtf16(const char *in, size_t size, char16_t *out, Kernel kernel)
+    {
+        switch (kernel)
+        {
+#ifdef APP_UTF_X86
+        case Kernel::Avx2:
+            return Utf8ToUtf16Avx2(in, size, out);
+        case Kernel::Sse2:
+            return Utf8ToUtf16Sse2(in, size, out);
+#endif
+        default:
+        {
+            char16_t *const begin = out;
+            DecodeUntil(reinterpret_cast<const uint8_t *>(in), 0, size, size, out);
+            return static_cast<size_t>(out - begin);
+        }
+        }
+    }
+
+    void UtfTranscoder::Utf16ToUtf8(std::u16string_view in, std::string &out, Kernel kernel)
+    {
+        // Sized for the worst case without zero-filling it, then cut to what was written
+        out.resize_and_overwrite(MaxUtf8Size(in.size()), [&](char *buffer, size_t)
+                                 { return Utf16ToUtf8(in.data(), in.size(), buffer, kernel); });
+    }
+
+    void UtfTranscoder::Utf8ToUtf16(std::string_view in, std::u16string &out, Kernel kernel)
+    {
+        out.resize_and_overwrite(MaxUtf16Size(in.size()), [&](char16_t *buffer, size_t)
+                                 { return Utf8ToUtf16(in.data(), in.size(), buffer, kernel); });
+    }
+} // namespace app::utils
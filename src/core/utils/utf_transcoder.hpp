@@ -0,0 +1,42 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+namespace app::utils
+{
+    // UTF-8 <-> UTF-16 for the IPC path, where messages are almost entirely ASCII JSON.
+    // ASCII runs are converted 16 or 32 code units at a time with SSE2 or AVX2, everything
+    // else by a scalar codec. Ill-formed input, unpaired surrogates or invalid UTF-8, is
+    // replaced with U+FFFD, one per maximal invalid subpart, as MultiByteToWideChar does.
+    //
+    // The output string is overwritten, not appended to, and keeps its capacity: a buffer
+    // reused across messages stops allocating once it has grown to the largest.
+    class UtfTranscoder
+    {
+    public:
+        enum class Kernel
+        {
+            Scalar,
+            Sse2,
+            Avx2
+        };
+
+        // The best kernel this CPU supports, detected once
+        static Kernel Active();
+        static Kernel DetectKernel();
+
+        static void Utf16ToUtf8(std::u16string_view in, std::string &out) { Utf16ToUtf8(in, out, Active()); }
+        static void Utf8ToUtf16(std::string_view in, std::u16string &out) { Utf8ToUtf16(in, out, Active()); }
+
+        static void Utf16ToUtf8(std::u16string_view in, std::string &out, Kernel kernel);
+        static void Utf8ToUtf16(std::string_view in, std::u16string &out, Kernel kernel);
+
+        // Output written for in: at most 3 bytes per UTF-16 unit, and one unit per UTF-8 byte
+        static constexpr size_t MaxUtf8Size(size_t utf16Units) { return utf16Units * 3; }
+        static constexpr size_t MaxUtf16Size(size_t utf8Bytes) { return utf8Bytes; }
+
+        // The raw conversions, into a buffer of at least the Max size; return what was written
+        static size_t Utf16ToUtf8(const char16_t *in, size_t size, char *out, Kernel kernel);
+        static size_t Utf8ToUtf16(const char *in, size_t size, char16_t *out, Kernel kernel);
+    };
+} // namespace app::utils
@@ -1,4 +1,5 @@
 #include "utils/win32_utils.hpp"
+#include "utils/utf_transcoder.hpp"
 
 namespace app::utils
 {
@@ -60,21 +61,19 @@ namespace app::utils
         SetWindowPos(hwnd, nullptr, x, y, width, height, SWP_NOZORDER | SWP_NOSIZE);
     }
 
-    std::string WideToUtf8(const std::wstring &wstr)
-    {
-        if (wstr.empty())
-        {
-            return std::string();
-        }
+    // wchar_t is UTF-16 on Windows, so wide strings go through the transcoder as they are
+    static_assert(sizeof(wchar_t) == sizeof(char16_t));
 
-        int size_needed = WideCharToMultiByte(CP_UTF8, 0, wstr.data(), (int)wstr.size(),
-                                              nullptr, 0, nullptr, nullptr);
-
-        std::string strTo(size_needed, 0);
-        WideCharToMultiByte(CP_UTF8, 0, wstr.data(), (int)wstr.size(),
-                            strTo.data(), size_needed, nullptr, nullptr);
+    std::string WideToUtf8(std::wstring_view wstr)
+    {
+        std::string out;
+        WideToUtf8(wstr, out);
+        return out;
+    }
 
-        return strTo;
+    void WideToUtf8(std::wstring_view wstr, std::string &out)
+    {
+        UtfTranscoder::Utf16ToUtf8(std::u16string_view(reinterpret_cast<const char16_t *>(wstr.data()), wstr.size()), out);
     }
 
     std::string GetAppDataDirectory(const std::string &appName)
@@ -102,14 +101,17 @@ namespace app::utils
         return appDataDir.string();
     }
 
-    std::wstring Utf8ToWide(const std::string &utf8Str)
+    std::wstring Utf8ToWide(std::string_view str)
+    {
+        std::wstring out;
+        Utf8ToWide(str, out);
+        return out;
+    }
+
+    void Utf8ToWide(std::string_view str, std::wstring &out)
     {
-        if (utf8Str.empty())
-            return L"";
-        int size_needed = MultiByteToWideChar(CP_UTF8, 0, &utf8Str[0], (int)utf8Str.size(), NULL, 0);
-        std::wstring wideStr(size_needed, 0);
-        MultiByteToWideChar(CP_UTF8, 0, &utf8Str[0], (int)utf8Str.size(), &wideStr[0], size_needed);
-        return wideStr;
+        out.resize_and_overwrite(UtfTranscoder::MaxUtf16Size(str.size()), [&](wchar_t *buffer, size_t)
+                                 { return UtfTranscoder::Utf8ToUtf16(str.data(), str.size(), reinterpret_cast<char16_t *>(buffer), UtfTranscoder::Active()); });
     }
 
 } // namespace app::utils
\ No newline at end of file
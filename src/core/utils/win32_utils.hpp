@@ -1,6 +1,7 @@
 #pragma once
 #include <Windows.h>
 #include <string>
+#include <string_view>
 #include <filesystem>
 
 namespace app::utils
@@ -9,7 +10,10 @@ namespace app::utils
     RECT GetWindowRect(HWND hwnd);
     void CenterWindow(HWND hwnd, HWND parent = nullptr);
     std::wstring LoadStringResource(UINT id);
-    std::string WideToUtf8(const std::wstring &wstr);
-    std::wstring Utf8ToWide(const std::string &str);
+    std::string WideToUtf8(std::wstring_view wstr);
+    std::wstring Utf8ToWide(std::string_view str);
+    // Overwrite out, keeping its capacity, so a reused buffer stops allocating
+    void WideToUtf8(std::wstring_view wstr, std::string &out);
+    void Utf8ToWide(std::string_view str, std::wstring &out);
     std::string GetAppDataDirectory(const std::string &appName);
 }
\ No newline at end of file
@@ -0,0 +1,142 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace app::domain
+{
+    // Process-wide genre name -> bit assignment, case-insensitive. Providers register their
+    // manifest genres up front, so the bits are the same for every item of every provider.
+    class GenreRegistry
+    {
+    public:
+        static constexpr size_t kMaxGenres = 64;
+
+        static GenreRegistry &Instance()
+        {
+            static GenreRegistry instance;
+            return instance;
+        }
+
+        // Registers the name if needed; nullopt once all 64 bits are taken
+        std::optional<uint8_t> Bit(std::string_view name)
+        {
+            auto key = Lowercase(name);
+            {
+                std::shared_lock lock(mutex_);
+                if (auto it = bits_.find(key); it != bits_.end())
+                {
+                    return it->second;
+                }
+            }
+
+            std::unique_lock lock(mutex_);
+            if (auto it = bits_.find(key); it != bits_.end())
+            {
+                return it->second;
+            }
+            if (count_ == kMaxGenres)
+            {
+                return std::nullopt;
+            }
+            names_[count_] = std::string(name);
+            bits_.emplace(std::move(key), static_cast<uint8_t>(count_));
+            return static_cast<uint8_t>(count_++);
+        }
+
+        // Looks the name up without registering it
+        std::optional<uint8_t> Find(std::string_view name) const
+        {
+            std::shared_lock lock(mutex_);
+            if (auto it = bits_.find(Lowercase(name)); it != bits_.end())
+            {
+                return it->second;
+            }
+            return std::nullopt;
+        }
+
+        // Display name, as first registered
+        std::string Name(uint8_t bit) const
+        {
+            std::shared_lock lock(mutex_);
+            return bit < count_ ? names_[bit] : std::string();
+        }
+
+        size_t Size() const
+        {
+            std::shared_lock lock(mutex_);
+            return count_;
+        }
+
+    private:
+        GenreRegistry() = default;
+
+        static std::string Lowercase(std::string_view name)
+        {
+            std::string key(name);
+            std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c)
+                           { return static_cast<char>(std::tolower(c)); });
+            return key;
+        }
+
+        mutable std::shared_mutex mutex_;
+        std::unordered_map<std::string, uint8_t> bits_;
+        std::array<std::string, kMaxGenres> names_;
+        size_t count_ = 0;
+    };
+
+    // An item's genres as one bit per GenreRegistry genre: 8 bytes, and genre filters are
+    // mask tests. Past 64 distinct genres process-wide, new names are not recorded.
+    class GenreSet
+    {
+    public:
+        GenreSet() = default;
+        explicit GenreSet(uint64_t mask) : mask_(mask) {}
+
+        bool Add(std::string_view name)
+        {
+            const auto bit = GenreRegistry::Instance().Bit(name);
+            if (bit)
+            {
+                mask_ |= uint64_t{1} << *bit;
+            }
+            return bit.has_value();
+        }
+
+        bool Contains(std::string_view name) const
+        {
+            const auto bit = GenreRegistry::Instance().Find(name);
+            return bit && (mask_ >> *bit) & 1;
+        }
+
+        void Merge(GenreSet other) { mask_ |= other.mask_; }
+
+        std::vector<std::string> Names() const
+        {
+            std::vector<std::string> names;
+            for (uint64_t bits = mask_; bits; bits &= bits - 1)
+            {
+                names.push_back(GenreRegistry::Instance().Name(static_cast<uint8_t>(std::countr_zero(bits))));
+            }
+            return names;
+        }
+
+        uint64_t Mask() const { return mask_; }
+        bool empty() const { return mask_ == 0; }
+        size_t size() const { return static_cast<size_t>(std::popcount(mask_)); }
+
+        friend bool operator==(GenreSet a, GenreSet b) { return a.mask_ == b.mask_; }
+
+    private:
+        uint64_t mask_ = 0;
+    };
+} // namespace app::domain
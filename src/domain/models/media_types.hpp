@@ -3,6 +3,9 @@
 #include <vector>
 #include <chrono>
 #include <optional>
+#include <string_view>
+#include "domain/models/genre_set.hpp"
+#include "core/utils/string_interner.hpp"
 
 namespace app::domain
 {
@@ -18,23 +21,62 @@ namespace app::domain
     {
         std::string id;
         MediaType type;
-        std::string source;      // "tmdb", "imdb", etc.
+        utils::InternedString source; // "tmdb", "imdb", etc.
         std::string original_id; // Original ID from source
     };
+
+    // Ids shared across providers, used to recognise the same title from different sources
+    struct ExternalIds
+    {
+        std::string imdb; // "tt0133093"
+        std::string tmdb; // Only unique together with the media type
+    };
+
+    struct RatingSource
+    {
+        utils::InternedString source; // "IMDb", "RottenTomatoes"
+        float value;                  // On the source's own scale
+        std::string url;
+        int votes = 0;
+    };
+
+    // Image URL split at its last '/': the base is shared by every image of a provider
+    // ("https://image.tmdb.org/t/p/w500") and stored once, only the file name is per item
+    struct ImagePath
+    {
+        utils::InternedString base;
+        std::string file;
+
+        static ImagePath FromUrl(std::string_view url)
+        {
+            const auto slash = url.rfind('/');
+            if (slash == std::string_view::npos)
+            {
+                return {{}, std::string(url)};
+            }
+            return {url.substr(0, slash + 1), std::string(url.substr(slash + 1))};
+        }
+
+        std::string Url() const { return base + file; }
+        bool empty() const { return file.empty(); }
+    };
+
     struct MediaMetadata
     {
         MediaId id;
         std::string title;
         std::optional<std::string> originalTitle;
         std::string overview;
-        std::vector<std::string> genres;
+        GenreSet genres;
         std::chrono::system_clock::time_point releaseDate;
         float rating;
         int voteCount;
-        std::optional<std::string> posterPath;
-        std::optional<std::string> backdropPath;
+        std::optional<ImagePath> posterPath;
+        std::optional<ImagePath> backdropPath;
         float popularity = 0.0f;
         float normalizedRating;
+        ExternalIds externalIds;
+        std::vector<RatingSource> sourceRatings; // One per provider once duplicates are merged
     };
 
     struct MovieInfo : MediaMetadata
@@ -73,13 +115,6 @@ namespace app::domain
         float minRating;
     };
 
-    struct RatingSource
-    {
-        std::string source; // "IMDb", "RottenTomatoes"
-        float value;
-        std::string url;
-    };
-
     struct Review
     {
         std::string author;
@@ -36,7 +36,13 @@ namespace app::cache
             cache_.put(key, value, ttl);
         }
 
+        // Directory for data that outlives the process, e.g. the search index.
+        // Empty until the app configures it, in which case nothing is persisted.
+        void SetDirectory(const std::string &directory) { directory_ = directory; }
+        const std::string &GetDirectory() const { return directory_; }
+
     private:
         utils::LRUCache<std::string, std::any> cache_;
+        std::string directory_;
     };
 }
\ No newline at end of file
@@ -0,0 +1,604 @@
+#include "page_codec.hpp"
+#include <array>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+namespace app::services
+{
+    namespace
+    {
+        constexpr std::array<uint8_t, 4> kMagic = {'M', 'D', 'P', 'G'};
+        constexpr size_t kHeaderSize = 24;
+
+        // Record layout:
+        //
+        //   u16 present bits, u8 media type, f32 rating, f32 popularity, f32 normalized rating,
+        //   zigzag vote count, string id, string source, string title, string overview,
+        //   then for each present bit, in bit order:
+        //     OriginalId     string
+        //     OriginalTitle  string
+        //     ReleaseDate    zigzag seconds since the epoch
+        //     Genres         count, string names
+        //     Poster         string base, string file
+        //     Backdrop       string base, string file
+        //     Imdb           string
+        //     Tmdb           string
+        //     SourceRatings  count, (string source, f32 value, zigzag votes, string url)
+        //   details pages then always carry
+        //     ratings        count, (string source, f32 value, zigzag votes, string url)
+        //     reviews        count, (string author, string content, string source)
+        //     providers      count, strings
+        //     episodes       count, (string title, string overview, zigzag episode, zigzag season,
+        //                            zigzag air date seconds, u8 has still, [string still])
+        //
+        // Genres are stored by name: GenreSet bits are only meaningful inside one process.
+        enum Present : uint16_t
+        {
+            PresentOriginalId = 1 << 0,
+            PresentOriginalTitle = 1 << 1,
+            PresentReleaseDate = 1 << 2,
+            PresentGenres = 1 << 3,
+            PresentPoster = 1 << 4,
+            PresentBackdrop = 1 << 5,
+            PresentImdb = 1 << 6,
+            PresentTmdb = 1 << 7,
+            PresentSourceRatings = 1 << 8
+        };
+
+        int64_t Seconds(std::chrono::system_clock::time_point time)
+        {
+            return std::chrono::floor<std::chrono::seconds>(time.time_since_epoch()).count();
+        }
+
+        // Whether a stored date converts to a time_point without overflowing
+        bool ValidSeconds(int64_t seconds)
+        {
+            constexpr int64_t limit = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::duration::max()).count();
+            return seconds >= -limit && seconds <= limit;
+        }
+
+        class PageWriter
+        {
+        public:
+            void Metadata(const domain::MediaMetadata &item)
+            {
+                itemOffsets_.push_back(static_cast<uint32_t>(records_.size()));
+
+                uint16_t present = 0;
+                present |= item.id.original_id.empty() ? 0 : PresentOriginalId;
+                present |= item.originalTitle ? PresentOriginalTitle : 0;
+                present |= item.releaseDate == std::chrono::system_clock::time_point{} ? 0 : PresentReleaseDate;
+                present |= item.genres.empty() ? 0 : PresentGenres;
+                present |= item.posterPath ? PresentPoster : 0;
+                present |= item.backdropPath ? PresentBackdrop : 0;
+                present |= item.externalIds.imdb.empty() ? 0 : PresentImdb;
+                present |= item.externalIds.tmdb.empty() ? 0 : PresentTmdb;
+                present |= item.sourceRatings.empty() ? 0 : PresentSourceRatings;
+
+                U16(present);
+                records_.push_back(static_cast<uint8_t>(item.id.type));
+                F32(item.rating);
+                F32(item.popularity);
+                F32(item.normalizedRating);
+                ZigZag(item.voteCount);
+                String(item.id.id);
+                String(item.id.source.Get());
+                String(item.title);
+                String(item.overview);
+
+                if (present & PresentOriginalId)
+                    String(item.id.original_id);
+                if (present & PresentOriginalTitle)
+                    String(*item.originalTitle);
+                if (present & PresentReleaseDate)
+                    ZigZag(Seconds(item.releaseDate));
+                if (present & PresentGenres)
+                {
+                    Varint(item.genres.size());
+                    for (uint64_t bits = item.genres.Mask(); bits; bits &= bits - 1)
+                    {
+                        Varint(GenreRef(static_cast<uint8_t>(std::countr_zero(bits))));
+                    }
+                }
+                if (present & PresentPoster)
+                {
+                    String(item.posterPath->base.Get());
+                    String(item.posterPath->file);
+                }
+                if (present & PresentBackdrop)
+                {
+                    String(item.backdropPath->base.Get());
+                    String(item.backdropPath->file);
+                }
+                if (present & PresentImdb)
+                    String(item.externalIds.imdb);
+                if (present & PresentTmdb)
+                    String(item.externalIds.tmdb);
+                if (present & PresentSourceRatings)
+                    Ratings(item.sourceRatings);
+            }
+
+            void Details(const domain::MediaDetails &item)
+            {
+                Metadata(item);
+                Ratings(item.ratings);
+
+                Varint(item.reviews.size());
+                for (const auto &review : item.reviews)
+                {
+                    String(review.author);
+                    String(review.content);
+                    String(review.source);
+                }
+
+                Varint(item.availableProviders.size());
+                for (const auto &provider : item.availableProviders)
+                {
+                    String(provider);
+                }
+
+                Varint(item.episodes.size());
+                for (const auto &episode : item.episodes)
+                {
+                    String(episode.title);
+                    String(episode.overview);
+                    ZigZag(episode.episodeNumber);
+                    ZigZag(episode.seasonNumber);
+                    ZigZag(Seconds(episode.airDate));
+                    records_.push_back(episode.stillPath ? 1 : 0);
+                    if (episode.stillPath)
+                        String(*episode.stillPath);
+                }
+            }
+
+            std::vector<uint8_t> Finish(PageCodec::Kind kind)
+            {
+                itemOffsets_.push_back(static_cast<uint32_t>(records_.size()));
+
+                std::vector<uint8_t> out(kMagic.begin(), kMagic.end());
+                out.reserve(kHeaderSize + 4 * (itemOffsets_.size() + strings_.size() + 1) + stringBytes_ + records_.size());
+                out.push_back(PageCodec::kMajorVersion);
+                out.push_back(PageCodec::kMinorVersion);
+                out.push_back(static_cast<uint8_t>(kind));
+                out.push_back(0);
+                PutU32(out, static_cast<uint32_t>(itemOffsets_.size() - 1));
+                PutU32(out, static_cast<uint32_t>(strings_.size()));
+                PutU32(out, static_cast<uint32_t>(stringBytes_));
+                PutU32(out, static_cast<uint32_t>(records_.size()));
+
+                for (const uint32_t offset : itemOffsets_)
+                {
+                    PutU32(out, offset);
+                }
+                uint32_t stringOffset = 0;
+                for (const auto text : strings_)
+                {
+                    PutU32(out, stringOffset);
+                    stringOffset += static_cast<uint32_t>(text.size());
+                }
+                PutU32(out, stringOffset);
+                for (const auto text : strings_)
+                {
+                    out.insert(out.end(), text.begin(), text.end());
+                }
+                out.insert(out.end(), records_.begin(), records_.end());
+                return out;
+            }
+
+        private:
+            static void PutU32(std::vector<uint8_t> &out, uint32_t value)
+            {
+                for (int i = 0; i < 4; ++i)
+                {
+                    out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+                }
+            }
+
+            void U16(uint16_t value)
+            {
+                records_.push_back(static_cast<uint8_t>(value));
+                records_.push_back(static_cast<uint8_t>(value >> 8));
+            }
+
+            void F32(float value)
+            {
+                PutU32(records_, std::bit_cast<uint32_t>(value));
+            }
+
+            void Varint(uint64_t value)
+            {
+                while (value >= 0x80)
+                {
+                    records_.push_back(static_cast<uint8_t>(value | 0x80));
+                    value >>= 7;
+                }
+                records_.push_back(static_cast<uint8_t>(value));
+            }
+
+            void ZigZag(int64_t value)
+            {
+                Varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+            }
+
+            // The viewed text must outlive the writer: item fields, interned or owned strings
+            void String(std::string_view text)
+            {
+                Varint(StringRef(text));
+            }
+
+            uint32_t StringRef(std::string_view text)
+            {
+                const auto [it, inserted] = stringIds_.try_emplace(text, static_cast<uint32_t>(strings_.size()));
+                if (inserted)
+                {
+                    strings_.push_back(text);
+                    stringBytes_ += text.size();
+                }
+                return it->second;
+            }
+
+            uint32_t GenreRef(uint8_t bit)
+            {
+                if (!genreRefs_[bit])
+                {
+                    genreNames_.push_back(domain::GenreRegistry::Instance().Name(bit));
+                    genreRefs_[bit] = StringRef(genreNames_.back());
+                }
+                return *genreRefs_[bit];
+            }
+
+            void Ratings(const std::vector<domain::RatingSource> &ratings)
+            {
+                Varint(ratings.size());
+                for (const auto &rating : ratings)
+                {
+                    String(rating.source.Get());
+                    F32(rating.value);
+                    ZigZag(rating.votes);
+                    String(rating.url);
+                }
+            }
+
+            std::vector<uint8_t> records_;
+            std::vector<uint32_t> itemOffsets_;
+            std::unordered_map<std::string_view, uint32_t> stringIds_;
+            std::vector<std::string_view> strings_;
+            size_t stringBytes_ = 0;
+            std::array<std::optional<uint32_t>, domain::GenreRegistry::kMaxGenres> genreRefs_;
+            std::deque<std::string> genreNames_; // Stable addresses for the string views
+        };
+    }
+
+    std::vector<uint8_t> PageCodec::Encode(const std::vector<domain::MediaMetadata> &items)
+    {
+        PageWriter writer;
+        for (const auto &item : items)
+        {
+            writer.Metadata(item);
+        }
+        return writer.Finish(Kind::Metadata);
+    }
+
+    std::vector<uint8_t> PageCodec::Encode(const std::vector<domain::MediaDetails> &items)
+    {
+        PageWriter writer;
+        for (const auto &item : items)
+        {
+            writer.Details(item);
+        }
+        return writer.Finish(Kind::Details);
+    }
+
+    bool PageCodec::IsPage(std::span<const uint8_t> bytes)
+    {
+        return bytes.size() >= kHeaderSize && std::memcmp(bytes.data(), kMagic.data(), kMagic.size()) == 0 &&
+               bytes[4] == kMajorVersion;
+    }
+
+    // PageView
+
+    utils::Result<PageView> PageView::Open(std::span<const uint8_t> bytes)
+    {
+        using Result = utils::Result<PageView>;
+        if (bytes.size() < kHeaderSize || std::memcmp(bytes.data(), kMagic.data(), kMagic.size()) != 0)
+        {
+            return Result::Error("Not a media page");
+        }
+        if (bytes[4] != PageCodec::kMajorVersion)
+        {
+            return Result::Error("Unsupported media page version " + std::to_string(bytes[4]));
+        }
+        if (bytes[6] > static_cast<uint8_t>(PageCodec::Kind::Details))
+        {
+            return Result::Error("Unknown media page kind");
+        }
+
+        PageView page;
+        page.minor_ = bytes[5];
+        page.kind_ = static_cast<PageCodec::Kind>(bytes[6]);
+        page.itemCount_ = page.U32At(bytes.data() + 8);
+        page.stringCount_ = page.U32At(bytes.data() + 12);
+        const uint32_t stringBytes = page.U32At(bytes.data() + 16);
+        const uint32_t recordBytes = page.U32At(bytes.data() + 20);
+
+        // 64-bit sums, so no count in a corrupt header can wrap around
+        const uint64_t expected = kHeaderSize + 4 * (uint64_t{page.itemCount_} + 1) + 4 * (uint64_t{page.stringCount_} + 1) +
+                                  stringBytes + recordBytes;
+        if (expected != bytes.size())
+        {
+            return Result::Error("Truncated or oversized media page");
+        }
+
+        page.itemIndex_ = bytes.data() + kHeaderSize;
+        page.stringIndex_ = page.itemIndex_ + 4 * (size_t{page.itemCount_} + 1);
+        page.strings_ = reinterpret_cast<const char *>(page.stringIndex_ + 4 * (size_t{page.stringCount_} + 1));
+        page.records_ = reinterpret_cast<const uint8_t *>(page.strings_) + stringBytes;
+
+        auto monotonic = [&page](const uint8_t *index, uint32_t count, uint32_t total)
+        {
+            uint32_t previous = 0;
+            for (uint32_t i = 0; i <= count; ++i)
+            {
+                const uint32_t offset = page.U32At(index + 4 * size_t{i});
+                if (offset < previous || (i == 0 && offset != 0))
+                    return false;
+                previous = offset;
+            }
+            return previous == total;
+        };
+        if (!monotonic(page.stringIndex_, page.stringCount_, stringBytes) ||
+            !monotonic(page.itemIndex_, page.itemCount_, recordBytes))
+        {
+            return Result::Error("Corrupt media page index");
+        }
+
+        for (size_t i = 0; i < page.itemCount_; ++i)
+        {
+            auto item = page.Item(i);
+            if (!item.Parse())
+            {
+                return Result::Error("Corrupt media page record " + std::to_string(i));
+            }
+        }
+        return page;
+    }
+
+    uint32_t PageView::U32At(const uint8_t *p) const
+    {
+        return uint32_t{p[0]} | uint32_t{p[1]} << 8 | uint32_t{p[2]} << 16 | uint32_t{p[3]} << 24;
+    }
+
+    MediaItemView PageView::Item(size_t index) const
+    {
+        return MediaItemView(*this, records_ + U32At(itemIndex_ + 4 * index), records_ + U32At(itemIndex_ + 4 * (index + 1)));
+    }
+
+    MediaItemView PageView::operator[](size_t index) const
+    {
+        auto item = Item(index);
+        item.Parse(); // Checked by Open
+        return item;
+    }
+
+    std::vector<domain::MediaMetadata> PageView::ToMetadata() const
+    {
+        std::vector<domain::MediaMetadata> items;
+        items.reserve(itemCount_);
+        for (size_t i = 0; i < itemCount_; ++i)
+        {
+            items.push_back((*this)[i].ToMetadata());
+        }
+        return items;
+    }
+
+    std::vector<domain::MediaDetails> PageView::ToDetails() const
+    {
+        std::vector<domain::MediaDetails> items;
+        items.reserve(itemCount_);
+        for (size_t i = 0; i < itemCount_; ++i)
+        {
+            items.push_back((*this)[i].ToDetails());
+        }
+        return items;
+    }
+
+    // MediaItemView
+
+    MediaItemView::MediaItemView(const PageView &page, const uint8_t *begin, const uint8_t *end)
+        : stringIndex_(page.stringIndex_), strings_(page.strings_), stringCount_(page.stringCount_),
+          isDetails_(page.kind_ == PageCodec::Kind::Details), begin_(begin), end_(end) {}
+
+    bool MediaItemView::Parse()
+    {
+        Reader reader(begin_, end_);
+        auto stringRef = [&]
+        {
+            const uint32_t index = reader.StringRef();
+            if (index >= stringCount_)
+                reader.Fail();
+            return index;
+        };
+        // Notes where a repeated field starts and walks over it
+        auto list = [&](size_t strings, bool isRating)
+        {
+            const uint8_t *start = reader.Position();
+            for (auto count = reader.Varint(); count > 0 && reader.ok(); --count)
+            {
+                for (size_t s = 0; s < strings; ++s)
+                {
+                    stringRef();
+                    if (isRating && s == 0)
+                    {
+                        reader.F32();
+                        reader.ZigZag();
+                    }
+                }
+            }
+            return start;
+        };
+
+        present_ = reader.U16();
+        const uint8_t type = reader.U8();
+        if (type > static_cast<uint8_t>(domain::MediaType::Episode))
+            return false;
+        type_ = static_cast<domain::MediaType>(type);
+        rating_ = reader.F32();
+        popularity_ = reader.F32();
+        normalizedRating_ = reader.F32();
+        voteCount_ = static_cast<int>(reader.ZigZag());
+        id_ = stringRef();
+        source_ = stringRef();
+        title_ = stringRef();
+        overview_ = stringRef();
+
+        if (present_ & PresentOriginalId)
+            originalId_ = stringRef();
+        if (present_ & PresentOriginalTitle)
+            originalTitle_ = stringRef();
+        if (present_ & PresentReleaseDate)
+        {
+            const int64_t seconds = reader.ZigZag();
+            if (!ValidSeconds(seconds))
+                return false;
+            releaseDate_ = std::chrono::system_clock::time_point(std::chrono::seconds(seconds));
+        }
+        if (present_ & PresentGenres)
+            genres_ = list(1, false);
+        if (present_ & PresentPoster)
+        {
+            poster_[0] = stringRef();
+            poster_[1] = stringRef();
+        }
+        if (present_ & PresentBackdrop)
+        {
+            backdrop_[0] = stringRef();
+            backdrop_[1] = stringRef();
+        }
+        if (present_ & PresentImdb)
+            imdb_ = stringRef();
+        if (present_ & PresentTmdb)
+            tmdb_ = stringRef();
+        if (present_ & PresentSourceRatings)
+            sourceRatings_ = list(2, true);
+
+        if (isDetails_)
+        {
+            ratings_ = list(2, true);
+            reviews_ = list(3, false);
+            providers_ = list(1, false);
+            episodes_ = reader.Position();
+            for (auto count = reader.Varint(); count > 0 && reader.ok(); --count)
+            {
+                stringRef();
+                stringRef();
+                reader.ZigZag();
+                reader.ZigZag();
+                if (!ValidSeconds(reader.ZigZag()))
+                    return false;
+                if (reader.U8())
+                    stringRef();
+            }
+        }
+        return reader.ok(); // Bytes past the known fields come from a newer minor version
+    }
+
+    std::string_view MediaItemView::String(uint32_t index) const
+    {
+        const uint8_t *offsets = stringIndex_ + 4 * size_t{index};
+        const uint32_t begin = uint32_t{offsets[0]} | uint32_t{offsets[1]} << 8 | uint32_t{offsets[2]} << 16 | uint32_t{offsets[3]} << 24;
+        const uint32_t end = uint32_t{offsets[4]} | uint32_t{offsets[5]} << 8 | uint32_t{offsets[6]} << 16 | uint32_t{offsets[7]} << 24;
+        return {strings_ + begin, end - begin};
+    }
+
+    std::string_view MediaItemView::Id() const { return String(id_); }
+    std::string_view MediaItemView::Source() const { return String(source_); }
+    std::string_view MediaItemView::Title() const { return String(title_); }
+    std::string_view MediaItemView::Overview() const { return String(overview_); }
+
+    std::string_view MediaItemView::OriginalId() const
+    {
+        return present_ & PresentOriginalId ? String(originalId_) : std::string_view();
+    }
+
+    std::optional<std::string_view> MediaItemView::OriginalTitle() const
+    {
+        if (present_ & PresentOriginalTitle)
+            return String(originalTitle_);
+        return std::nullopt;
+    }
+
+    std::string_view MediaItemView::ImdbId() const
+    {
+        return present_ & PresentImdb ? String(imdb_) : std::string_view();
+    }
+
+    std::string_view MediaItemView::TmdbId() const
+    {
+        return present_ & PresentTmdb ? String(tmdb_) : std::string_view();
+    }
+
+    std::optional<ImageView> MediaItemView::Image(uint16_t flag, const uint32_t (&refs)[2]) const
+    {
+        if (present_ & flag)
+            return ImageView{String(refs[0]), String(refs[1])};
+        return std::nullopt;
+    }
+
+    std::optional<ImageView> MediaItemView::PosterPath() const { return Image(PresentPoster, poster_); }
+    std::optional<ImageView> MediaItemView::BackdropPath() const { return Image(PresentBackdrop, backdrop_); }
+
+    domain::MediaMetadata MediaItemView::ToMetadata() const
+    {
+        domain::MediaMetadata item;
+        item.id.id = Id();
+        item.id.type = type_;
+        item.id.source = Source();
+        item.id.original_id = OriginalId();
+        item.title = Title();
+        if (auto originalTitle = OriginalTitle())
+            item.originalTitle = std::string(*originalTitle);
+        item.overview = Overview();
+        ForEachGenre([&item](std::string_view name)
+                     { item.genres.Add(name); });
+        item.releaseDate = releaseDate_;
+        item.rating = rating_;
+        item.voteCount = voteCount_;
+        if (auto poster = PosterPath())
+            item.posterPath = domain::ImagePath{poster->base, std::string(poster->file)};
+        if (auto backdrop = BackdropPath())
+            item.backdropPath = domain::ImagePath{backdrop->base, std::string(backdrop->file)};
+        item.popularity = popularity_;
+        item.normalizedRating = normalizedRating_;
+        item.externalIds.imdb = ImdbId();
+        item.externalIds.tmdb = TmdbId();
+        ForEachSourceRating([&item](const RatingView &rating)
+                            { item.sourceRatings.push_back({rating.source, rating.value, std::string(rating.url), rating.votes}); });
+        return item;
+    }
+
+    domain::MediaDetails MediaItemView::ToDetails() const
+    {
+        domain::MediaDetails details;
+        static_cast<domain::MediaMetadata &>(details) = ToMetadata();
+        ForEachRating([&details](const RatingView &rating)
+                      { details.ratings.push_back({rating.source, rating.value, std::string(rating.url), rating.votes}); });
+        ForEachReview([&details](const ReviewView &review)
+                      { details.reviews.push_back({std::string(review.author), std::string(review.content), std::string(review.source)}); });
+        ForEachProvider([&details](std::string_view provider)
+                        { details.availableProviders.emplace_back(provider); });
+        ForEachEpisode([&details](const EpisodeView &episode)
+                       {
+            domain::EpisodeInfo info;
+            info.title = episode.title;
+            info.overview = episode.overview;
+            info.episodeNumber = episode.episodeNumber;
+            info.seasonNumber = episode.seasonNumber;
+            info.airDate = episode.airDate;
+            if (episode.stillPath)
+                info.stillPath = std::string(*episode.stillPath);
+            details.episodes.push_back(std::move(info)); });
+        return details;
+    }
+} // namespace app::services
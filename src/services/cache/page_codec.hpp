@@ -0,0 +1,354 @@
+#pragma once
+#include "domain/models/media_types.hpp"
+#include "core/utils/result.hpp"
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace app::services
+{
+    // Binary encoding of a page of MediaMetadata or MediaDetails, for the cache, disk and IPC.
+    //
+    // Layout, all integers little-endian:
+    //
+    //   header       "MDPG", u8 major, u8 minor, u8 kind, u8 0,
+    //                u32 item count, u32 string count, u32 string bytes, u32 record bytes
+    //   item index   u32 record offset per item, plus the end offset
+    //   string index u32 offset per string, plus the end offset
+    //   strings      UTF-8 bytes, each distinct string stored once
+    //   records      one per item, see page_codec.cpp
+    //
+    // Strings are referenced by varint index, counts and dates are varints, and fields that
+    // are usually absent are announced by a bitmap instead of taking space. Readers reject
+    // another major version; a minor version may only append fields to the end of a
+    // record, which older readers skip.
+    class PageCodec
+    {
+    public:
+        static constexpr uint8_t kMajorVersion = 1;
+        static constexpr uint8_t kMinorVersion = 0;
+
+        enum class Kind : uint8_t
+        {
+            Metadata = 0,
+            Details = 1
+        };
+
+        static std::vector<uint8_t> Encode(const std::vector<domain::MediaMetadata> &items);
+        static std::vector<uint8_t> Encode(const std::vector<domain::MediaDetails> &items);
+
+        // Cheap test for a buffer that was written by Encode, e.g. to tell it from JSON
+        static bool IsPage(std::span<const uint8_t> bytes);
+    };
+
+    class PageView;
+
+    struct ImageView
+    {
+        std::string_view base;
+        std::string_view file;
+    };
+
+    struct RatingView
+    {
+        std::string_view source;
+        float value;
+        std::string_view url;
+        int votes;
+    };
+
+    struct ReviewView
+    {
+        std::string_view author;
+        std::string_view content;
+        std::string_view source;
+    };
+
+    struct EpisodeView
+    {
+        std::string_view title;
+        std::string_view overview;
+        int episodeNumber;
+        int seasonNumber;
+        std::chrono::system_clock::time_point airDate;
+        std::optional<std::string_view> stillPath;
+    };
+
+    // One item of a page, read in place: strings are views into the page buffer and
+    // nothing is allocated. Valid as long as the buffer.
+    class MediaItemView
+    {
+    public:
+        std::string_view Id() const;
+        std::string_view Source() const;
+        std::string_view OriginalId() const;
+        domain::MediaType Type() const { return type_; }
+        std::string_view Title() const;
+        std::optional<std::string_view> OriginalTitle() const;
+        std::string_view Overview() const;
+        std::chrono::system_clock::time_point ReleaseDate() const { return releaseDate_; }
+        float Rating() const { return rating_; }
+        int VoteCount() const { return voteCount_; }
+        float Popularity() const { return popularity_; }
+        float NormalizedRating() const { return normalizedRating_; }
+        std::optional<ImageView> PosterPath() const;
+        std::optional<ImageView> BackdropPath() const;
+        std::string_view ImdbId() const;
+        std::string_view TmdbId() const;
+
+        // Repeated fields are walked in place
+        template <typename F>
+        void ForEachGenre(F &&visit) const;
+        template <typename F>
+        void ForEachSourceRating(F &&visit) const;
+
+        // Details pages only
+        template <typename F>
+        void ForEachRating(F &&visit) const;
+        template <typename F>
+        void ForEachReview(F &&visit) const;
+        template <typename F>
+        void ForEachProvider(F &&visit) const;
+        template <typename F>
+        void ForEachEpisode(F &&visit) const;
+
+        // Copies the item out
+        domain::MediaMetadata ToMetadata() const;
+        domain::MediaDetails ToDetails() const;
+
+    private:
+        friend class PageView;
+
+        // Bounds-checked little-endian reads; past the end, every read yields 0 and ok() is false
+        class Reader
+        {
+        public:
+            Reader(const uint8_t *begin, const uint8_t *end) : p_(begin), end_(end) {}
+
+            uint8_t U8()
+            {
+                if (p_ == end_)
+                {
+                    Fail();
+                    return 0;
+                }
+                return *p_++;
+            }
+
+            uint16_t U16()
+            {
+                if (end_ - p_ < 2)
+                {
+                    Fail();
+                    return 0;
+                }
+                const uint16_t value = static_cast<uint16_t>(p_[0] | p_[1] << 8);
+                p_ += 2;
+                return value;
+            }
+
+            float F32()
+            {
+                if (end_ - p_ < 4)
+                {
+                    Fail();
+                    return 0.0f;
+                }
+                const uint32_t bits = uint32_t{p_[0]} | uint32_t{p_[1]} << 8 | uint32_t{p_[2]} << 16 | uint32_t{p_[3]} << 24;
+                p_ += 4;
+                return std::bit_cast<float>(bits);
+            }
+
+            uint64_t Varint()
+            {
+                uint64_t value = 0;
+                for (int shift = 0; shift < 64; shift += 7)
+                {
+                    const uint8_t byte = U8();
+                    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                    if (!(byte & 0x80))
+                        return value;
+                }
+                Fail();
+                return 0;
+            }
+
+            int64_t ZigZag()
+            {
+                const uint64_t value = Varint();
+                return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+            }
+
+            uint32_t StringRef() { return static_cast<uint32_t>(Varint()); }
+
+            const uint8_t *Position() const { return p_; }
+            bool ok() const { return ok_; }
+            void Fail()
+            {
+                ok_ = false;
+                p_ = end_;
+            }
+
+        private:
+            const uint8_t *p_;
+            const uint8_t *end_;
+            bool ok_ = true;
+        };
+
+        MediaItemView(const PageView &page, const uint8_t *begin, const uint8_t *end);
+
+        std::string_view String(uint32_t index) const;
+        std::optional<ImageView> Image(uint16_t flag, const uint32_t (&refs)[2]) const;
+        template <typename F>
+        void ForEachRatingAt(const uint8_t *list, F &visit) const;
+
+        // Walks the record, noting where every field is; false if it is malformed
+        bool Parse();
+
+        const uint8_t *stringIndex_;
+        const char *strings_;
+        uint32_t stringCount_;
+        bool isDetails_;
+        const uint8_t *begin_;
+        const uint8_t *end_;
+
+        uint16_t present_ = 0;
+        domain::MediaType type_ = domain::MediaType::Movie;
+        float rating_ = 0.0f;
+        float popularity_ = 0.0f;
+        float normalizedRating_ = 0.0f;
+        int voteCount_ = 0;
+        std::chrono::system_clock::time_point releaseDate_{};
+        uint32_t id_ = 0, source_ = 0, title_ = 0, overview_ = 0;
+        uint32_t originalId_ = 0, originalTitle_ = 0, imdb_ = 0, tmdb_ = 0;
+        uint32_t poster_[2] = {}, backdrop_[2] = {};
+        // Repeated fields start with their count; null when absent
+        const uint8_t *genres_ = nullptr;
+        const uint8_t *sourceRatings_ = nullptr;
+        const uint8_t *ratings_ = nullptr; // The rest is only in details pages
+        const uint8_t *reviews_ = nullptr;
+        const uint8_t *providers_ = nullptr;
+        const uint8_t *episodes_ = nullptr;
+    };
+
+    // A validated, read-only view over an encoded page. The buffer is not copied and
+    // must outlive the view and every item view taken from it.
+    class PageView
+    {
+    public:
+        // Checks the header, the indexes and every record up front, so reading items
+        // afterwards cannot run out of bounds
+        static utils::Result<PageView> Open(std::span<const uint8_t> bytes);
+
+        PageCodec::Kind GetKind() const { return kind_; }
+        uint8_t MinorVersion() const { return minor_; }
+        size_t size() const { return itemCount_; }
+        bool empty() const { return itemCount_ == 0; }
+
+        MediaItemView operator[](size_t index) const;
+
+        std::vector<domain::MediaMetadata> ToMetadata() const;
+        std::vector<domain::MediaDetails> ToDetails() const; // Metadata pages yield empty details fields
+
+    private:
+        friend class MediaItemView;
+
+        PageView() = default;
+
+        uint32_t U32At(const uint8_t *p) const;
+        MediaItemView Item(size_t index) const;
+
+        PageCodec::Kind kind_ = PageCodec::Kind::Metadata;
+        uint8_t minor_ = 0;
+        uint32_t itemCount_ = 0;
+        uint32_t stringCount_ = 0;
+        const uint8_t *itemIndex_ = nullptr;
+        const uint8_t *stringIndex_ = nullptr;
+        const char *strings_ = nullptr;
+        const uint8_t *records_ = nullptr;
+    };
+
+    // Repeated fields, walked in place from where Parse found them
+
+    template <typename F>
+    void MediaItemView::ForEachGenre(F &&visit) const
+    {
+        Reader reader(genres_, end_);
+        for (auto count = genres_ ? reader.Varint() : 0; count > 0; --count)
+        {
+            visit(String(reader.StringRef()));
+        }
+    }
+
+    template <typename F>
+    void MediaItemView::ForEachSourceRating(F &&visit) const
+    {
+        ForEachRatingAt(sourceRatings_, visit);
+    }
+
+    template <typename F>
+    void MediaItemView::ForEachRating(F &&visit) const
+    {
+        ForEachRatingAt(ratings_, visit);
+    }
+
+    template <typename F>
+    void MediaItemView::ForEachRatingAt(const uint8_t *list, F &visit) const
+    {
+        Reader reader(list, end_);
+        for (auto count = list ? reader.Varint() : 0; count > 0; --count)
+        {
+            const auto source = String(reader.StringRef());
+            const float value = reader.F32();
+            const int votes = static_cast<int>(reader.ZigZag());
+            visit(RatingView{source, value, String(reader.StringRef()), votes});
+        }
+    }
+
+    template <typename F>
+    void MediaItemView::ForEachReview(F &&visit) const
+    {
+        Reader reader(reviews_, end_);
+        for (auto count = reviews_ ? reader.Varint() : 0; count > 0; --count)
+        {
+            const auto author = String(reader.StringRef());
+            const auto content = String(reader.StringRef());
+            visit(ReviewView{author, content, String(reader.StringRef())});
+        }
+    }
+
+    template <typename F>
+    void MediaItemView::ForEachProvider(F &&visit) const
+    {
+        Reader reader(providers_, end_);
+        for (auto count = providers_ ? reader.Varint() : 0; count > 0; --count)
+        {
+            visit(String(reader.StringRef()));
+        }
+    }
+
+    template <typename F>
+    void MediaItemView::ForEachEpisode(F &&visit) const
+    {
+        Reader reader(episodes_, end_);
+        for (auto count = episodes_ ? reader.Varint() : 0; count > 0; --count)
+        {
+            EpisodeView episode{};
+            episode.title = String(reader.StringRef());
+            episode.overview = String(reader.StringRef());
+            episode.episodeNumber = static_cast<int>(reader.ZigZag());
+            episode.seasonNumber = static_cast<int>(reader.ZigZag());
+            episode.airDate = std::chrono::system_clock::time_point(std::chrono::seconds(reader.ZigZag()));
+            if (reader.U8())
+            {
+                episode.stillPath = String(reader.StringRef());
+            }
+            visit(episode);
+        }
+    }
+} // namespace app::services
@@ -0,0 +1,350 @@
+#include "catalog_store.hpp"
+#include "services/media/IMediaProvider.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <limits>
+#include <mutex>
+
+namespace app::services
+{
+    namespace
+    {
+        std::string Lowercase(std::string text)
+        {
+            std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c)
+                           { return static_cast<char>(std::tolower(c)); });
+            return text;
+        }
+
+        int16_t YearOf(const std::chrono::system_clock::time_point &date)
+        {
+            if (date.time_since_epoch().count() == 0)
+            {
+                return 0; // Providers that send no date leave the epoch
+            }
+            const std::chrono::year_month_day day{std::chrono::floor<std::chrono::days>(date)};
+            return static_cast<int16_t>(static_cast<int>(day.year()));
+        }
+    }
+
+    CatalogQuery CatalogQuery::FromFilter(const MediaFilter &filter)
+    {
+        CatalogQuery query;
+        if (filter.type)
+        {
+            // Same reading as MediaService::MatchesFilter: "movie" or anything else
+            query.type = Lowercase(*filter.type) == "movie" ? domain::MediaType::Movie : domain::MediaType::TvShow;
+        }
+        if (filter.genre)
+        {
+            query.genres.push_back(*filter.genre);
+        }
+        if (filter.year)
+        {
+            query.minYear = query.maxYear = *filter.year;
+        }
+        return query;
+    }
+
+    bool CatalogQuery::IsEmpty() const
+    {
+        return !type && genres.empty() && !minYear && !maxYear && minRating <= 0.0f && minVotes <= 0;
+    }
+
+    CatalogStore &CatalogStore::Instance()
+    {
+        static CatalogStore instance;
+        return instance;
+    }
+
+    CatalogStore::GenreMask CatalogStore::ResolveGenres(const std::vector<std::string> &genres)
+    {
+        GenreMask mask;
+        for (const auto &genre : genres)
+        {
+            if (const auto bit = domain::GenreRegistry::Instance().Find(genre))
+            {
+                mask.bits |= uint64_t{1} << *bit;
+            }
+            else
+            {
+                mask.unknown = true;
+            }
+        }
+        return mask;
+    }
+
+    void CatalogStore::Add(const std::vector<domain::MediaMetadata> &items)
+    {
+        std::unique_lock lock(mutex_);
+        for (const auto &item : items)
+        {
+            const auto [it, inserted] = idToRow_.try_emplace(item.id.source + ":" + item.id.id, static_cast<uint32_t>(rows_.size()));
+            const uint32_t row = it->second;
+            if (inserted)
+            {
+                rows_.emplace_back();
+                if (row == year_.size())
+                {
+                    // Columns grow a whole block at a time so every scan loop has a fixed trip count
+                    const size_t padded = year_.size() + kBlockRows;
+                    year_.resize(padded);
+                    votes_.resize(padded);
+                    rating_.resize(padded);
+                    type_.resize(padded);
+                    genres_.resize(padded);
+                    for (auto &keys : sortKeys_)
+                    {
+                        keys.resize(padded);
+                    }
+                }
+            }
+
+            year_[row] = YearOf(item.releaseDate);
+            votes_[row] = item.voteCount;
+            rating_[row] = item.normalizedRating;
+            type_[row] = static_cast<uint8_t>(item.id.type);
+            genres_[row] = item.genres.Mask();
+            for (size_t field = 0; field < sortKeys_.size(); ++field)
+            {
+                sortKeys_[field][row] = ResultMerger::SortKey(item, {static_cast<SortField>(field), false});
+            }
+            rows_[row] = item;
+        }
+    }
+
+    void CatalogStore::ScanLocked(const CatalogQuery &query, const GenreMask &genres, std::vector<uint32_t> &rows) const
+    {
+        const size_t count = rows_.size();
+        const bool testGenres = !query.genres.empty();
+        const bool testType = query.type.has_value();
+        const uint8_t type = testType ? static_cast<uint8_t>(*query.type) : 0;
+        const int16_t minYear = static_cast<int16_t>(query.minYear);
+        const int16_t maxYear = static_cast<int16_t>(query.maxYear);
+        const float minRating = query.minRating;
+        const int32_t minVotes = query.minVotes;
+        const bool allGenres = query.matchAllGenres;
+
+        // A genre no item has ever had matches nothing
+        if (testGenres && (query.matchAllGenres ? genres.unknown : genres.bits == 0))
+        {
+            return;
+        }
+
+        // One pass per active predicate, each a plain loop over one column ANDing into the
+        // block's selection words. No branches on the data and a constant trip count (the
+        // columns are padded to whole blocks), so they vectorize; padding is never emitted.
+        // The selection is 32-bit rather than bytes: byte stores may alias the columns, which
+        // keeps compilers from vectorizing without runtime checks. The usually most selective
+        // predicates go first, and a block is dropped as soon as nothing in it is left.
+        alignas(64) uint32_t keep[kBlockRows];
+        auto blockEmpty = [&keep]
+        {
+            uint32_t any = 0;
+            for (size_t i = 0; i < kBlockRows; ++i)
+            {
+                any |= keep[i];
+            }
+            return any == 0;
+        };
+
+        for (size_t base = 0; base < count; base += kBlockRows)
+        {
+            std::fill_n(keep, kBlockRows, uint32_t{1});
+
+            if (testGenres)
+            {
+                // (x | -x) >> 63 is x != 0 without a 64-bit compare, which SSE2 lacks
+                const uint64_t *bits = genres_.data() + base;
+                const uint64_t wanted = genres.bits;
+                if (allGenres)
+                {
+                    for (size_t i = 0; i < kBlockRows; ++i)
+                    {
+                        const uint64_t missing = (bits[i] & wanted) ^ wanted;
+                        keep[i] &= static_cast<uint32_t>(1 - ((missing | (0 - missing)) >> 63));
+                    }
+                }
+                else
+                {
+                    for (size_t i = 0; i < kBlockRows; ++i)
+                    {
+                        const uint64_t shared = bits[i] & wanted;
+                        keep[i] &= static_cast<uint32_t>((shared | (0 - shared)) >> 63);
+                    }
+                }
+                if (blockEmpty())
+                {
+                    continue;
+                }
+            }
+            if (minVotes > 0)
+            {
+                const int32_t *votes = votes_.data() + base;
+                for (size_t i = 0; i < kBlockRows; ++i)
+                {
+                    keep[i] &= static_cast<uint32_t>(votes[i] >= minVotes);
+                }
+                if (blockEmpty())
+                {
+                    continue;
+                }
+            }
+            if (minRating > 0.0f)
+            {
+                const float *rating = rating_.data() + base;
+                for (size_t i = 0; i < kBlockRows; ++i)
+                {
+                    keep[i] &= static_cast<uint32_t>(rating[i] >= minRating);
+                }
+                if (blockEmpty())
+                {
+                    continue;
+                }
+            }
+            if (minYear || maxYear)
+            {
+                // Unknown years (0) stay out of bounded queries
+                const int16_t *year = year_.data() + base;
+                const int16_t upper = maxYear ? maxYear : std::numeric_limits<int16_t>::max();
+                for (size_t i = 0; i < kBlockRows; ++i)
+                {
+                    keep[i] &= static_cast<uint32_t>((year[i] >= minYear) & (year[i] <= upper) & (year[i] != 0));
+                }
+                if (blockEmpty())
+                {
+                    continue;
+                }
+            }
+            if (testType)
+            {
+                const uint8_t *types = type_.data() + base;
+                for (size_t i = 0; i < kBlockRows; ++i)
+                {
+                    keep[i] &= static_cast<uint32_t>(types[i] == type);
+                }
+            }
+
+            // Branch-free compaction: always write, advance by the selection word. Groups with
+            // nothing selected, most of them for selective filters, are skipped whole.
+            const size_t live = std::min(kBlockRows, count - base);
+            const size_t start = rows.size();
+            rows.resize(start + live);
+            uint32_t *out = rows.data() + start;
+            size_t kept = 0;
+            for (size_t group = 0; group < live; group += kGroupRows)
+            {
+                uint32_t any = 0;
+                for (size_t i = group; i < group + kGroupRows; ++i)
+                {
+                    any |= keep[i];
+                }
+                if (!any)
+                {
+                    continue;
+                }
+                for (size_t i = group; i < std::min(group + kGroupRows, live); ++i)
+                {
+                    out[kept] = static_cast<uint32_t>(base + i);
+                    kept += keep[i];
+                }
+            }
+            rows.resize(start + kept);
+        }
+    }
+
+    std::vector<uint32_t> CatalogStore::Filter(const CatalogQuery &query) const
+    {
+        std::shared_lock lock(mutex_);
+        std::vector<uint32_t> rows;
+        ScanLocked(query, ResolveGenres(query.genres), rows);
+        return rows;
+    }
+
+    CatalogPage CatalogStore::Browse(const CatalogQuery &query, SortOrder order, size_t offset, size_t limit) const
+    {
+        std::shared_lock lock(mutex_);
+        std::vector<uint32_t> rows;
+        ScanLocked(query, ResolveGenres(query.genres), rows);
+
+        CatalogPage page;
+        page.total = rows.size();
+        if (offset >= rows.size())
+        {
+            return page;
+        }
+
+        // Only the rows up to the end of the page are ordered
+        const auto &keys = sortKeys_[static_cast<size_t>(order.field)];
+        std::vector<std::pair<uint64_t, uint32_t>> keyed;
+        keyed.reserve(rows.size());
+        for (const uint32_t row : rows)
+        {
+            keyed.emplace_back(order.descending ? ~keys[row] : keys[row], row);
+        }
+        const size_t end = limit ? std::min(rows.size(), offset + limit) : rows.size();
+        std::partial_sort(keyed.begin(), keyed.begin() + end, keyed.end(), [&](const auto &a, const auto &b)
+                          {
+            if (ResultMerger::Before(a.first, rows_[a.second], b.first, rows_[b.second], order)) {
+                return true;
+            }
+            return !ResultMerger::Before(b.first, rows_[b.second], a.first, rows_[a.second], order) && a.second < b.second; });
+
+        page.items.reserve(end - offset);
+        for (size_t i = offset; i < end; ++i)
+        {
+            page.items.push_back(rows_[keyed[i].second]);
+        }
+        return page;
+    }
+
+    CatalogFacets CatalogStore::Facets(const CatalogQuery &query) const
+    {
+        std::shared_lock lock(mutex_);
+        const FacetColumns columns{year_.data(), rating_.data(), type_.data(), genres_.data(), rows_.size()};
+
+        CatalogFacets facets;
+        if (query.IsEmpty())
+        {
+            facets.counts = FacetEngine::Count(columns, nullptr);
+        }
+        else
+        {
+            std::vector<uint32_t> rows;
+            ScanLocked(query, ResolveGenres(query.genres), rows);
+            facets.counts = FacetEngine::Count(columns, &rows);
+        }
+        const size_t genres = domain::GenreRegistry::Instance().Size();
+        for (size_t bit = 0; bit < genres; ++bit)
+        {
+            facets.genreNames.push_back(domain::GenreRegistry::Instance().Name(static_cast<uint8_t>(bit)));
+        }
+        return facets;
+    }
+
+    std::vector<domain::MediaMetadata> CatalogStore::Get(const std::vector<std::string> &ids, std::vector<std::string> *missing) const
+    {
+        std::vector<domain::MediaMetadata> items;
+        items.reserve(ids.size());
+        std::shared_lock lock(mutex_);
+        for (const auto &id : ids)
+        {
+            if (const auto it = idToRow_.find(id); it != idToRow_.end())
+            {
+                items.push_back(rows_[it->second]);
+            }
+            else if (missing)
+            {
+                missing->push_back(id);
+            }
+        }
+        return items;
+    }
+
+    size_t CatalogStore::Size() const
+    {
+        std::shared_lock lock(mutex_);
+        return rows_.size();
+    }
+} // namespace app::services
@@ -0,0 +1,97 @@
+#pragma once
+#include "domain/models/media_types.hpp"
+#include "services/catalog/facet_engine.hpp"
+#include "services/media/result_merger.hpp"
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace app::services
+{
+    struct MediaFilter;
+
+    // Browse filter, every set field must match
+    struct CatalogQuery
+    {
+        std::optional<domain::MediaType> type;
+        std::vector<std::string> genres; // Any of them, or all with matchAllGenres
+        bool matchAllGenres = false;
+        int minYear = 0; // 0 leaves the bound open
+        int maxYear = 0;
+        float minRating = 0.0f; // normalizedRating
+        int minVotes = 0;
+
+        static CatalogQuery FromFilter(const MediaFilter &filter);
+        bool IsEmpty() const;
+    };
+
+    struct CatalogPage
+    {
+        std::vector<domain::MediaMetadata> items;
+        size_t total = 0; // Matches before offset/limit
+    };
+
+    struct CatalogFacets
+    {
+        FacetCounts counts;
+        std::vector<std::string> genreNames; // By genre bit
+    };
+
+    // Every catalog item the providers have returned, stored column by column so filters
+    // answer locally instead of refetching.
+    //
+    // Items get dense row ids; year, votes, rating, type and a genre bitset each live in
+    // their own array, so a filter only reads the columns it tests. Predicates are applied
+    // branch-free one column at a time over fixed-size blocks, loops the compiler turns
+    // into SIMD compares. The full MediaMetadata rows are only touched for the page that
+    // is returned.
+    class CatalogStore
+    {
+    public:
+        static CatalogStore &Instance();
+
+        // Adds or updates items, keyed by "source:id"
+        void Add(const std::vector<domain::MediaMetadata> &items);
+
+        // Row ids of the matching items, ascending
+        std::vector<uint32_t> Filter(const CatalogQuery &query) const;
+        CatalogPage Browse(const CatalogQuery &query, SortOrder order, size_t offset, size_t limit) const;
+        CatalogFacets Facets(const CatalogQuery &query) const;
+        // Items by "source:id", in the order asked. Ids never added are skipped, and listed in
+        // missing if given.
+        std::vector<domain::MediaMetadata> Get(const std::vector<std::string> &ids, std::vector<std::string> *missing = nullptr) const;
+
+        size_t Size() const;
+
+    private:
+        CatalogStore() = default;
+
+        static constexpr size_t kBlockRows = 1024;
+        static constexpr size_t kGroupRows = 32; // Compaction skips empty groups
+
+        struct GenreMask
+        {
+            uint64_t bits = 0;
+            bool unknown = false; // Names no item has ever had
+        };
+
+        static GenreMask ResolveGenres(const std::vector<std::string> &genres);
+        void ScanLocked(const CatalogQuery &query, const GenreMask &genres, std::vector<uint32_t> &rows) const;
+
+        mutable std::shared_mutex mutex_;
+        std::unordered_map<std::string, uint32_t> idToRow_;
+
+        // Columns, one entry per row
+        std::vector<int16_t> year_; // 0 when unknown
+        std::vector<int32_t> votes_;
+        std::vector<float> rating_; // normalizedRating
+        std::vector<uint8_t> type_;
+        std::vector<uint64_t> genres_; // GenreSet masks
+        std::array<std::vector<uint64_t>, 4> sortKeys_; // Ascending ResultMerger keys, per SortField
+        std::vector<domain::MediaMetadata> rows_;
+    };
+} // namespace app::services
@@ -0,0 +1,99 @@
+#include "facet_engine.hpp"
+#include <algorithm>
+#include <bit>
+#include <future>
+#include <thread>
+
+namespace app::services
+{
+    void FacetCounts::Merge(const FacetCounts &other)
+    {
+        total += other.total;
+        unknownYear += other.unknownYear;
+        for (size_t i = 0; i < genres.size(); ++i)
+        {
+            genres[i] += other.genres[i];
+        }
+        for (size_t i = 0; i < decades.size(); ++i)
+        {
+            decades[i] += other.decades[i];
+        }
+        for (size_t i = 0; i < ratings.size(); ++i)
+        {
+            ratings[i] += other.ratings[i];
+        }
+        for (size_t i = 0; i < types.size(); ++i)
+        {
+            types[i] += other.types[i];
+        }
+    }
+
+    template <typename RowAt>
+    void FacetEngine::CountRange(const FacetColumns &columns, size_t begin, size_t end, RowAt rowAt, FacetCounts &counts)
+    {
+        counts.total += end - begin;
+        for (size_t i = begin; i < end; ++i)
+        {
+            const uint32_t row = rowAt(i);
+
+            const int year = columns.year[row];
+            if (year == 0)
+            {
+                ++counts.unknownYear;
+            }
+            else
+            {
+                const int decade = std::clamp((year - FacetCounts::kFirstDecade) / 10, 0, static_cast<int>(FacetCounts::kDecades) - 1);
+                ++counts.decades[decade];
+            }
+
+            const int bucket = static_cast<int>(columns.rating[row] * 2.0f);
+            ++counts.ratings[std::clamp(bucket, 0, static_cast<int>(FacetCounts::kRatingBuckets) - 1)];
+            ++counts.types[std::min<size_t>(columns.type[row], FacetCounts::kTypes - 1)];
+
+            for (uint64_t bits = columns.genres[row]; bits; bits &= bits - 1)
+            {
+                ++counts.genres[std::countr_zero(bits)];
+            }
+        }
+    }
+
+    FacetCounts FacetEngine::Count(const FacetColumns &columns, const std::vector<uint32_t> *rows)
+    {
+        const size_t count = rows ? rows->size() : columns.count;
+        const size_t partitions = std::clamp<size_t>(count / kMinPartitionRows, 1, std::max(1u, std::thread::hardware_concurrency()));
+
+        auto countPartition = [&](size_t partition)
+        {
+            FacetCounts counts;
+            const size_t begin = count * partition / partitions;
+            const size_t end = count * (partition + 1) / partitions;
+            if (rows)
+            {
+                CountRange(columns, begin, end, [rows](size_t i)
+                           { return (*rows)[i]; }, counts);
+            }
+            else
+            {
+                CountRange(columns, begin, end, [](size_t i)
+                           { return static_cast<uint32_t>(i); }, counts);
+            }
+            return counts;
+        };
+
+        // The calling thread takes the first partition itself
+        std::vector<std::future<FacetCounts>> workers;
+        workers.reserve(partitions - 1);
+        for (size_t partition = 1; partition < partitions; ++partition)
+        {
+            workers.push_back(std::async(std::launch::async, countPartition, partition));
+        }
+
+        FacetCounts counts = countPartition(0);
+        for (auto &worker : workers)
+        {
+            counts.Merge(worker.get());
+        }
+        return counts;
+    }
+} // namespace app::services
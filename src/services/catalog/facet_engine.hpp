@@ -0,0 +1,53 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace app::services
+{
+    // Read-only view of the CatalogStore columns a facet count needs
+    struct FacetColumns
+    {
+        const int16_t *year = nullptr;
+        const float *rating = nullptr;
+        const uint8_t *type = nullptr;
+        const uint64_t *genres = nullptr;
+        size_t count = 0;
+    };
+
+    struct FacetCounts
+    {
+        static constexpr int kFirstDecade = 1870;
+        static constexpr size_t kDecades = 24;       // 1870s to 2100s
+        static constexpr size_t kRatingBuckets = 10; // Half points of the 0-5 normalized rating
+        static constexpr size_t kTypes = 3;          // domain::MediaType
+
+        size_t total = 0;
+        std::array<uint32_t, 64> genres{}; // By genre bit
+        std::array<uint32_t, kDecades> decades{};
+        uint32_t unknownYear = 0;
+        std::array<uint32_t, kRatingBuckets> ratings{};
+        std::array<uint32_t, kTypes> types{};
+
+        void Merge(const FacetCounts &other);
+    };
+
+    // "Action (1,234) · 2020s (567)" counts in one pass over the columns.
+    //
+    // Rows are split into contiguous partitions counted in parallel, each into its own
+    // FacetCounts so the workers share nothing; the partial counts are summed at the end.
+    class FacetEngine
+    {
+    public:
+        // Counts the given rows, or every row when rows is null
+        static FacetCounts Count(const FacetColumns &columns, const std::vector<uint32_t> *rows);
+
+    private:
+        static constexpr size_t kMinPartitionRows = 64 * 1024; // Smaller inputs are not worth a thread
+
+        template <typename RowAt>
+        static void CountRange(const FacetColumns &columns, size_t begin, size_t end, RowAt rowAt, FacetCounts &counts);
+    };
+} // namespace app::services
@@ -94,10 +94,14 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <functional>
 #include <future>
+#include <memory>
 #include <optional>
 #include "nlohmann/json.hpp"
 #include <fmt/format.h>
+#include "core/utils/result.hpp"
+#include "domain/models/media_types.hpp"
 
 namespace app::services
 {
@@ -137,11 +141,13 @@ namespace app::services
         std::vector<std::string> supportedTypes;
         std::vector<std::string> supportedGenres;
         std::vector<std::string> supportedSortOptions;
+        std::vector<std::string> supportedCatalogs;
         bool supportsSearch;
         bool supportsCatalog;
     };
 
-    class IMediaProvider
+    // Providers are owned by shared_ptr, so a fetch can hold its provider until it finishes
+    class IMediaProvider : public std::enable_shared_from_this<IMediaProvider>
     {
     public:
         virtual ~IMediaProvider() = default;
@@ -157,6 +163,14 @@ namespace app::services
 
         virtual std::future<utils::Result<std::vector<domain::MediaMetadata>>> SearchMedia(const std::string &query, const MediaFilter &filter, int page) = 0;
 
+        // The same requests, handing the result to done on the thread that fetched it, so a
+        // fan-out needs no thread of its own to wait on a future. done runs exactly once and
+        // must keep alive whatever it uses. The provider holds shared_from_this() until done
+        // has returned, so it may be unregistered or reloaded while a fetch is in flight.
+        using PageCallback = std::function<void(utils::Result<std::vector<domain::MediaMetadata>>)>;
+        virtual void GetCatalog(const std::string &catalogType, const MediaFilter &filter, int page, PageCallback done) = 0;
+        virtual void SearchMedia(const std::string &query, const MediaFilter &filter, int page, PageCallback done) = 0;
+
         // Media details and metadata
         virtual std::future<utils::Result<domain::MediaMetadata>>
         GetMediaDetails(const domain::MediaId &id) = 0;
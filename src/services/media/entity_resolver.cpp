@@ -0,0 +1,258 @@
+#include "entity_resolver.hpp"
+#include "core/utils/rating_normalizer.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <unordered_map>
+
+namespace app::services
+{
+    namespace
+    {
+        enum KeyKind : uint8_t
+        {
+            KeyImdb = 1,
+            KeyTmdb = 2,
+            KeyTitle = 3
+        };
+
+        // Fingerprints are 64-bit FNV-1a hashes, so the index never allocates per key.
+        // A collision would need ~2^32 distinct titles in one request.
+        class Fingerprint
+        {
+        public:
+            explicit Fingerprint(KeyKind kind) { Mix(&kind, 1); }
+
+            Fingerprint &Mix(const void *data, size_t size)
+            {
+                const auto *bytes = static_cast<const uint8_t *>(data);
+                for (size_t i = 0; i < size; ++i)
+                {
+                    hash_ = (hash_ ^ bytes[i]) * 0x100000001b3ull;
+                }
+                return *this;
+            }
+
+            Fingerprint &Mix(std::string_view value) { return Mix(value.data(), value.size()); }
+
+            uint64_t Value() const { return hash_; }
+
+        private:
+            uint64_t hash_ = 0xcbf29ce484222325ull;
+        };
+
+        int ReleaseYear(const domain::MediaMetadata &item)
+        {
+            if (item.releaseDate.time_since_epoch().count() == 0)
+            {
+                return 0; // Unknown
+            }
+            const std::chrono::year_month_day date{std::chrono::floor<std::chrono::days>(item.releaseDate)};
+            return static_cast<int>(date.year());
+        }
+
+        // Up to three keys per item; zero marks an unused slot
+        using Keys = std::array<uint64_t, 3>;
+
+        Keys Fingerprints(const domain::MediaMetadata &item, std::string &titleBuffer)
+        {
+            Keys keys{};
+            const auto type = static_cast<uint8_t>(item.id.type);
+            if (!item.externalIds.imdb.empty())
+            {
+                keys[0] = Fingerprint(KeyImdb).Mix(item.externalIds.imdb).Value();
+            }
+            if (!item.externalIds.tmdb.empty())
+            {
+                keys[1] = Fingerprint(KeyTmdb).Mix(&type, 1).Mix(item.externalIds.tmdb).Value();
+            }
+
+            // Without a year a title alone is too ambiguous (remakes, re-releases)
+            const int year = ReleaseYear(item);
+            EntityResolver::NormalizeTitle(item.title, titleBuffer);
+            if (year != 0 && !titleBuffer.empty())
+            {
+                keys[2] = Fingerprint(KeyTitle).Mix(&type, 1).Mix(&year, sizeof(year)).Mix(titleBuffer).Value();
+            }
+            return keys;
+        }
+
+        // Both sides carry the same kind of id and the ids differ: two titles that happen to
+        // share a name and year, such as a remake released the same year
+        bool IdsConflict(const domain::MediaMetadata &a, const domain::MediaMetadata &b)
+        {
+            const auto differ = [](const std::string &x, const std::string &y)
+            { return !x.empty() && !y.empty() && x != y; };
+            return differ(a.externalIds.imdb, b.externalIds.imdb) || differ(a.externalIds.tmdb, b.externalIds.tmdb);
+        }
+
+        void AddRatingSource(domain::MediaMetadata &item)
+        {
+            item.sourceRatings.push_back({item.id.source, item.rating, {}, item.voteCount});
+        }
+
+        void Merge(domain::MediaMetadata &into, domain::MediaMetadata &&from)
+        {
+            if (into.sourceRatings.empty())
+            {
+                AddRatingSource(into);
+            }
+            if (from.sourceRatings.empty())
+            {
+                AddRatingSource(from);
+            }
+            std::move(from.sourceRatings.begin(), from.sourceRatings.end(), std::back_inserter(into.sourceRatings));
+
+            // Recomputed from every provider's rating, vote-weighted so a provider with a
+            // handful of votes cannot drag a title around
+            into.normalizedRating = RatingNormalizer::Instance().GetAggregateRating(into.sourceRatings);
+            // Each provider's count stays in sourceRatings. Providers mostly count the same
+            // votes (several relay IMDb's), so adding them up would overstate the total.
+            into.voteCount = std::max(into.voteCount, from.voteCount);
+            into.popularity = std::max(into.popularity, from.popularity);
+
+            if (into.overview.empty())
+            {
+                into.overview = std::move(from.overview);
+            }
+            if (!into.originalTitle)
+            {
+                into.originalTitle = std::move(from.originalTitle);
+            }
+            if (!into.posterPath)
+            {
+                into.posterPath = std::move(from.posterPath);
+            }
+            if (!into.backdropPath)
+            {
+                into.backdropPath = std::move(from.backdropPath);
+            }
+            if (into.releaseDate.time_since_epoch().count() == 0)
+            {
+                into.releaseDate = from.releaseDate;
+            }
+            if (into.externalIds.imdb.empty())
+            {
+                into.externalIds.imdb = std::move(from.externalIds.imdb);
+            }
+            if (into.externalIds.tmdb.empty())
+            {
+                into.externalIds.tmdb = std::move(from.externalIds.tmdb);
+            }
+            into.genres.Merge(from.genres);
+        }
+    }
+
+    void EntityResolver::NormalizeTitle(std::string_view title, std::string &out)
+    {
+        out.clear();
+        for (const char c : title)
+        {
+            const auto byte = static_cast<unsigned char>(c);
+            if (byte >= 'A' && byte <= 'Z')
+            {
+                out.push_back(static_cast<char>(byte - 'A' + 'a'));
+            }
+            else if ((byte >= 'a' && byte <= 'z') || (byte >= '0' && byte <= '9') || byte >= 0x80)
+            {
+                out.push_back(c);
+            }
+        }
+    }
+
+    namespace
+    {
+        struct ResolverState
+        {
+            // Fingerprint -> surviving item. Survivors are compacted towards the front of
+            // their vector and never move again, so the pointers stay valid.
+            std::pmr::unordered_map<uint64_t, domain::MediaMetadata *> index;
+            std::string titleBuffer;
+            EntityResolver::Stats stats;
+
+            explicit ResolverState(std::pmr::memory_resource *scratch) : index(scratch) {}
+        };
+
+        void Compact(std::vector<domain::MediaMetadata> &items, ResolverState &state)
+        {
+            size_t write = 0;
+            for (size_t read = 0; read < items.size(); ++read)
+            {
+                const Keys keys = Fingerprints(items[read], state.titleBuffer);
+
+                domain::MediaMetadata *match = nullptr;
+                size_t matchedKey = 0;
+                for (size_t k = 0; k < keys.size() && !match; ++k)
+                {
+                    if (keys[k] == 0)
+                    {
+                        continue;
+                    }
+                    // The title key is only a fallback for items missing an id
+                    if (auto it = state.index.find(keys[k]); it != state.index.end() &&
+                                                             (k != 2 || !IdsConflict(*it->second, items[read])))
+                    {
+                        match = it->second;
+                        matchedKey = k;
+                    }
+                }
+
+                if (!match)
+                {
+                    if (write != read)
+                    {
+                        items[write] = std::move(items[read]);
+                    }
+                    match = &items[write++];
+                }
+                else
+                {
+                    (matchedKey == 2 ? state.stats.mergedByTitle : state.stats.mergedById)++;
+                    Merge(*match, std::move(items[read]));
+                }
+
+                // Register every key of this item, so e.g. a later title-only duplicate finds
+                // an entity that was first seen with an IMDb id
+                for (const uint64_t key : keys)
+                {
+                    if (key != 0)
+                    {
+                        state.index.try_emplace(key, match);
+                    }
+                }
+            }
+
+            items.erase(items.begin() + static_cast<std::ptrdiff_t>(write), items.end());
+        }
+    }
+
+    EntityResolver::Stats EntityResolver::Resolve(std::vector<domain::MediaMetadata> &items, std::pmr::memory_resource *scratch)
+    {
+        ResolverState state(scratch);
+        state.stats.input = items.size();
+        state.index.reserve(items.size() * 2);
+
+        Compact(items, state);
+        state.stats.output = items.size();
+        return state.stats;
+    }
+
+    EntityResolver::Stats EntityResolver::Resolve(std::vector<std::vector<domain::MediaMetadata>> &streams, std::pmr::memory_resource *scratch)
+    {
+        ResolverState state(scratch);
+        for (const auto &stream : streams)
+        {
+            state.stats.input += stream.size();
+        }
+        state.index.reserve(state.stats.input * 2);
+
+        for (auto &stream : streams)
+        {
+            Compact(stream, state);
+            state.stats.output += stream.size();
+        }
+        return state.stats;
+    }
+} // namespace app::services
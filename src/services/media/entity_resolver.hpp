@@ -0,0 +1,41 @@
+#pragma once
+#include "domain/models/media_types.hpp"
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace app::services
+{
+    // Collapses items that describe the same title into a single entry. Items are matched
+    // by IMDb id, by TMDB id, or by normalized title + media type + release year. A title
+    // match is rejected when both items carry an IMDb or TMDB id and those ids differ.
+    class EntityResolver
+    {
+    public:
+        struct Stats
+        {
+            size_t input = 0;
+            size_t output = 0;
+            size_t mergedById = 0;
+            size_t mergedByTitle = 0;
+        };
+
+        // Merges duplicates in place, in a single pass. The first occurrence of an entity
+        // keeps its position; later duplicates fold their rating and missing fields into it,
+        // raise its vote count to theirs if larger, and are removed. The fingerprint index
+        // is allocated from `scratch`.
+        static Stats Resolve(std::vector<domain::MediaMetadata> &items,
+                             std::pmr::memory_resource *scratch = std::pmr::get_default_resource());
+
+        // Same, across per-provider streams. Each stream keeps its own order, which lets
+        // an already sorted provider page stay sorted for the merge that follows.
+        static Stats Resolve(std::vector<std::vector<domain::MediaMetadata>> &streams,
+                             std::pmr::memory_resource *scratch = std::pmr::get_default_resource());
+
+        // Lowercased ASCII letters and digits only, so "Spider-Man: No Way Home" and
+        // "Spider Man - No Way Home" compare equal. Non-ASCII bytes are kept as-is.
+        static void NormalizeTitle(std::string_view title, std::string &out);
+    };
+} // namespace app::services
@@ -3,10 +3,24 @@
 #include "media_service.hpp"
 #include "services/providers/GenericProvider.hpp"
 #include "services/providers/provider_repository.hpp"
+#include "services/providers/provider_watcher.hpp"
 #include "core/utils/logger.hpp"
+#include "core/utils/request_arena.hpp"
 #include <fmt/format.h>
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <iterator>
+#include <thread>
+#include <unordered_set>
 #include "../cache/cache_manager.hpp"
-#include "utils/rating_normalizer.hpp"
+#include "core/utils/rating_normalizer.hpp"
+#include "services/media/entity_resolver.hpp"
+#include "services/media/result_merger.hpp"
+#include "services/media/service_events.hpp"
+#include "services/search/search_index.hpp"
+#include "services/catalog/catalog_store.hpp"
+#include "core/config/config_manager.hpp"
 
 namespace app::services
 {
@@ -16,10 +30,33 @@ namespace app::services
         return instance;
     }
 
+    MediaService::MediaService()
+        : providers_(std::make_shared<const ProviderSet>())
+    {
+        searchController_ = std::make_unique<SearchController>(
+            [this](const SearchRequest &request, const SearchController::PartialCallback &onPartial,
+                   const std::shared_ptr<ReplyChannel> &channel)
+            { return RunSearch(request.query, request.catalogType, request.filter, request.page, request.limit, onPartial, channel); },
+            std::chrono::milliseconds(150));
+    }
+
+    MediaService::~MediaService()
+    {
+        if (providerWatcher_)
+        {
+            providerWatcher_->Stop();
+        }
+    }
+
     bool MediaService::Initialize(const std::string &providersDir)
     {
         try
         {
+            {
+                std::lock_guard<std::mutex> lock(backgroundMutex_);
+                backgroundClosed_ = false;
+            }
+
             // Ensure the providers directory exists
             if (!std::filesystem::exists(providersDir))
             {
@@ -27,8 +64,47 @@ namespace app::services
                 return false;
             }
 
+            // Deadlines, see the "search" section of app_config.json
+            const auto &config = config::ConfigManager::Instance();
+            searchDeadline_ = std::chrono::milliseconds(config.GetOrDefault<int>("search.deadline_ms", static_cast<int>(searchDeadline_.count())));
+            providerBudget_ = std::chrono::milliseconds(config.GetOrDefault<int>("search.provider_budget_ms", static_cast<int>(providerBudget_.count())));
+            minProviderBudget_ = std::chrono::milliseconds(config.GetOrDefault<int>("search.min_provider_budget_ms", static_cast<int>(minProviderBudget_.count())));
+            searchController_->SetDebounce(std::chrono::milliseconds(config.GetOrDefault<int>("search.debounce_ms", 150)));
+
+            // "scale", "zscore" or "bayesian", see RatingNormalizer
+            const auto normalization = config.GetOrDefault<std::string>("ratings.normalization", "bayesian");
+            const auto priorVotes = static_cast<float>(config.GetOrDefault<int>("ratings.prior_votes", static_cast<int>(RatingNormalizer::kDefaultPriorVotes)));
+            if (normalization == "scale")
+                RatingNormalizer::Instance().SetMethod(RatingNormalizer::Method::Scale);
+            else if (normalization == "zscore")
+                RatingNormalizer::Instance().SetMethod(RatingNormalizer::Method::ZScore);
+            else
+                RatingNormalizer::Instance().SetMethod(RatingNormalizer::Method::Bayesian, priorVotes);
+
+            // Local search answers from whatever was fetched in earlier sessions
+            auto indexPath = SearchIndexPath();
+            if (!indexPath.empty() && !std::filesystem::exists(indexPath))
+            {
+                indexPath = std::filesystem::path(indexPath).replace_extension(".json").string(); // Before the binary format
+            }
+            if (!indexPath.empty() && std::filesystem::exists(indexPath))
+            {
+                if (auto loaded = SearchIndex::Instance().Load(indexPath); loaded.IsError())
+                {
+                    utils::Logger::Warning(loaded.GetError().message);
+                }
+                CatalogStore::Instance().Add(SearchIndex::Instance().Items());
+            }
+
             // Load providers from the specified directory
             ProviderRepository::Instance().LoadProvidersFromManifests(providersDir);
+
+            // Pick up manifest edits without a restart
+            providerWatcher_ = std::make_unique<ProviderWatcher>();
+            providerWatcher_->Start(providersDir, [providersDir](const std::vector<std::filesystem::path> &changedFiles)
+                                    { ProviderRepository::Instance().ReloadManifests(providersDir, changedFiles); });
+
+            initialized_ = true;
             return true;
         }
         catch (const std::exception &e)
@@ -40,8 +116,31 @@ namespace app::services
 
     void MediaService::Shutdown()
     {
-        std::lock_guard<std::mutex> lock(providerMutex_);
-        providers_.clear();
+        CancelAllSearches();
+        {
+            // Late results stop being waited for; what already arrived is still cached
+            std::unique_lock<std::mutex> lock(backgroundMutex_);
+            backgroundClosed_ = true;
+            for (const auto &channel : background_)
+            {
+                channel->Cancel();
+            }
+            backgroundDone_.wait(lock, [this]
+                                 { return background_.empty(); });
+        }
+        if (providerWatcher_)
+        {
+            providerWatcher_->Stop();
+        }
+        PublishProviders(std::make_shared<ProviderSet>());
+
+        if (const auto indexPath = SearchIndexPath(); !indexPath.empty())
+        {
+            if (auto saved = SearchIndex::Instance().Save(indexPath); saved.IsError())
+            {
+                utils::Logger::Error(saved.GetError().message);
+            }
+        }
         initialized_ = false;
         utils::Logger::Info("MediaService shut down");
     }
@@ -49,76 +148,426 @@ namespace app::services
     void MediaService::RegisterProvider(const std::string &providerId,
                                         std::unique_ptr<IMediaProvider> provider)
     {
-        std::lock_guard<std::mutex> lock(providerMutex_);
-        providers_[providerId] = std::move(provider);
-        utils::Logger::Info(fmt::format("Registered provider: {}", providerId));
+        UpdateProviders({{providerId, std::shared_ptr<IMediaProvider>(std::move(provider))}}, {});
+    }
+
+    void MediaService::UnregisterProvider(const std::string &providerId)
+    {
+        UpdateProviders({}, {providerId});
+    }
+
+    void MediaService::ReplaceProviders(std::unordered_map<std::string, std::shared_ptr<IMediaProvider>> providers)
+    {
+        std::lock_guard<std::mutex> lock(providerWriteMutex_);
+        auto next = std::make_shared<ProviderSet>();
+        next->providers = std::move(providers);
+        PublishProviders(std::move(next));
+    }
+
+    void MediaService::UpdateProviders(std::unordered_map<std::string, std::shared_ptr<IMediaProvider>> upserts,
+                                       const std::vector<std::string> &removals)
+    {
+        std::lock_guard<std::mutex> lock(providerWriteMutex_);
+
+        // Copy-on-write: readers holding the current set are unaffected
+        auto next = std::make_shared<ProviderSet>(*providers_.load());
+        for (const auto &providerId : removals)
+        {
+            next->providers.erase(providerId);
+            utils::Logger::Info(fmt::format("Unregistered provider: {}", providerId));
+        }
+        for (auto &[providerId, provider] : upserts)
+        {
+            next->providers[providerId] = std::move(provider);
+            utils::Logger::Info(fmt::format("Registered provider: {}", providerId));
+        }
+        PublishProviders(std::move(next));
+    }
+
+    void MediaService::PublishProviders(std::shared_ptr<ProviderSet> next)
+    {
+        next->routing.Build(next->providers);
+        const auto count = next->providers.size();
+        providers_.store(std::move(next));
+        utils::Logger::Info(fmt::format("Published provider set with {} provider(s)", count));
+    }
+
+    ProviderSnapshot MediaService::GetProviderSnapshot() const
+    {
+        return providers_.load();
+    }
+
+    std::vector<std::string> MediaService::GetAvailableProviders() const
+    {
+        auto snapshot = GetProviderSnapshot();
+        std::vector<std::string> ids;
+        ids.reserve(snapshot->providers.size());
+        for (const auto &[id, provider] : snapshot->providers)
+        {
+            ids.push_back(id);
+        }
+        return ids;
+    }
+
+    std::vector<ProviderHealthSnapshot> MediaService::GetProviderHealth()
+    {
+        return health_.SnapshotAll(GetAvailableProviders(), providerBudget_, minProviderBudget_);
+    }
+
+    std::vector<MediaService::PendingReply> MediaService::StartFanOut(const ProviderSnapshot &snapshot,
+                                                                      const std::string &query,
+                                                                      const std::string &catalogType,
+                                                                      const MediaFilter &filter,
+                                                                      int page,
+                                                                      const std::shared_ptr<ReplyChannel> &channel,
+                                                                      std::chrono::steady_clock::time_point overallDeadline,
+                                                                      std::vector<std::string> &skipped)
+    {
+        std::vector<PendingReply> pending;
+        const ProviderMask targets = snapshot->routing.Select(query, catalogType, filter);
+        pending.reserve(targets.count());
+
+        // Only providers that list the sort option are asked for it; the merger sorts the rest
+        const ProviderMask nativeSort = filter.sortBy ? snapshot->routing.SortsNatively(*filter.sortBy) : ProviderMask().set();
+        MediaFilter unsorted = filter;
+        unsorted.sortBy.reset();
+
+        snapshot->routing.ForEach(targets, [&](const ProviderRoutingIndex::Route &route)
+                                  {
+            auto health = health_.Get(route.providerId);
+            if (!health->AllowRequest()) {
+                utils::Logger::Info(fmt::format("Skipping provider {}: circuit open", route.providerId));
+                skipped.push_back(route.providerId);
+                return;
+            }
+
+            const auto budget = health->Budget(providerBudget_, minProviderBudget_);
+            const auto started = std::chrono::steady_clock::now();
+            const MediaFilter &pushed = nativeSort.test(route.slot) ? filter : unsorted;
+
+            // Runs on the provider's own thread, which keeps the provider alive; a request that
+            // stops waiting leaves nothing behind but that thread
+            auto done = [channel, health, providerId = route.providerId,
+                         started, hardLimit = providerBudget_](utils::Result<std::vector<domain::MediaMetadata>> result)
+            {
+                const auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - started);
+                health->Record(latency, result.IsOk() && latency <= hardLimit);
+                channel->Push({providerId, std::move(result), latency});
+            };
+            if (query.empty()) {
+                route.provider->GetCatalog(catalogType, pushed, page, std::move(done)); // Use catalog for popular movies
+            } else {
+                route.provider->SearchMedia(query, pushed, page, std::move(done)); // Use search if a query is provided
+            }
+
+            pending.push_back({route.providerId, std::min(started + budget, overallDeadline)}); });
+
+        return pending;
+    }
+
+    std::future<utils::Result<UnifiedSearchResult>>
+    MediaService::UnifiedSearch(const std::string &query, const std::string &catalogType, const MediaFilter &filter, int page,
+                                size_t limit)
+    {
+        return std::async(std::launch::async, [=, this]()
+                          { return RunSearch(query, catalogType, filter, page, limit, nullptr); });
+    }
+
+    std::future<utils::Result<UnifiedSearchResult>>
+    MediaService::UnifiedSearchStreaming(const std::string &query, const std::string &catalogType, const MediaFilter &filter, int page,
+                                         PartialResultCallback onPartial, size_t limit)
+    {
+        return std::async(std::launch::async, [=, this, onPartial = std::move(onPartial)]()
+                          { return RunSearch(query, catalogType, filter, page, limit, onPartial); });
+    }
+
+    void MediaService::SubmitSearch(const std::string &sessionId, SearchRequest request,
+                                    SearchController::PartialCallback onPartial, SearchController::CompleteCallback onComplete)
+    {
+        searchController_->Submit(sessionId, std::move(request), std::move(onPartial), std::move(onComplete));
     }
 
-    std::future<utils::Result<std::vector<domain::MediaMetadata>>>
-    MediaService::UnifiedSearch(const std::string &query, const std::string &catalogType, const MediaFilter &filter, int page)
+    void MediaService::CancelSearch(const std::string &sessionId)
     {
-        return std::async(std::launch::async, [=]()
-                          {
+        searchController_->Cancel(sessionId);
+    }
+
+    void MediaService::CancelAllSearches()
+    {
+        searchController_->CancelAll();
+    }
+
+    void MediaService::NormalizeRatings(std::vector<domain::MediaMetadata> &items)
+    {
+        RatingNormalizer::Instance().NormalizePage(items);
+    }
+
+    std::string MediaService::SearchIndexPath()
+    {
+        const auto &directory = cache::CacheManager::Instance().GetDirectory();
+        return directory.empty() ? std::string() : (std::filesystem::path(directory) / "search_index.bin").string();
+    }
+
+    bool MediaService::MatchesFilter(const domain::MediaMetadata &item, const MediaFilter &filter)
+    {
+        auto equalsIgnoreCase = [](const std::string &a, const std::string &b)
+        {
+            return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](unsigned char x, unsigned char y)
+                              { return std::tolower(x) == std::tolower(y); });
+        };
+
+        if (filter.type)
+        {
+            const bool wantsMovie = equalsIgnoreCase(*filter.type, "movie");
+            if (wantsMovie != (item.id.type == domain::MediaType::Movie))
+            {
+                return false;
+            }
+        }
+        if (filter.year)
+        {
+            const std::chrono::year_month_day date{std::chrono::floor<std::chrono::days>(item.releaseDate)};
+            if (static_cast<int>(date.year()) != *filter.year)
+            {
+                return false;
+            }
+        }
+        if (filter.genre)
+        {
+            return item.genres.Contains(*filter.genre);
+        }
+        return true;
+    }
+
+    std::vector<domain::MediaMetadata> MediaService::MergeResults(std::vector<std::vector<domain::MediaMetadata>> streams,
+                                                                  const MediaFilter &filter, size_t limit,
+                                                                  std::pmr::memory_resource *scratch)
+    {
+        // Merge the same title coming from several providers first, as that changes its rating
+        const auto stats = EntityResolver::Resolve(streams, scratch);
+        if (stats.output != stats.input)
+        {
+            utils::Logger::Debug(fmt::format("Merged {} duplicate(s) ({} by id, {} by title), {} item(s) left",
+                                             stats.input - stats.output, stats.mergedById, stats.mergedByTitle, stats.output));
+        }
+
+        ResultMerger merger(ParseSortOrder(filter.sortBy, filter.sortDesc), limit, scratch);
+        for (auto &stream : streams)
+        {
+            merger.AddStream(std::move(stream));
+        }
+        return merger.Take();
+    }
+
+    utils::Result<UnifiedSearchResult>
+    MediaService::RunSearch(const std::string &query, const std::string &catalogType, const MediaFilter &filter, int page,
+                            size_t limit, const PartialResultCallback &onPartial, std::shared_ptr<ReplyChannel> channel)
+    {
+        const auto started = std::chrono::steady_clock::now();
+        bool firstPartial = true;
+        auto emitPartial = [&](const std::string &providerId, const std::vector<domain::MediaMetadata> &items)
+        {
+            if (!onPartial || items.empty()) {
+                return;
+            }
+            if (firstPartial) {
+                firstPartial = false;
+                utils::Logger::Debug(fmt::format("First items after {}ms from {}", std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - started).count(), providerId));
+            }
+            try {
+                onPartial(providerId, items);
+            } catch (const std::exception& e) {
+                utils::Logger::Error("Partial result callback failed: " + std::string(e.what()));
+            }
+        };
+
         try {
             // Step 1: Check the cache first
-            auto cacheKey = fmt::format("catalog:{}:{}:{}", catalogType, filter.ToString(), page);
+            auto cacheKey = fmt::format("catalog:{}:{}:{}:{}:{}", query, catalogType, filter.ToString(), page, limit);
             if (auto cached = cache::CacheManager::Instance().Get<std::vector<domain::MediaMetadata>>(cacheKey)) {
                 utils::Logger::Info("Returning cached results for key: " + cacheKey);
-                return utils::Result<std::vector<domain::MediaMetadata>>(*cached);
+                emitPartial("cache", *cached);
+                return utils::Result<UnifiedSearchResult>(UnifiedSearchResult{std::move(*cached), {}, {}});
             }
 
-            // Step 2: Use catalog if no query is provided
-            std::vector<std::future<utils::Result<std::vector<domain::MediaMetadata>>>> futures;
-            {
-                std::lock_guard<std::mutex> lock(providerMutex_);
-                for (const auto& [id, provider] : providers_) {
-                    if (query.empty() && provider->GetCapabilities().supportsCatalog) {
-                        // Use catalog for popular movies
-                        futures.push_back(provider->GetCatalog(catalogType, filter, page));
-                    } else if (provider->GetCapabilities().supportsSearch) {
-                        // Use search if a query is provided
-                        futures.push_back(provider->SearchMedia(query, filter, page));
-                    }
-                }
+            // Step 2: Answer from the local index right away, the network results follow
+            std::vector<domain::MediaMetadata> localHits;
+            if (!query.empty()) {
+                localHits = SearchIndex::Instance().Search(query, limit ? limit : kLocalSearchHits,
+                                                           [&filter](const domain::MediaMetadata &item) { return MatchesFilter(item, filter); });
+                emitPartial("local", localHits);
             }
 
-            // Step 3: Aggregate results
-            std::vector<domain::MediaMetadata> aggregated;
-            for (auto& future : futures) {
-                try {
-                    auto result = future.get();
-                    if (result.IsOk()) {
-                        for (auto& resultItem : result.Value()) {
-                            // Normalize ratings if available
-                            if (resultItem.rating) {
-                                resultItem.normalizedRating = services::RatingNormalizer::Instance()
-                                    .NormalizeRating(resultItem.id.source, static_cast<float>(resultItem.rating));
-                            }
-                            aggregated.push_back(std::move(resultItem));
-                        }
-                    } else {
-                        utils::Logger::Error("Provider search/catalog failed: " + result.GetError().message);
+            // Step 3: Fan out to the providers that can serve this request. The snapshot keeps
+            // this request's providers alive even if a reload swaps in a new set meanwhile.
+            // A caller-supplied channel lets a newer query cancel this one.
+            if (!channel) {
+                channel = std::make_shared<ReplyChannel>();
+            } else if (channel->IsCancelled()) {
+                return utils::Result<UnifiedSearchResult>::Error("Search superseded", SearchController::kSupersededCode);
+            }
+            const ProviderSnapshot snapshot = GetProviderSnapshot();
+            std::vector<std::string> skipped;
+            auto pending = StartFanOut(snapshot, query, catalogType, filter, page, channel, started + searchDeadline_, skipped);
+
+            // Step 4: Collect each provider's page as it arrives, giving up on each provider at its deadline
+            std::vector<std::vector<domain::MediaMetadata>> streams;
+            std::vector<std::string> missing;
+            while (!pending.empty()) {
+                const auto nextDeadline = std::min_element(pending.begin(), pending.end(), [](const auto& a, const auto& b) {
+                    return a.deadline < b.deadline;
+                })->deadline;
+
+                auto reply = channel->PopUntil(nextDeadline);
+                if (!reply) {
+                    if (channel->IsCancelled()) {
+                        // Superseded: nothing is cached or completed for a query nobody waits for
+                        return utils::Result<UnifiedSearchResult>::Error("Search superseded", SearchController::kSupersededCode);
                     }
-                } catch (const std::exception& e) {
-                    utils::Logger::Error("Provider search/catalog exception: " + std::string(e.what()));
+                    const auto now = std::chrono::steady_clock::now();
+                    std::erase_if(pending, [&](const PendingReply& p) {
+                        if (p.deadline > now) {
+                            return false;
+                        }
+                        utils::Logger::Warning("Provider missed its deadline: " + p.providerId);
+                        missing.push_back(p.providerId);
+                        return true;
+                    });
+                    continue;
                 }
+
+                std::erase_if(pending, [&](const PendingReply& p) { return p.providerId == reply->providerId; });
+                std::erase(missing, reply->providerId); // Late, but still in time for this response
+                if (reply->result.IsOk()) {
+                    auto& items = reply->result.Value();
+                    NormalizeRatings(items);
+
+                    // Streaming callers see each provider's items as soon as they arrive
+                    emitPartial(reply->providerId, items);
+                    streams.push_back(std::move(items));
+                } else {
+                    utils::Logger::Error("Provider search/catalog failed: " + reply->result.GetError().message);
+                }
+            }
+
+            // Step 5: Partial pages are completed and cached in the background, from their own copy
+            if (!missing.empty()) {
+                // Stragglers get one more full budget past the request deadline before being dropped
+                CompleteInBackground(channel, missing, streams, filter, limit, cacheKey, skipped.size(),
+                                     started + searchDeadline_ + providerBudget_);
             }
 
-            // Step 4: Sort results by normalized rating
-            std::sort(aggregated.begin(), aggregated.end(), [](const auto& a, const auto& b) {
-                return a.normalizedRating > b.normalizedRating;
-            });
+            // Step 6: Merge duplicates and the provider streams into the requested order. Local hits
+            // the providers returned again are dropped, the fresh copy wins. Lookup tables and
+            // sort scratch live in a per-request arena, only the merged page is kept.
+            utils::RequestArena arena;
+            auto fetchedKey = [&arena](const domain::MediaId& id) {
+                std::pmr::string key(arena.Resource());
+                key.reserve(id.source.Get().size() + 1 + id.id.size());
+                key.append(id.source.Get()).append(1, ':').append(id.id);
+                return key;
+            };
+            std::pmr::unordered_set<std::pmr::string> fetched(arena.Resource());
+            for (const auto& stream : streams) {
+                for (const auto& item : stream) {
+                    fetched.insert(fetchedKey(item.id));
+                }
+            }
+            std::erase_if(localHits, [&](const domain::MediaMetadata& item) { return fetched.contains(fetchedKey(item.id)); });
+            // Everything sent to the page is kept, so its other fields can be fetched by id.
+            // CompleteInBackground adds only the replies that arrive after this.
+            for (const auto& stream : streams) {
+                SearchIndex::Instance().Add(stream);
+                CatalogStore::Instance().Add(stream);
+            }
+            streams.push_back(std::move(localHits));
 
-            // Step 5: Cache the results
-            cache::CacheManager::Instance().Set(cacheKey, aggregated);
+            auto merged = MergeResults(std::move(streams), filter, limit, arena.Resource());
+            if (missing.empty()) {
+                // Skipped providers are asked again once their circuit lets a request through
+                cache::CacheManager::Instance().Set(cacheKey, merged, skipped.empty() ? std::chrono::seconds(3600) : kIncompletePageTtl);
+            }
+            missing.insert(missing.end(), skipped.begin(), skipped.end());
 
-            // Step 6: Return the aggregated results
-            return utils::Result<std::vector<domain::MediaMetadata>>(aggregated);
+            // Step 7: Return the merged results, with spelling suggestions if they came up short
+            UnifiedSearchResult result{std::move(merged), std::move(missing), {}};
+            if (!query.empty() && result.items.size() < kSuggestBelow) {
+                for (auto& suggestion : SearchIndex::Instance().Suggest(query, kMaxSuggestions)) {
+                    if (suggestion.distance > 0) {
+                        result.suggestions.push_back(std::move(suggestion.title));
+                    }
+                }
+            }
+            return utils::Result<UnifiedSearchResult>(std::move(result));
         } catch (const std::exception& e) {
             utils::Logger::Error("UnifiedSearch exception: " + std::string(e.what()));
-            return utils::Result<std::vector<domain::MediaMetadata>>(
-                utils::Result<std::vector<domain::MediaMetadata>>::Error(e.what())
+            return utils::Result<UnifiedSearchResult>(
+                utils::Result<UnifiedSearchResult>::Error(e.what())
             );
-        } });
+        }
+    }
+
+    void MediaService::CompleteInBackground(std::shared_ptr<ReplyChannel> channel,
+                                            std::vector<std::string> missingProviders,
+                                            std::vector<std::vector<domain::MediaMetadata>> streams,
+                                            MediaFilter filter,
+                                            size_t limit,
+                                            std::string cacheKey,
+                                            size_t skippedProviders,
+                                            std::chrono::steady_clock::time_point giveUpAt)
+    {
+        {
+            std::lock_guard<std::mutex> lock(backgroundMutex_);
+            if (backgroundClosed_) {
+                return; // Shutting down
+            }
+            background_.push_back(channel);
+        }
+
+        std::thread([this, channel = std::move(channel), missing = std::move(missingProviders), streams = std::move(streams),
+                     filter = std::move(filter), limit, cacheKey = std::move(cacheKey), skippedProviders, giveUpAt]() mutable
+                    {
+            try {
+                // The streams the request already had are indexed by it, only late ones are new
+                const size_t early = streams.size();
+                while (!missing.empty()) {
+                    auto reply = channel->PopUntil(giveUpAt);
+                    if (!reply) {
+                        break;
+                    }
+
+                    std::erase(missing, reply->providerId);
+                    if (reply->result.IsOk()) {
+                        auto& items = reply->result.Value();
+                        NormalizeRatings(items);
+                        streams.push_back(std::move(items));
+                    }
+                }
+
+                for (size_t i = early; i < streams.size(); ++i) {
+                    SearchIndex::Instance().Add(streams[i]);
+                    CatalogStore::Instance().Add(streams[i]);
+                }
+
+                utils::RequestArena arena;
+                auto merged = MergeResults(std::move(streams), filter, limit, arena.Resource());
+
+                // If someone is still missing, keep the page only briefly so it gets retried soon
+                const size_t stillMissing = missing.size() + skippedProviders;
+                const auto ttl = stillMissing == 0 ? std::chrono::seconds(3600) : kIncompletePageTtl;
+                cache::CacheManager::Instance().Set(cacheKey, merged, ttl);
+                utils::Logger::Info(fmt::format("Cached late results for {} ({} provider(s) never answered, {} skipped)",
+                                                cacheKey, missing.size(), skippedProviders));
+                ServiceEvents::Instance().cacheRefreshed.Post(CacheRefreshed{cacheKey, merged.size(), stillMissing}, cacheKey);
+            } catch (const std::exception& e) {
+                utils::Logger::Error("Background result completion failed: " + std::string(e.what()));
+            }
+
+            std::lock_guard<std::mutex> lock(backgroundMutex_);
+            std::erase(background_, channel);
+            backgroundDone_.notify_all(); })
+            .detach();
     }
-} // namespace app::services
\ No newline at end of file
+} // namespace app::services
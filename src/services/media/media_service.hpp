@@ -1,23 +1,53 @@
-
-
 #pragma once
 #include "domain/models/media_types.hpp"
 #include "core/utils/result.hpp"
+#include <atomic>
+#include <functional>
 #include <future>
 #include <memory>
+#include <memory_resource>
 #include <vector>
 #include <unordered_map>
 #include <mutex>
+#include <condition_variable>
 #include "services/media/IMediaProvider.hpp"
+#include "services/media/provider_routing.hpp"
+#include "services/media/provider_health.hpp"
+#include "services/media/reply_channel.hpp"
+#include "services/media/search_controller.hpp"
 
 namespace app::services
 {
     class IMediaProvider;
+    class ProviderWatcher;
+
+    // Immutable set of registered providers. Every change publishes a new set, so
+    // readers never lock and keep using the set they loaded until they drop it.
+    struct ProviderSet
+    {
+        std::unordered_map<std::string, std::shared_ptr<IMediaProvider>> providers;
+        ProviderRoutingIndex routing; // Rebuilt whenever the set is published
+    };
+    using ProviderSnapshot = std::shared_ptr<const ProviderSet>;
+
+    struct UnifiedSearchResult
+    {
+        std::vector<domain::MediaMetadata> items;
+        // Providers that had not answered when the deadline passed, or were skipped because
+        // their circuit is open. Late results are merged into the cache in the background,
+        // and a page missing anyone is only cached briefly, so a retry will be complete.
+        std::vector<std::string> missingProviders;
+        // Known titles close to a query that found little, e.g. "godfater" -> "The Godfather"
+        std::vector<std::string> suggestions;
+
+        bool IsPartial() const { return !missingProviders.empty(); }
+    };
 
     class MediaService
     {
     public:
         static MediaService &Instance();
+        ~MediaService();
 
         // Lifecycle management
         void Shutdown();
@@ -25,18 +55,94 @@ namespace app::services
 
         // Provider management
         void RegisterProvider(const std::string &providerId, std::unique_ptr<IMediaProvider> provider);
+        void UnregisterProvider(const std::string &providerId);
+        void ReplaceProviders(std::unordered_map<std::string, std::shared_ptr<IMediaProvider>> providers);
+        void UpdateProviders(std::unordered_map<std::string, std::shared_ptr<IMediaProvider>> upserts,
+                             const std::vector<std::string> &removals);
+        ProviderSnapshot GetProviderSnapshot() const;
         bool SetActiveProvider(const std::string &providerId);
         std::vector<std::string> GetAvailableProviders() const;
+        std::vector<ProviderHealthSnapshot> GetProviderHealth();
 
         // Core functionality
-        std::future<utils::Result<std::vector<domain::MediaMetadata>>>
-        UnifiedSearch(const std::string &query, const std::string &catalogType, const MediaFilter &filter, int page);
+        // Results come back in filter.sortBy/sortDesc order. A non-zero limit keeps only the top items.
+        std::future<utils::Result<UnifiedSearchResult>>
+        UnifiedSearch(const std::string &query, const std::string &catalogType, const MediaFilter &filter, int page,
+                      size_t limit = 0);
+
+        // Same as UnifiedSearch, but hands each provider's normalized items to onPartial as soon
+        // as they arrive. The returned future resolves to the merged, ordered page.
+        using PartialResultCallback = std::function<void(const std::string &providerId,
+                                                         const std::vector<domain::MediaMetadata> &items)>;
+        std::future<utils::Result<UnifiedSearchResult>>
+        UnifiedSearchStreaming(const std::string &query, const std::string &catalogType, const MediaFilter &filter, int page,
+                               PartialResultCallback onPartial, size_t limit = 0);
+
+        // Search-as-you-type: each submit supersedes the session's previous query, see SearchController
+        void SubmitSearch(const std::string &sessionId, SearchRequest request,
+                          SearchController::PartialCallback onPartial, SearchController::CompleteCallback onComplete);
+        void CancelSearch(const std::string &sessionId);
+        // For the owner of the callbacks going away: returns once no search can call them any more
+        void CancelAllSearches();
 
     private:
-        MediaService() = default;
+        MediaService();
+
+        struct PendingReply
+        {
+            std::string providerId;
+            std::chrono::steady_clock::time_point deadline;
+        };
+
+        void PublishProviders(std::shared_ptr<ProviderSet> next);
+        utils::Result<UnifiedSearchResult>
+        RunSearch(const std::string &query, const std::string &catalogType, const MediaFilter &filter, int page,
+                  size_t limit, const PartialResultCallback &onPartial, std::shared_ptr<ReplyChannel> channel = nullptr);
+        std::vector<PendingReply> StartFanOut(const ProviderSnapshot &snapshot,
+                                              const std::string &query,
+                                              const std::string &catalogType,
+                                              const MediaFilter &filter,
+                                              int page,
+                                              const std::shared_ptr<ReplyChannel> &channel,
+                                              std::chrono::steady_clock::time_point overallDeadline,
+                                              std::vector<std::string> &skipped);
+        void CompleteInBackground(std::shared_ptr<ReplyChannel> channel,
+                                  std::vector<std::string> missingProviders,
+                                  std::vector<std::vector<domain::MediaMetadata>> streams,
+                                  MediaFilter filter,
+                                  size_t limit,
+                                  std::string cacheKey,
+                                  size_t skippedProviders,
+                                  std::chrono::steady_clock::time_point giveUpAt);
+        static void NormalizeRatings(std::vector<domain::MediaMetadata> &items);
+        static std::string SearchIndexPath();
+        static bool MatchesFilter(const domain::MediaMetadata &item, const MediaFilter &filter);
+        static std::vector<domain::MediaMetadata> MergeResults(std::vector<std::vector<domain::MediaMetadata>> streams,
+                                                               const MediaFilter &filter, size_t limit,
+                                                               std::pmr::memory_resource *scratch);
+
+        static constexpr size_t kLocalSearchHits = 20; // Local hits shown while providers are queried
+        static constexpr size_t kSuggestBelow = 5;     // Offer "did you mean" when a search finds fewer items
+        static constexpr size_t kMaxSuggestions = 3;
+        static constexpr std::chrono::seconds kIncompletePageTtl{60}; // Cache time of a page missing a provider
 
         bool initialized_ = false;
-        std::unordered_map<std::string, std::unique_ptr<IMediaProvider>> providers_;
-        std::mutex providerMutex_;
+        std::atomic<ProviderSnapshot> providers_;
+        std::mutex providerWriteMutex_; // Serializes writers only, readers never take it
+        std::unique_ptr<ProviderWatcher> providerWatcher_;
+
+        ProviderHealthRegistry health_;
+        // Overridable through the search.* config keys
+        std::chrono::milliseconds searchDeadline_{5000};    // Overall deadline for one request
+        std::chrono::milliseconds providerBudget_{4000};    // Deadline for a healthy provider
+        std::chrono::milliseconds minProviderBudget_{1000}; // Floor for the slowest providers
+        std::unique_ptr<SearchController> searchController_;
+
+        // Channels of the CompleteInBackground threads still running, cancelled and drained
+        // by Shutdown before the singletons they use are saved or torn down
+        std::mutex backgroundMutex_;
+        std::condition_variable backgroundDone_;
+        std::vector<std::shared_ptr<ReplyChannel>> background_;
+        bool backgroundClosed_ = false;
     };
-} // namespace app::services
\ No newline at end of file
+} // namespace app::services
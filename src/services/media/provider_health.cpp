@@ -0,0 +1,214 @@
+#include "provider_health.hpp"
+#include "service_events.hpp"
+#include "core/utils/logger.hpp"
+#include <algorithm>
+#include <fmt/format.h>
+
+namespace app::services
+{
+    const char *ToString(CircuitState state)
+    {
+        switch (state)
+        {
+        case CircuitState::Closed:
+            return "closed";
+        case CircuitState::Open:
+            return "open";
+        case CircuitState::HalfOpen:
+            return "half-open";
+        default:
+            return "unknown";
+        }
+    }
+
+    ProviderHealth::ProviderHealth(std::string providerId)
+        : providerId_(std::move(providerId)) {}
+
+    bool ProviderHealth::AllowRequest(Clock::time_point now)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        switch (state_)
+        {
+        case CircuitState::Closed:
+            return true;
+        case CircuitState::Open:
+            if (now - openedAt_ < cooldown_)
+            {
+                return false;
+            }
+            TransitionLocked(CircuitState::HalfOpen);
+            probeInFlight_ = true;
+            probeStartedAt_ = now;
+            return true;
+        case CircuitState::HalfOpen:
+            // Only one probe at a time, unless the last one never came back
+            if (probeInFlight_ && now - probeStartedAt_ < kMaxCooldown)
+            {
+                return false;
+            }
+            probeInFlight_ = true;
+            probeStartedAt_ = now;
+            return true;
+        }
+        return true;
+    }
+
+    void ProviderHealth::Record(std::chrono::milliseconds latency, bool success, Clock::time_point now)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        samples_[nextSample_] = {static_cast<uint32_t>(std::max<int64_t>(latency.count(), 0)), success};
+        nextSample_ = (nextSample_ + 1) % kWindowSize;
+        sampleCount_ = std::min(sampleCount_ + 1, kWindowSize);
+        consecutiveFailures_ = success ? 0 : consecutiveFailures_ + 1;
+
+        if (state_ == CircuitState::HalfOpen)
+        {
+            probeInFlight_ = false;
+            if (success)
+            {
+                cooldown_ = kInitialCooldown;
+                TransitionLocked(CircuitState::Closed);
+            }
+            else
+            {
+                // Back off further every time a probe fails
+                cooldown_ = std::min(cooldown_ * 2, kMaxCooldown);
+                openedAt_ = now;
+                TransitionLocked(CircuitState::Open);
+            }
+            return;
+        }
+
+        if (state_ == CircuitState::Closed &&
+            (consecutiveFailures_ >= kTripConsecutiveFailures ||
+             (sampleCount_ >= kMinSamples && ErrorRateLocked() >= kTripErrorRate)))
+        {
+            openedAt_ = now;
+            TransitionLocked(CircuitState::Open);
+        }
+    }
+
+    std::chrono::milliseconds ProviderHealth::Budget(std::chrono::milliseconds defaultBudget,
+                                                     std::chrono::milliseconds minBudget) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return BudgetLocked(defaultBudget, minBudget);
+    }
+
+    std::chrono::milliseconds ProviderHealth::BudgetLocked(std::chrono::milliseconds defaultBudget,
+                                                           std::chrono::milliseconds minBudget) const
+    {
+        if (state_ != CircuitState::Closed || sampleCount_ < kMinSamples || defaultBudget <= minBudget)
+        {
+            return defaultBudget;
+        }
+
+        // Providers whose p95 stays under a quarter of the budget keep all of it; beyond
+        // that the budget shrinks linearly, reaching minBudget once p95 hits the budget.
+        const auto p95 = PercentileLocked(0.95f);
+        const auto fastEnough = defaultBudget / 4;
+        if (p95 <= fastEnough)
+        {
+            return defaultBudget;
+        }
+
+        const float slowness = std::min(1.0f, static_cast<float>((p95 - fastEnough).count()) /
+                                                  static_cast<float>((defaultBudget - fastEnough).count()));
+        const auto cut = std::chrono::milliseconds(
+            static_cast<int64_t>(slowness * static_cast<float>((defaultBudget - minBudget).count())));
+        return defaultBudget - cut;
+    }
+
+    CircuitState ProviderHealth::State() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return state_;
+    }
+
+    ProviderHealthSnapshot ProviderHealth::Snapshot(std::chrono::milliseconds defaultBudget,
+                                                    std::chrono::milliseconds minBudget) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ProviderHealthSnapshot snapshot;
+        snapshot.providerId = providerId_;
+        snapshot.state = state_;
+        snapshot.samples = sampleCount_;
+        snapshot.errorRate = ErrorRateLocked();
+        snapshot.p50 = PercentileLocked(0.50f);
+        snapshot.p95 = PercentileLocked(0.95f);
+        snapshot.p99 = PercentileLocked(0.99f);
+        snapshot.budget = BudgetLocked(defaultBudget, minBudget);
+        snapshot.consecutiveFailures = consecutiveFailures_;
+        return snapshot;
+    }
+
+    std::chrono::milliseconds ProviderHealth::PercentileLocked(float percentile) const
+    {
+        if (sampleCount_ == 0)
+        {
+            return std::chrono::milliseconds(0);
+        }
+
+        std::array<uint32_t, kWindowSize> latencies;
+        for (size_t i = 0; i < sampleCount_; ++i)
+        {
+            latencies[i] = samples_[i].latencyMs;
+        }
+
+        const size_t rank = std::min(sampleCount_ - 1, static_cast<size_t>(percentile * static_cast<float>(sampleCount_)));
+        std::nth_element(latencies.begin(), latencies.begin() + rank, latencies.begin() + sampleCount_);
+        return std::chrono::milliseconds(latencies[rank]);
+    }
+
+    float ProviderHealth::ErrorRateLocked() const
+    {
+        if (sampleCount_ == 0)
+        {
+            return 0.0f;
+        }
+
+        size_t failures = 0;
+        for (size_t i = 0; i < sampleCount_; ++i)
+        {
+            failures += samples_[i].success ? 0 : 1;
+        }
+        return static_cast<float>(failures) / static_cast<float>(sampleCount_);
+    }
+
+    void ProviderHealth::TransitionLocked(CircuitState next)
+    {
+        if (state_ == next)
+        {
+            return;
+        }
+
+        utils::Logger::Warning(fmt::format("Provider {} circuit {} -> {}", providerId_, ToString(state_), ToString(next)));
+        state_ = next;
+        ServiceEvents::Instance().providerState.Post(ProviderStateChanged{providerId_, next}, providerId_);
+    }
+
+    std::shared_ptr<ProviderHealth> ProviderHealthRegistry::Get(const std::string &providerId)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto &health = providers_[providerId];
+        if (!health)
+        {
+            health = std::make_shared<ProviderHealth>(providerId);
+        }
+        return health;
+    }
+
+    std::vector<ProviderHealthSnapshot> ProviderHealthRegistry::SnapshotAll(const std::vector<std::string> &providerIds,
+                                                                            std::chrono::milliseconds defaultBudget,
+                                                                            std::chrono::milliseconds minBudget)
+    {
+        std::vector<ProviderHealthSnapshot> snapshots;
+        snapshots.reserve(providerIds.size());
+        for (const auto &providerId : providerIds)
+        {
+            snapshots.push_back(Get(providerId)->Snapshot(defaultBudget, minBudget));
+        }
+        return snapshots;
+    }
+} // namespace app::services
@@ -0,0 +1,104 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace app::services
+{
+    enum class CircuitState
+    {
+        Closed,  // Healthy, requests flow normally
+        Open,    // Failing, excluded from fan-out until the cooldown ends
+        HalfOpen // Cooldown over, a single probe request decides what happens next
+    };
+
+    const char *ToString(CircuitState state);
+
+    struct ProviderHealthSnapshot
+    {
+        std::string providerId;
+        CircuitState state = CircuitState::Closed;
+        size_t samples = 0;
+        float errorRate = 0.0f;
+        std::chrono::milliseconds p50{0};
+        std::chrono::milliseconds p95{0};
+        std::chrono::milliseconds p99{0};
+        std::chrono::milliseconds budget{0};
+        uint32_t consecutiveFailures = 0;
+    };
+
+    // Sliding window of the last requests to one provider plus its circuit breaker.
+    class ProviderHealth
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr size_t kWindowSize = 64;
+        static constexpr size_t kMinSamples = 10;
+        static constexpr float kTripErrorRate = 0.5f;
+        static constexpr uint32_t kTripConsecutiveFailures = 5;
+        static constexpr std::chrono::milliseconds kInitialCooldown{5000};
+        static constexpr std::chrono::milliseconds kMaxCooldown{60000};
+
+        explicit ProviderHealth(std::string providerId);
+
+        // Whether the provider should be part of this fan-out. In the half-open state
+        // exactly one caller is let through as the probe.
+        bool AllowRequest(Clock::time_point now = Clock::now());
+
+        void Record(std::chrono::milliseconds latency, bool success, Clock::time_point now = Clock::now());
+
+        // Slow providers get a shorter deadline so they cannot hold up the response.
+        // Probes always get the full budget so a recovered provider can prove itself.
+        std::chrono::milliseconds Budget(std::chrono::milliseconds defaultBudget,
+                                         std::chrono::milliseconds minBudget) const;
+
+        CircuitState State() const;
+        ProviderHealthSnapshot Snapshot(std::chrono::milliseconds defaultBudget,
+                                        std::chrono::milliseconds minBudget) const;
+
+    private:
+        struct Sample
+        {
+            uint32_t latencyMs;
+            bool success;
+        };
+
+        std::chrono::milliseconds PercentileLocked(float percentile) const;
+        float ErrorRateLocked() const;
+        std::chrono::milliseconds BudgetLocked(std::chrono::milliseconds defaultBudget,
+                                               std::chrono::milliseconds minBudget) const;
+        void TransitionLocked(CircuitState next);
+
+        std::string providerId_;
+        mutable std::mutex mutex_;
+        std::array<Sample, kWindowSize> samples_{};
+        size_t sampleCount_ = 0;
+        size_t nextSample_ = 0;
+
+        CircuitState state_ = CircuitState::Closed;
+        uint32_t consecutiveFailures_ = 0;
+        Clock::time_point openedAt_{};
+        std::chrono::milliseconds cooldown_ = kInitialCooldown;
+        bool probeInFlight_ = false;
+        Clock::time_point probeStartedAt_{};
+    };
+
+    class ProviderHealthRegistry
+    {
+    public:
+        std::shared_ptr<ProviderHealth> Get(const std::string &providerId);
+        std::vector<ProviderHealthSnapshot> SnapshotAll(const std::vector<std::string> &providerIds,
+                                                        std::chrono::milliseconds defaultBudget,
+                                                        std::chrono::milliseconds minBudget);
+
+    private:
+        std::mutex mutex_;
+        std::unordered_map<std::string, std::shared_ptr<ProviderHealth>> providers_;
+    };
+} // namespace app::services
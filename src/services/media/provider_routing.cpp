@@ -0,0 +1,94 @@
+#include "provider_routing.hpp"
+#include "core/utils/logger.hpp"
+#include <algorithm>
+#include <cctype>
+#include <fmt/format.h>
+
+namespace app::services
+{
+    namespace
+    {
+        std::string NormalizeKey(const std::string &value)
+        {
+            std::string key = value;
+            std::transform(key.begin(), key.end(), key.begin(),
+                           [](unsigned char c)
+                           { return static_cast<char>(std::tolower(c)); });
+
+            // Providers and the UI disagree on what to call TV content
+            if (key == "tv" || key == "show" || key == "tvshow")
+            {
+                return "series";
+            }
+            return key;
+        }
+    }
+
+    void ProviderRoutingIndex::Dimension::Add(size_t slot, const std::vector<std::string> &values)
+    {
+        if (values.empty())
+        {
+            unrestricted.set(slot);
+            return;
+        }
+
+        for (const auto &value : values)
+        {
+            byValue[NormalizeKey(value)].set(slot);
+        }
+    }
+
+    ProviderMask ProviderRoutingIndex::Dimension::Lookup(const std::string &value) const
+    {
+        auto it = byValue.find(NormalizeKey(value));
+        return it != byValue.end() ? (it->second | unrestricted) : unrestricted;
+    }
+
+    void ProviderRoutingIndex::Build(const std::unordered_map<std::string, std::shared_ptr<IMediaProvider>> &providers)
+    {
+        *this = ProviderRoutingIndex{};
+        routes_.reserve(std::min(providers.size(), kMaxRoutedProviders));
+
+        for (const auto &[providerId, provider] : providers)
+        {
+            if (routes_.size() == kMaxRoutedProviders)
+            {
+                utils::Logger::Warning(fmt::format("More than {} providers registered, ignoring {}", kMaxRoutedProviders, providerId));
+                continue;
+            }
+
+            const size_t slot = routes_.size();
+            routes_.push_back({providerId, provider, slot});
+
+            const auto capabilities = provider->GetCapabilities();
+            search_.set(slot, capabilities.supportsSearch);
+            catalog_.set(slot, capabilities.supportsCatalog);
+            catalogs_.Add(slot, capabilities.supportedCatalogs);
+            types_.Add(slot, capabilities.supportedTypes);
+            genres_.Add(slot, capabilities.supportedGenres);
+            sortOptions_.Add(slot, capabilities.supportedSortOptions);
+        }
+    }
+
+    ProviderMask ProviderRoutingIndex::Select(const std::string &query, const std::string &catalogType, const MediaFilter &filter) const
+    {
+        ProviderMask mask = query.empty() ? (catalog_ & catalogs_.Lookup(catalogType)) : search_;
+
+        if (filter.type)
+        {
+            mask &= types_.Lookup(*filter.type);
+        }
+        if (filter.genre)
+        {
+            mask &= genres_.Lookup(*filter.genre);
+        }
+
+        // Sorting can always be done locally, so filter.sortBy does not narrow the selection
+        return mask;
+    }
+
+    ProviderMask ProviderRoutingIndex::SortsNatively(const std::string &sortBy) const
+    {
+        return sortOptions_.Lookup(sortBy);
+    }
+} // namespace app::services
@@ -0,0 +1,69 @@
+#pragma once
+#include "services/media/IMediaProvider.hpp"
+#include <bitset>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace app::services
+{
+    constexpr size_t kMaxRoutedProviders = 64;
+    using ProviderMask = std::bitset<kMaxRoutedProviders>;
+
+    // Maps catalog type, media type, genre and sort option to the providers that can
+    // serve them. Built once per published provider set, so routing a request is a few
+    // bitset ANDs and never calls GetCapabilities() or copies capability vectors.
+    class ProviderRoutingIndex
+    {
+    public:
+        struct Route
+        {
+            std::string providerId;
+            std::shared_ptr<IMediaProvider> provider;
+            size_t slot = 0; // Its bit in a ProviderMask
+        };
+
+        void Build(const std::unordered_map<std::string, std::shared_ptr<IMediaProvider>> &providers);
+
+        ProviderMask Select(const std::string &query, const std::string &catalogType, const MediaFilter &filter) const;
+
+        // Providers that can be asked for this order. The others are asked for their
+        // default order and sorted locally; a sort option never removes a provider.
+        ProviderMask SortsNatively(const std::string &sortBy) const;
+
+        size_t Size() const { return routes_.size(); }
+        const Route &At(size_t slot) const { return routes_[slot]; }
+
+        template <typename Fn>
+        void ForEach(const ProviderMask &mask, Fn &&fn) const
+        {
+            for (size_t slot = 0; slot < routes_.size(); ++slot)
+            {
+                if (mask.test(slot))
+                {
+                    fn(routes_[slot]);
+                }
+            }
+        }
+
+    private:
+        // A provider that lists nothing for a dimension is assumed to accept any value
+        struct Dimension
+        {
+            std::unordered_map<std::string, ProviderMask> byValue;
+            ProviderMask unrestricted;
+
+            void Add(size_t slot, const std::vector<std::string> &values);
+            ProviderMask Lookup(const std::string &value) const;
+        };
+
+        std::vector<Route> routes_;
+        ProviderMask search_;
+        ProviderMask catalog_;
+        Dimension catalogs_;
+        Dimension types_;
+        Dimension genres_;
+        Dimension sortOptions_;
+    };
+} // namespace app::services
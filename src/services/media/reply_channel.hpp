@@ -0,0 +1,72 @@
+#pragma once
+#include "domain/models/media_types.hpp"
+#include "core/utils/result.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace app::services
+{
+    struct ProviderReply
+    {
+        std::string providerId;
+        utils::Result<std::vector<domain::MediaMetadata>> result;
+        std::chrono::milliseconds latency;
+    };
+
+    // Provider replies in completion order. Provider threads push, the request pops with
+    // a deadline, so one slow provider never blocks the replies queued behind it.
+    // Cancelling wakes the request up so a superseded search stops waiting right away.
+    class ReplyChannel
+    {
+    public:
+        void Push(ProviderReply reply)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                replies_.push_back(std::move(reply));
+            }
+            ready_.notify_one();
+        }
+
+        std::optional<ProviderReply> PopUntil(std::chrono::steady_clock::time_point deadline)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (!ready_.wait_until(lock, deadline, [this]
+                                   { return !replies_.empty() || cancelled_; }) ||
+                cancelled_)
+            {
+                return std::nullopt;
+            }
+
+            ProviderReply reply = std::move(replies_.front());
+            replies_.pop_front();
+            return reply;
+        }
+
+        void Cancel()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                cancelled_ = true;
+            }
+            ready_.notify_all();
+        }
+
+        bool IsCancelled()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return cancelled_;
+        }
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable ready_;
+        std::deque<ProviderReply> replies_;
+        bool cancelled_ = false;
+    };
+} // namespace app::services
@@ -0,0 +1,271 @@
+#include "result_merger.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <chrono>
+#include <queue>
+#include <string_view>
+#include <tuple>
+
+namespace app::services
+{
+    namespace
+    {
+        // IEEE 754 floats as unsigned integers with the same ordering
+        uint32_t OrderedBits(float value)
+        {
+            const auto bits = std::bit_cast<uint32_t>(value);
+            return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+        }
+
+        uint32_t OrderedDays(const std::chrono::system_clock::time_point &date)
+        {
+            const auto days = std::chrono::floor<std::chrono::days>(date).time_since_epoch().count();
+            return static_cast<uint32_t>(static_cast<int64_t>(days) + 0x80000000ll);
+        }
+
+        // First eight lowercased title bytes, big-endian, so integer order is byte order
+        uint64_t TitlePrefix(std::string_view title)
+        {
+            uint64_t prefix = 0;
+            size_t taken = 0;
+            for (size_t i = 0; i < title.size() && taken < 8; ++i, ++taken)
+            {
+                prefix = (prefix << 8) | static_cast<unsigned char>(std::tolower(static_cast<unsigned char>(title[i])));
+            }
+            return prefix << (8 * (8 - taken));
+        }
+
+        // Negative, zero or positive as a sorts before, with or after b, ignoring ASCII case
+        // like TitlePrefix does
+        int CompareTitles(std::string_view a, std::string_view b)
+        {
+            const size_t common = std::min(a.size(), b.size());
+            for (size_t i = 0; i < common; ++i)
+            {
+                const int x = std::tolower(static_cast<unsigned char>(a[i]));
+                const int y = std::tolower(static_cast<unsigned char>(b[i]));
+                if (x != y)
+                {
+                    return x - y;
+                }
+            }
+            return a.size() < b.size() ? -1 : (a.size() > b.size() ? 1 : 0);
+        }
+
+        std::string ToLower(std::string value)
+        {
+            std::transform(value.begin(), value.end(), value.begin(),
+                           [](unsigned char c)
+                           { return static_cast<char>(std::tolower(c)); });
+            return value;
+        }
+    }
+
+    SortOrder ParseSortOrder(const std::optional<std::string> &sortBy, const std::optional<bool> &sortDesc)
+    {
+        SortOrder order;
+        std::string name = sortBy ? ToLower(*sortBy) : "popularity";
+
+        // "popularity.desc" carries its own direction
+        std::optional<bool> suffixDesc;
+        if (const auto dot = name.rfind('.'); dot != std::string::npos)
+        {
+            const auto suffix = name.substr(dot + 1);
+            if (suffix == "desc" || suffix == "asc")
+            {
+                suffixDesc = suffix == "desc";
+                name.resize(dot);
+            }
+        }
+
+        if (name == "rating" || name == "vote_average" || name == "normalizedrating")
+        {
+            order.field = SortField::Rating;
+        }
+        else if (name == "year" || name == "date" || name == "release_date" ||
+                 name == "primary_release_date" || name == "first_air_date")
+        {
+            order.field = SortField::ReleaseDate;
+        }
+        else if (name == "title" || name == "name" || name == "original_title")
+        {
+            order.field = SortField::Title;
+        }
+        else
+        {
+            order.field = SortField::Popularity;
+        }
+
+        // Titles read naturally A-Z, everything else best-first
+        order.descending = sortDesc.value_or(suffixDesc.value_or(order.field != SortField::Title));
+        return order;
+    }
+
+    ResultMerger::ResultMerger(SortOrder order, size_t limit, std::pmr::memory_resource *scratch)
+        : order_(order), limit_(limit), scratch_(scratch), streams_(scratch) {}
+
+    uint64_t ResultMerger::SortKey(const domain::MediaMetadata &item, SortOrder order)
+    {
+        // The primary field takes the high 32 bits (all 64 for titles); the low bits break
+        // ties best-first, by rating for popularity and by popularity otherwise
+        uint64_t key = 0;
+        switch (order.field)
+        {
+        case SortField::Popularity:
+            key = (uint64_t{OrderedBits(item.popularity)} << 32) | OrderedBits(item.normalizedRating);
+            break;
+        case SortField::Rating:
+            key = (uint64_t{OrderedBits(item.normalizedRating)} << 32) | OrderedBits(item.popularity);
+            break;
+        case SortField::ReleaseDate:
+            key = (uint64_t{OrderedDays(item.releaseDate)} << 32) | OrderedBits(item.popularity);
+            break;
+        case SortField::Title:
+            key = TitlePrefix(item.title);
+            break;
+        }
+
+        // Smallest key comes first
+        return order.descending ? ~key : key;
+    }
+
+    bool ResultMerger::Before(uint64_t aKey, const domain::MediaMetadata &a, uint64_t bKey, const domain::MediaMetadata &b,
+                              SortOrder order)
+    {
+        if (aKey != bKey || order.field != SortField::Title)
+        {
+            return aKey < bKey;
+        }
+        const int compared = CompareTitles(a.title, b.title);
+        return order.descending ? compared > 0 : compared < 0;
+    }
+
+    void ResultMerger::AddStream(std::vector<domain::MediaMetadata> items)
+    {
+        if (items.empty())
+        {
+            return;
+        }
+
+        Stream stream{{}, std::pmr::vector<Keyed>(scratch_)};
+        stream.order.reserve(items.size());
+        for (size_t i = 0; i < items.size(); ++i)
+        {
+            stream.order.push_back({SortKey(items[i], order_), static_cast<uint32_t>(i)});
+        }
+
+        if (!std::is_sorted(stream.order.begin(), stream.order.end(), [](const Keyed &a, const Keyed &b)
+                            { return a.key < b.key; }))
+        {
+            RadixSort(stream.order);
+        }
+
+        total_ += items.size();
+        stream.items = std::move(items);
+        if (order_.field == SortField::Title)
+        {
+            SortEqualTitles(stream);
+        }
+        streams_.push_back(std::move(stream));
+    }
+
+    void ResultMerger::SortEqualTitles(Stream &stream) const
+    {
+        // Runs of equal keys are short, e.g. a series and its sequels
+        auto run = stream.order.begin();
+        while (run != stream.order.end())
+        {
+            const auto end = std::find_if(run, stream.order.end(), [&](const Keyed &k)
+                                          { return k.key != run->key; });
+            if (end - run > 1)
+            {
+                std::stable_sort(run, end, [&](const Keyed &a, const Keyed &b)
+                                 { return Before(a.key, stream.items[a.index], b.key, stream.items[b.index], order_); });
+            }
+            run = end;
+        }
+    }
+
+    void ResultMerger::RadixSort(std::pmr::vector<Keyed> &keys) const
+    {
+        // LSD radix sort, one byte per pass, stable. Passes where every key shares the
+        // same byte are skipped, which is most of them for small pages.
+        std::pmr::vector<Keyed> scratch(keys.size(), scratch_);
+        for (int shift = 0; shift < 64; shift += 8)
+        {
+            std::array<uint32_t, 256> counts{};
+            for (const auto &k : keys)
+            {
+                ++counts[(k.key >> shift) & 0xff];
+            }
+            if (counts[(keys.front().key >> shift) & 0xff] == keys.size())
+            {
+                continue;
+            }
+
+            uint32_t offset = 0;
+            for (auto &count : counts)
+            {
+                const uint32_t c = count;
+                count = offset;
+                offset += c;
+            }
+            for (const auto &k : keys)
+            {
+                scratch[counts[(k.key >> shift) & 0xff]++] = k;
+            }
+            keys.swap(scratch);
+        }
+    }
+
+    std::vector<domain::MediaMetadata> ResultMerger::Take()
+    {
+        const size_t wanted = limit_ ? std::min(limit_, total_) : total_;
+        std::vector<domain::MediaMetadata> merged;
+        merged.reserve(wanted);
+
+        // (key, stream, position). Ties go to the earlier stream, so the merge is deterministic.
+        using Cursor = std::tuple<uint64_t, uint32_t, uint32_t>;
+        const auto itemAt = [this](const Cursor &c) -> const domain::MediaMetadata &
+        {
+            const auto &stream = streams_[std::get<1>(c)];
+            return stream.items[stream.order[std::get<2>(c)].index];
+        };
+        const auto after = [&](const Cursor &a, const Cursor &b)
+        {
+            if (Before(std::get<0>(a), itemAt(a), std::get<0>(b), itemAt(b), order_))
+            {
+                return false;
+            }
+            if (Before(std::get<0>(b), itemAt(b), std::get<0>(a), itemAt(a), order_))
+            {
+                return true;
+            }
+            return a > b;
+        };
+        std::priority_queue<Cursor, std::pmr::vector<Cursor>, decltype(after)> heap{after, std::pmr::vector<Cursor>(scratch_)};
+        for (uint32_t s = 0; s < streams_.size(); ++s)
+        {
+            heap.emplace(streams_[s].order.front().key, s, 0);
+        }
+
+        while (merged.size() < wanted)
+        {
+            const auto [key, s, pos] = heap.top();
+            heap.pop();
+
+            auto &stream = streams_[s];
+            merged.push_back(std::move(stream.items[stream.order[pos].index]));
+            if (pos + 1 < stream.order.size())
+            {
+                heap.emplace(stream.order[pos + 1].key, s, pos + 1);
+            }
+        }
+
+        streams_.clear();
+        total_ = 0;
+        return merged;
+    }
+} // namespace app::services
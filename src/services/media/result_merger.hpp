@@ -0,0 +1,78 @@
+#pragma once
+#include "domain/models/media_types.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace app::services
+{
+    enum class SortField
+    {
+        Popularity,
+        Rating, // normalizedRating, comparable across providers
+        ReleaseDate,
+        Title
+    };
+
+    struct SortOrder
+    {
+        SortField field = SortField::Popularity;
+        bool descending = true;
+    };
+
+    // Maps MediaFilter::sortBy/sortDesc onto a sort order. Accepts the names the UI and
+    // the manifests use ("popularity", "rating", "vote_average", "year", "release_date",
+    // "title", ...) as well as TMDB style "popularity.desc".
+    SortOrder ParseSortOrder(const std::optional<std::string> &sortBy, const std::optional<bool> &sortDesc);
+
+    // Merges per-provider result streams into one ordered page.
+    //
+    // Every item gets a 64-bit key whose unsigned order is the requested order, so items
+    // are compared with a single integer compare. Streams that are already in order (the
+    // common case, providers sort server-side) are used as-is, the rest are radix sorted.
+    // The streams are then k-way merged and only the first `limit` items are moved out.
+    // A title key only holds the first eight bytes, so titles with equal keys are ordered
+    // by the whole title (see Before).
+    // Keys, sort scratch and the merge heap come from `scratch`, which must outlive the merger.
+    class ResultMerger
+    {
+    public:
+        explicit ResultMerger(SortOrder order, size_t limit = 0, // 0 keeps every item
+                              std::pmr::memory_resource *scratch = std::pmr::get_default_resource());
+
+        void AddStream(std::vector<domain::MediaMetadata> items);
+        std::vector<domain::MediaMetadata> Take();
+
+        static uint64_t SortKey(const domain::MediaMetadata &item, SortOrder order);
+
+        // Whether a comes before b, given their SortKeys: the keys decide, unless they are
+        // equal title keys, which fall back to a case-insensitive compare of the whole titles
+        static bool Before(uint64_t aKey, const domain::MediaMetadata &a, uint64_t bKey, const domain::MediaMetadata &b,
+                           SortOrder order);
+
+    private:
+        struct Keyed
+        {
+            uint64_t key;
+            uint32_t index;
+        };
+
+        struct Stream
+        {
+            std::vector<domain::MediaMetadata> items;
+            std::pmr::vector<Keyed> order;
+        };
+
+        void RadixSort(std::pmr::vector<Keyed> &keys) const;
+        void SortEqualTitles(Stream &stream) const;
+
+        SortOrder order_;
+        size_t limit_;
+        size_t total_ = 0;
+        std::pmr::memory_resource *scratch_;
+        std::pmr::vector<Stream> streams_;
+    };
+} // namespace app::services
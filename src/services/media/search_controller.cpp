@@ -0,0 +1,285 @@
+#include "search_controller.hpp"
+#include "media_service.hpp"
+#include "services/search/text_tokenizer.hpp"
+#include "core/utils/logger.hpp"
+#include <algorithm>
+#include <fmt/format.h>
+
+namespace app::services
+{
+    namespace
+    {
+        utils::Result<UnifiedSearchResult> Superseded()
+        {
+            return utils::Result<UnifiedSearchResult>::Error("Search superseded by a newer query", SearchController::kSupersededCode);
+        }
+    }
+
+    SearchController::SearchController(SearchFunction search, std::chrono::milliseconds debounce)
+        : search_(std::move(search)), debounce_(debounce)
+    {
+        scheduler_ = std::thread([this]
+                                 { Run(); });
+    }
+
+    SearchController::~SearchController()
+    {
+        CancelAll();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        scheduler_.join();
+    }
+
+    void SearchController::CancelAll()
+    {
+        std::vector<std::unique_ptr<Pending>> dropped; // Released after the lock
+        std::unique_lock<std::mutex> lock(mutex_);
+        closed_ = true;
+        for (auto &[sessionId, session] : sessions_)
+        {
+            if (session.running)
+            {
+                session.running->Cancel();
+            }
+            if (session.pending)
+            {
+                dropped.push_back(std::move(session.pending));
+            }
+        }
+        sessions_.clear();
+
+        // Running searches return promptly once cancelled, and complete as superseded
+        wake_.wait(lock, [this]
+                   { return active_ == 0; });
+    }
+
+    void SearchController::SetDebounce(std::chrono::milliseconds debounce)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        debounce_ = debounce;
+    }
+
+    std::string SearchController::Scope(const SearchRequest &request)
+    {
+        return fmt::format("{}:{}:{}", request.catalogType, request.filter.ToString(), request.page);
+    }
+
+    bool SearchController::MatchesQuery(const domain::MediaMetadata &item, const std::vector<std::string> &queryTokens)
+    {
+        if (queryTokens.empty())
+        {
+            return true;
+        }
+
+        thread_local std::vector<std::string> titleTokens;
+        titleTokens.clear();
+        TextTokenizer::Tokenize(item.title, titleTokens);
+        if (item.originalTitle)
+        {
+            TextTokenizer::Tokenize(*item.originalTitle, titleTokens);
+        }
+
+        for (size_t i = 0; i < queryTokens.size(); ++i)
+        {
+            const bool isLast = i + 1 == queryTokens.size();
+            const bool found = std::any_of(titleTokens.begin(), titleTokens.end(), [&](const std::string &token)
+                                           { return isLast ? token.starts_with(queryTokens[i]) : token == queryTokens[i]; });
+            if (!found)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void SearchController::Submit(const std::string &sessionId, SearchRequest request, PartialCallback onPartial, CompleteCallback onComplete)
+    {
+        std::unique_ptr<Pending> superseded;
+        std::vector<domain::MediaMetadata> reused;
+        const std::string folded = TextTokenizer::Fold(request.query);
+        const std::string scope = Scope(request);
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (closed_)
+            {
+                lock.unlock();
+                onComplete(Superseded());
+                return;
+            }
+
+            auto &session = sessions_[sessionId];
+            ++session.generation;
+
+            // The running search notices the cancel and completes as superseded by itself
+            superseded = std::move(session.pending);
+            if (session.running)
+            {
+                session.running->Cancel();
+                session.running.reset();
+            }
+
+            // "star" -> "star w": whatever "star" found that still matches is a valid first answer
+            const bool extendsLast = !session.lastQuery.empty() && folded.size() > session.lastQuery.size() &&
+                                     folded.starts_with(session.lastQuery) && scope == session.lastScope;
+            if (extendsLast)
+            {
+                std::vector<std::string> tokens;
+                TextTokenizer::Tokenize(request.query, tokens);
+                for (const auto &item : session.lastItems)
+                {
+                    if (MatchesQuery(item, tokens))
+                    {
+                        reused.push_back(item);
+                    }
+                }
+            }
+
+            session.lastQuery = folded;
+            session.lastScope = scope;
+            session.lastItems.clear();
+            session.lastItemIds.clear();
+            Remember(session, reused);
+
+            session.pending = std::make_unique<Pending>(Pending{std::move(request), onPartial, std::move(onComplete),
+                                                                std::chrono::steady_clock::now() + debounce_});
+        }
+        wake_.notify_all();
+
+        if (superseded)
+        {
+            superseded->onComplete(Superseded());
+        }
+        if (!reused.empty() && onPartial)
+        {
+            utils::Logger::Debug(fmt::format("Reusing {} item(s) from the previous query for '{}'", reused.size(), folded));
+            onPartial("prefix", reused);
+        }
+    }
+
+    void SearchController::Cancel(const std::string &sessionId)
+    {
+        std::unique_ptr<Pending> cancelled;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = sessions_.find(sessionId);
+            if (it == sessions_.end())
+            {
+                return;
+            }
+            cancelled = std::move(it->second.pending);
+            if (it->second.running)
+            {
+                it->second.running->Cancel();
+            }
+            sessions_.erase(it);
+        }
+
+        if (cancelled)
+        {
+            cancelled->onComplete(Superseded());
+        }
+    }
+
+    void SearchController::Remember(Session &session, const std::vector<domain::MediaMetadata> &items)
+    {
+        for (const auto &item : items)
+        {
+            if (session.lastItems.size() >= kMaxReusableItems)
+            {
+                return;
+            }
+            if (session.lastItemIds.insert(item.id.source + ":" + item.id.id).second)
+            {
+                session.lastItems.push_back(item);
+            }
+        }
+    }
+
+    void SearchController::Run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopping_)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            auto next = std::chrono::steady_clock::time_point::max();
+            for (auto &[sessionId, session] : sessions_)
+            {
+                if (!session.pending)
+                {
+                    continue;
+                }
+                if (session.pending->due <= now)
+                {
+                    Start(sessionId, session, std::move(session.pending));
+                }
+                else
+                {
+                    next = std::min(next, session.pending->due);
+                }
+            }
+
+            if (next == std::chrono::steady_clock::time_point::max())
+            {
+                wake_.wait(lock);
+            }
+            else
+            {
+                wake_.wait_until(lock, next);
+            }
+        }
+    }
+
+    void SearchController::Start(const std::string &sessionId, Session &session, std::unique_ptr<Pending> pending)
+    {
+        auto channel = std::make_shared<ReplyChannel>();
+        session.running = channel;
+        const uint64_t generation = session.generation;
+        ++active_;
+
+        std::thread([this, sessionId, generation, channel, pending = std::move(pending)]()
+                    {
+            auto isCurrent = [&](Session*& session) {
+                auto it = sessions_.find(sessionId);
+                session = it != sessions_.end() && it->second.generation == generation ? &it->second : nullptr;
+                return session != nullptr;
+            };
+
+            auto onPartial = [&](const std::string& source, const std::vector<domain::MediaMetadata>& items) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    Session* session = nullptr;
+                    if (!isCurrent(session)) {
+                        return;
+                    }
+                    Remember(*session, items);
+                }
+                if (pending->onPartial) {
+                    pending->onPartial(source, items);
+                }
+            };
+
+            auto result = search_(pending->request, onPartial, channel);
+
+            bool current = false;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                Session* session = nullptr;
+                current = isCurrent(session) && !channel->IsCancelled();
+                if (current) {
+                    session->running.reset();
+                    if (result.IsOk()) {
+                        Remember(*session, result.Value().items);
+                    }
+                }
+            }
+            pending->onComplete(current ? std::move(result) : Superseded());
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            --active_;
+            wake_.notify_all(); })
+            .detach();
+    }
+} // namespace app::services
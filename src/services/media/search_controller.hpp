@@ -0,0 +1,107 @@
+#pragma once
+#include "domain/models/media_types.hpp"
+#include "core/utils/result.hpp"
+#include "services/media/IMediaProvider.hpp"
+#include "services/media/reply_channel.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace app::services
+{
+    struct UnifiedSearchResult;
+
+    struct SearchRequest
+    {
+        std::string query;
+        std::string catalogType;
+        MediaFilter filter;
+        int page = 1;
+        size_t limit = 0;
+    };
+
+    // Search-as-you-type for one UI session at a time per session id.
+    //
+    // Each keystroke supersedes the session's previous query: a query still waiting out the
+    // debounce is dropped without touching the network, a running one is cancelled and
+    // completes as superseded. When the new query extends the previous one ("star" ->
+    // "star w"), the items already received for it are filtered locally and delivered
+    // straight away, before the debounce and the network round trip.
+    class SearchController
+    {
+    public:
+        using PartialCallback = std::function<void(const std::string &source, const std::vector<domain::MediaMetadata> &items)>;
+        // A superseded search completes with an error whose code is kSupersededCode
+        using CompleteCallback = std::function<void(utils::Result<UnifiedSearchResult> result)>;
+        // Runs one search to completion; cancelling the channel makes it return early
+        using SearchFunction = std::function<utils::Result<UnifiedSearchResult>(const SearchRequest &request,
+                                                                                const PartialCallback &onPartial,
+                                                                                const std::shared_ptr<ReplyChannel> &channel)>;
+
+        static constexpr int kSupersededCode = 409;
+        static constexpr size_t kMaxReusableItems = 500;
+
+        SearchController(SearchFunction search, std::chrono::milliseconds debounce);
+        ~SearchController();
+
+        SearchController(const SearchController &) = delete;
+        SearchController &operator=(const SearchController &) = delete;
+
+        void Submit(const std::string &sessionId, SearchRequest request, PartialCallback onPartial, CompleteCallback onComplete);
+        void Cancel(const std::string &sessionId);
+        // Cancels every search and returns once none is running any more, so their callbacks
+        // are done with whatever they captured. Searches still waiting out the debounce are
+        // dropped without completing, and later submissions complete at once as superseded.
+        void CancelAll();
+        void SetDebounce(std::chrono::milliseconds debounce);
+
+        // Whether item matches every query token, the last one as a prefix (it may still be typed)
+        static bool MatchesQuery(const domain::MediaMetadata &item, const std::vector<std::string> &queryTokens);
+
+    private:
+        struct Pending
+        {
+            SearchRequest request;
+            PartialCallback onPartial;
+            CompleteCallback onComplete;
+            std::chrono::steady_clock::time_point due;
+        };
+
+        struct Session
+        {
+            uint64_t generation = 0;
+            std::unique_ptr<Pending> pending;
+            std::shared_ptr<ReplyChannel> running; // Cancelled when superseded
+
+            // What the latest query has produced so far, reused by the next, longer query
+            std::string lastQuery; // Folded
+            std::string lastScope; // Catalog and filter, reuse needs them to match
+            std::vector<domain::MediaMetadata> lastItems;
+            std::unordered_set<std::string> lastItemIds;
+        };
+
+        void Run();
+        void Start(const std::string &sessionId, Session &session, std::unique_ptr<Pending> pending);
+        void Remember(Session &session, const std::vector<domain::MediaMetadata> &items);
+        static std::string Scope(const SearchRequest &request);
+
+        SearchFunction search_;
+        std::chrono::milliseconds debounce_;
+
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::unordered_map<std::string, Session> sessions_;
+        bool stopping_ = false;
+        bool closed_ = false; // By CancelAll
+        size_t active_ = 0; // Searches still running on their own threads
+        std::thread scheduler_;
+    };
+} // namespace app::services
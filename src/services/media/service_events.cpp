@@ -0,0 +1,10 @@
+#include "service_events.hpp"
+
+namespace app::services
+{
+    ServiceEvents &ServiceEvents::Instance()
+    {
+        static ServiceEvents instance;
+        return instance;
+    }
+} // namespace app::services
@@ -0,0 +1,37 @@
+#pragma once
+#include "core/events/event_system.hpp"
+#include "services/media/provider_health.hpp"
+#include <string>
+
+namespace app::services
+{
+    // A provider's circuit breaker changed state
+    struct ProviderStateChanged
+    {
+        std::string providerId;
+        CircuitState state = CircuitState::Closed;
+    };
+
+    // A page served partial was completed in the background and cached, so asking again
+    // now returns more than the page that was shown
+    struct CacheRefreshed
+    {
+        std::string cacheKey;
+        size_t items = 0;
+        size_t missingProviders = 0; // Still missing after the extra time
+    };
+
+    // What the services publish for the UI to push to the page. Publishers Post, so no
+    // handler runs under their locks; events are coalesced per provider or cache key.
+    class ServiceEvents
+    {
+    public:
+        static ServiceEvents &Instance();
+
+        events::EventDispatcher<ProviderStateChanged> providerState;
+        events::EventDispatcher<CacheRefreshed> cacheRefreshed;
+
+    private:
+        ServiceEvents() = default;
+    };
+} // namespace app::services
@@ -1,12 +1,120 @@
 #include "GenericProvider.hpp"
 #include <fmt/format.h>
 #include <nlohmann/json.hpp>
-#include "utils/logger.hpp"
+#include "core/utils/logger.hpp"
+#include "core/utils/rating_normalizer.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <string_view>
+#include <thread>
 
 namespace app::services
 {
+    namespace
+    {
+        std::string ToLower(std::string value)
+        {
+            std::transform(value.begin(), value.end(), value.begin(),
+                           [](unsigned char c)
+                           { return static_cast<char>(std::tolower(c)); });
+            return value;
+        }
+
+        // Parses "YYYY-MM-DD" (the format used by TMDB-style APIs)
+        std::optional<std::chrono::sys_days> ParseDate(std::string_view value)
+        {
+            int year = 0;
+            unsigned month = 0, day = 0;
+            const char *begin = value.data();
+            const char *end = begin + value.size();
+
+            auto [p1, ec1] = std::from_chars(begin, end, year);
+            if (ec1 != std::errc() || p1 == end || *p1 != '-')
+                return std::nullopt;
+            auto [p2, ec2] = std::from_chars(p1 + 1, end, month);
+            if (ec2 != std::errc() || p2 == end || *p2 != '-')
+                return std::nullopt;
+            auto [p3, ec3] = std::from_chars(p2 + 1, end, day);
+            if (ec3 != std::errc())
+                return std::nullopt;
+
+            const std::chrono::year_month_day ymd{std::chrono::year{year}, std::chrono::month{month}, std::chrono::day{day}};
+            if (!ymd.ok())
+                return std::nullopt;
+            return std::chrono::sys_days{ymd};
+        }
+
+        std::optional<domain::MediaType> ParseMediaType(std::string_view type)
+        {
+            const auto lower = ToLower(std::string(type));
+            if (lower == "movie")
+                return domain::MediaType::Movie;
+            if (lower == "tv" || lower == "series" || lower == "show")
+                return domain::MediaType::TvShow;
+            if (lower == "episode")
+                return domain::MediaType::Episode;
+            return std::nullopt;
+        }
+
+        // A JSON string without copying it out of the parsed document
+        template <typename Json>
+        std::string_view StringView(const Json &value)
+        {
+            return value.template get_ref<const typename Json::string_t &>();
+        }
+
+        // TMDB image paths are "/<file>" below a fixed base, which is interned once
+        domain::ImagePath TmdbImage(std::string_view path)
+        {
+            static const utils::InternedString base("https://image.tmdb.org/t/p/w500/");
+            if (path.size() > 1 && path.front() == '/' && path.find('/', 1) == std::string_view::npos)
+            {
+                return {base, std::string(path.substr(1))};
+            }
+            return domain::ImagePath::FromUrl(fmt::format("https://image.tmdb.org/t/p/w500{}", path));
+        }
+    }
+
     GenericProvider::GenericProvider(const ProviderManifest &manifest, const std::string &apiKey)
-        : manifest_(manifest), apiKey_(apiKey) {}
+        : manifest_(manifest), apiKey_(apiKey), source_(manifest.id)
+    {
+        // Registering the manifest genres up front keeps their bits stable across providers
+        for (const auto &genre : manifest_.genres)
+        {
+            domain::GenreRegistry::Instance().Bit(genre);
+        }
+        for (const auto &[genreId, genreName] : manifest_.genreIds)
+        {
+            genreNameToId_[ToLower(genreName)] = genreId;
+            if (const auto bit = domain::GenreRegistry::Instance().Bit(genreName))
+            {
+                genreIdBits_[genreId] = uint64_t{1} << *bit;
+                int64_t numericId = 0;
+                const auto [end, ec] = std::from_chars(genreId.data(), genreId.data() + genreId.size(), numericId);
+                if (ec == std::errc() && end == genreId.data() + genreId.size())
+                {
+                    numericGenreIdBits_[numericId] = uint64_t{1} << *bit;
+                }
+            }
+            else
+            {
+                utils::Logger::Warning(fmt::format("No genre bit left for '{}' from {}", genreName, manifest_.id));
+            }
+        }
+
+        if (manifest_.ratingScale > 0.0f)
+        {
+            RatingNormalizer::Instance().SetScale(manifest_.id, manifest_.ratingScale);
+        }
+
+        searchPushdown_ = PushedDownFields(manifest_.search.query_params);
+        for (const auto &[catalogType, config] : manifest_.catalogs)
+        {
+            catalogPushdown_[catalogType] = PushedDownFields(config.query_params);
+        }
+    }
 
     std::string GenericProvider::GetProviderName() const
     {
@@ -20,10 +128,18 @@ namespace app::services
 
     ProviderCapabilities GenericProvider::GetCapabilities() const
     {
+        std::vector<std::string> catalogs;
+        catalogs.reserve(manifest_.catalogs.size());
+        for (const auto &[catalogType, config] : manifest_.catalogs)
+        {
+            catalogs.push_back(catalogType);
+        }
+
         return {
             .supportedTypes = manifest_.types,
             .supportedGenres = manifest_.genres,
             .supportedSortOptions = manifest_.sortOptions,
+            .supportedCatalogs = std::move(catalogs),
             .supportsSearch = manifest_.capabilities.search,
             .supportsCatalog = manifest_.capabilities.catalog};
     }
@@ -31,95 +147,85 @@ namespace app::services
     std::future<utils::Result<std::vector<domain::MediaMetadata>>>
     GenericProvider::SearchMedia(const std::string &query, const MediaFilter &filter, int page)
     {
-        return std::async(std::launch::async, [=]()
-                          {
-        try {
-            const std::string url = BuildUrl("search", query, filter, page);
-            utils::Logger::Info("Constructed Search URL: " + url);
-            const auto response = utils::HttpClient::Get(url);
-            const auto json = nlohmann::json::parse(response);
+        return std::async(std::launch::async, [=, this, self = shared_from_this()]()
+                          { return RunSearch(query, filter, page); });
+    }
 
-            if (!json.contains("results")) {
-                utils::Logger::Error("Invalid API response: 'results' key missing");
-                return utils::Result<std::vector<domain::MediaMetadata>>(
-                    utils::Result<std::vector<domain::MediaMetadata>>::Error("Invalid API response: 'results' key missing")
-                );
-            }
+    std::future<utils::Result<std::vector<domain::MediaMetadata>>>
+    GenericProvider::GetCatalog(const std::string &catalogType, const MediaFilter &filter, int page)
+    {
+        return std::async(std::launch::async, [=, this, self = shared_from_this()]()
+                          { return RunCatalog(catalogType, filter, page); });
+    }
 
-            std::vector<domain::MediaMetadata> results;
-            for (const auto& item : json["results"]) {
-                results.push_back(ParseItem(item));
-            }
-            return utils::Result<std::vector<domain::MediaMetadata>>(results);
-        } catch (const std::exception& e) {
+    void GenericProvider::SearchMedia(const std::string &query, const MediaFilter &filter, int page, PageCallback done)
+    {
+        std::thread([=, this, self = shared_from_this(), done = std::move(done)]()
+                    { done(RunSearch(query, filter, page)); })
+            .detach();
+    }
+
+    void GenericProvider::GetCatalog(const std::string &catalogType, const MediaFilter &filter, int page, PageCallback done)
+    {
+        std::thread([=, this, self = shared_from_this(), done = std::move(done)]()
+                    { done(RunCatalog(catalogType, filter, page)); })
+            .detach();
+    }
+
+    utils::Result<std::vector<domain::MediaMetadata>>
+    GenericProvider::RunSearch(const std::string &query, const MediaFilter &filter, int page)
+    {
+        try
+        {
+            const std::string url = BuildUrl("search", query, filter, page);
+            utils::Logger::Info("Constructed Search URL: " + url);
+            return FetchPage(url, filter, searchPushdown_);
+        }
+        catch (const std::exception &e)
+        {
             utils::Logger::Error("SearchMedia failed: " + std::string(e.what()));
-            return utils::Result<std::vector<domain::MediaMetadata>>(
-                utils::Result<std::vector<domain::MediaMetadata>>::Error(e.what())
-            );
-        } });
+            return utils::Result<std::vector<domain::MediaMetadata>>::Error(e.what());
+        }
     }
 
-    std::future<utils::Result<std::vector<domain::MediaMetadata>>>
-    GenericProvider::GetCatalog(const std::string &catalogType, const MediaFilter &filter, int page)
+    utils::Result<std::vector<domain::MediaMetadata>>
+    GenericProvider::RunCatalog(const std::string &catalogType, const MediaFilter &filter, int page)
     {
-        return std::async(std::launch::async, [=]()
-                          {
-        try {
+        try
+        {
             // Find the catalog configuration
             auto it = manifest_.catalogs.find(catalogType);
-            if (it == manifest_.catalogs.end()) {
+            if (it == manifest_.catalogs.end())
+            {
                 utils::Logger::Error("Catalog type not found: " + catalogType);
-                return utils::Result<std::vector<domain::MediaMetadata>>(
-                    utils::Result<std::vector<domain::MediaMetadata>>::Error("Catalog type not found: " + catalogType)
-                );
+                return utils::Result<std::vector<domain::MediaMetadata>>::Error("Catalog type not found: " + catalogType);
             }
 
             // Build the URL for the catalog endpoint
             const std::string url = BuildUrl("catalog", "", filter, page, &it->second);
             utils::Logger::Info("Constructed Catalog URL: " + url);
 
-            // Fetch the API response
-            const auto response = utils::HttpClient::Get(url);
-            const auto json = nlohmann::json::parse(response);
-
-            // Check if the "results" array exists
-            if (!json.contains("results") || !json["results"].is_array()) {
-                utils::Logger::Error("Invalid API response: 'results' key missing or not an array");
-                return utils::Result<std::vector<domain::MediaMetadata>>(
-                    utils::Result<std::vector<domain::MediaMetadata>>::Error("Invalid API response: 'results' key missing or not an array")
-                );
-            }
-
-            // Parse each item in the "results" array
-            std::vector<domain::MediaMetadata> results;
-            for (const auto& item : json["results"]) {
-                try {
-                    results.push_back(ParseItem(item));
-                } catch (const std::exception& e) {
-                    utils::Logger::Error("Failed to parse item: " + std::string(e.what()));
-                    continue; // Skip invalid items
-                }
-            }
-
-            return utils::Result<std::vector<domain::MediaMetadata>>(results);
-        } catch (const std::exception& e) {
+            return FetchPage(url, filter, catalogPushdown_.at(catalogType));
+        }
+        catch (const std::exception &e)
+        {
             utils::Logger::Error("GetCatalog failed: " + std::string(e.what()));
-            return utils::Result<std::vector<domain::MediaMetadata>>(
-                utils::Result<std::vector<domain::MediaMetadata>>::Error(e.what())
-            );
-        } });
+            return utils::Result<std::vector<domain::MediaMetadata>>::Error(e.what());
+        }
     }
 
     std::future<utils::Result<domain::MediaMetadata>>
     GenericProvider::GetMediaDetails(const domain::MediaId &mediaId)
     {
-        return std::async(std::launch::async, [=]()
+        return std::async(std::launch::async, [=, this, self = shared_from_this()]()
                           {
         try {
             // Build the URL for fetching media details
             const std::string url = manifest_.endpoint + "/details?id=" + mediaId.id;
             const auto response = utils::HttpClient::Get(url);
-            const auto json = nlohmann::json::parse(response);
+            utils::RequestArena arena(response.size() * 2);
+            utils::ArenaScope scope(arena);
+            const auto json = ArenaJson::parse(response);
 
             // Parse the response and return the media metadata
             domain::MediaMetadata metadata = ParseItem(json);
@@ -154,21 +260,64 @@ namespace app::services
             endpointConfig = catalogConfig;
         }
 
+        // Each placeholder resolves to a value, or to nullopt when the filter field is
+        // unset, in which case the whole parameter is left out of the URL.
+        auto resolvePlaceholder = [&](std::string_view name) -> std::optional<std::string>
+        {
+            if (name == "query")
+                return utils::HttpClient::EscapeUrl(query);
+            if (name == "page")
+                return std::to_string(page);
+            if (name == "sortBy")
+                return utils::HttpClient::EscapeUrl(filter.sortBy.value_or("popularity"));
+            if (name == "sortOrder")
+                return std::string(filter.sortDesc.value_or(true) ? "desc" : "asc");
+            if (name == "sortDesc")
+                return std::string(filter.sortDesc.value_or(true) ? "true" : "false");
+            if (name == "year" && filter.year)
+                return std::to_string(*filter.year);
+            if (name == "type" && filter.type)
+                return utils::HttpClient::EscapeUrl(*filter.type);
+            if (name == "genre" && filter.genre)
+            {
+                if (genreNameToId_.empty())
+                    return utils::HttpClient::EscapeUrl(*filter.genre);
+                auto it = genreNameToId_.find(ToLower(*filter.genre));
+                if (it != genreNameToId_.end())
+                    return it->second;
+            }
+            return std::nullopt;
+        };
+
         return std::visit([&](auto *config)
                           {
         std::string url = manifest_.endpoint + config->path + "?";
         for (const auto& [key, value] : config->query_params) {
-            std::string paramValue = value;
-            if (paramValue.find("{query}") != std::string::npos) {
-                paramValue.replace(paramValue.find("{query}"), 7, query);
-            }
-            if (paramValue.find("{page}") != std::string::npos) {
-                paramValue.replace(paramValue.find("{page}"), 6, std::to_string(page));
+            std::string paramValue;
+            bool include = true;
+            size_t pos = 0;
+            while (pos < value.size()) {
+                const size_t open = value.find('{', pos);
+                const size_t close = open == std::string::npos ? std::string::npos : value.find('}', open);
+                if (close == std::string::npos) {
+                    paramValue.append(value, pos, std::string::npos);
+                    break;
+                }
+                paramValue.append(value, pos, open - pos);
+                const auto name = std::string_view(value).substr(open + 1, close - open - 1);
+                if (auto resolved = resolvePlaceholder(name)) {
+                    paramValue += *resolved;
+                } else if (name == "genre" || name == "type" || name == "year") {
+                    include = false;
+                    break;
+                } else {
+                    paramValue.append(value, open, close - open + 1); // Unknown placeholder, keep as-is
+                }
+                pos = close + 1;
             }
-            if (paramValue.find("{sortBy}") != std::string::npos) {
-                paramValue.replace(paramValue.find("{sortBy}"), 8, filter.sortBy.value_or("popularity"));
+            if (include) {
+                url += key + "=" + paramValue + "&";
             }
-            url += key + "=" + paramValue + "&";
         }
         if (manifest_.auth.has_value()) {
             url += manifest_.auth->key_param + "=" + apiKey_;
@@ -176,40 +325,200 @@ namespace app::services
         return url; }, endpointConfig);
     }
 
-    domain::MediaMetadata GenericProvider::ParseItem(const nlohmann::json &item) const
+    uint8_t GenericProvider::PushedDownFields(const std::unordered_map<std::string, std::string> &queryParams)
+    {
+        uint8_t fields = 0;
+        for (const auto &[key, value] : queryParams)
+        {
+            if (value.find("{genre}") != std::string::npos)
+                fields |= FilterGenre;
+            if (value.find("{type}") != std::string::npos)
+                fields |= FilterType;
+            if (value.find("{year}") != std::string::npos)
+                fields |= FilterYear;
+        }
+        return fields;
+    }
+
+    utils::Result<std::vector<domain::MediaMetadata>> GenericProvider::FetchPage(const std::string &url,
+                                                                                 const MediaFilter &filter,
+                                                                                 uint8_t pushedDown)
+    {
+        // A genre we cannot map to a provider id was dropped from the URL, so filter it here
+        if (filter.genre && !genreNameToId_.empty() && !genreNameToId_.contains(ToLower(*filter.genre)))
+        {
+            pushedDown &= static_cast<uint8_t>(~FilterGenre);
+        }
+
+        // Fetch the API response. The parsed document is only needed until its items are
+        // copied out, so it lives in an arena: a few block allocations instead of one per
+        // value, key and string, all released at once. The scope must outlive `json`.
+        const auto response = utils::HttpClient::Get(url);
+        utils::RequestArena arena(response.size() * 2);
+        utils::ArenaScope scope(arena);
+        const auto json = ArenaJson::parse(response);
+
+        // Check if the "results" array exists
+        if (!json.contains("results") || !json["results"].is_array())
+        {
+            utils::Logger::Error("Invalid API response: 'results' key missing or not an array");
+            return utils::Result<std::vector<domain::MediaMetadata>>::Error("Invalid API response: 'results' key missing or not an array");
+        }
+
+        // Parse each item, applying the filters the provider could not apply itself
+        std::vector<domain::MediaMetadata> results;
+        results.reserve(json["results"].size());
+        for (const auto &item : json["results"])
+        {
+            try
+            {
+                auto metadata = ParseItem(item);
+                if (MatchesLocally(metadata, filter, pushedDown))
+                {
+                    results.push_back(std::move(metadata));
+                }
+            }
+            catch (const std::exception &e)
+            {
+                utils::Logger::Error("Failed to parse item: " + std::string(e.what()));
+                continue; // Skip invalid items
+            }
+        }
+
+        const auto totalBytes = bytesFetched_ += response.size();
+        itemsParsed_ += json["results"].size();
+        const auto totalDelivered = itemsDelivered_ += results.size();
+        utils::Logger::Debug(fmt::format("{}: fetched {} bytes for {} delivered item(s), {} bytes/item overall",
+                                         manifest_.id, response.size(), results.size(),
+                                         totalDelivered ? totalBytes / totalDelivered : 0));
+
+        return utils::Result<std::vector<domain::MediaMetadata>>(std::move(results));
+    }
+
+    bool GenericProvider::MatchesLocally(const domain::MediaMetadata &item, const MediaFilter &filter, uint8_t pushedDown) const
+    {
+        if (filter.genre && !(pushedDown & FilterGenre))
+        {
+            if (!item.genres.Contains(*filter.genre))
+                return false;
+        }
+
+        if (filter.type && !(pushedDown & FilterType))
+        {
+            auto wanted = ParseMediaType(*filter.type);
+            if (wanted && item.id.type != *wanted)
+                return false;
+        }
+
+        if (filter.year && !(pushedDown & FilterYear))
+        {
+            const std::chrono::year_month_day ymd{std::chrono::floor<std::chrono::days>(item.releaseDate)};
+            if (static_cast<int>(ymd.year()) != *filter.year)
+                return false;
+        }
+
+        return true;
+    }
+
+    GenericProvider::FetchStats GenericProvider::GetFetchStats() const
+    {
+        return {bytesFetched_.load(), itemsParsed_.load(), itemsDelivered_.load()};
+    }
+
+    domain::MediaMetadata GenericProvider::ParseItem(const ArenaJson &item) const
     {
         domain::MediaMetadata metadata;
-        metadata.id.source = manifest_.id;
+        metadata.id.source = source_;
 
         // Parse numeric fields
         metadata.id.id = std::to_string(item["id"].get<int>()); // Convert numeric ID to string
         metadata.rating = item["vote_average"].get<float>();    // Parse vote_average as float
         metadata.voteCount = item["vote_count"].get<int>();     // Parse vote_count as int
+        if (item.contains("popularity") && item["popularity"].is_number())
+        {
+            metadata.popularity = item["popularity"].get<float>();
+        }
+
+        // Movies carry "title", TV shows carry "name"
+        const bool isShow = !item.contains("title") && item.contains("name");
+        metadata.id.type = isShow ? domain::MediaType::TvShow : domain::MediaType::Movie;
+        if (item.contains("media_type") && item["media_type"].is_string())
+        {
+            metadata.id.type = ParseMediaType(StringView(item["media_type"])).value_or(metadata.id.type);
+        }
 
         // Parse string fields
-        metadata.title = item["title"].get<std::string>();
-        metadata.overview = item["overview"].get<std::string>();
+        metadata.title = StringView(item[isShow ? "name" : "title"]);
+        metadata.overview = StringView(item["overview"]);
 
         // Handle optional poster path
         if (item.contains("poster_path") && !item["poster_path"].is_null())
         {
-            metadata.posterPath = "https://image.tmdb.org/t/p/w500" + item["poster_path"].get<std::string>();
+            metadata.posterPath = TmdbImage(StringView(item["poster_path"]));
         }
 
         // Handle optional backdrop path
         if (item.contains("backdrop_path") && !item["backdrop_path"].is_null())
         {
-            metadata.backdropPath = "https://image.tmdb.org/t/p/w500" + item["backdrop_path"].get<std::string>();
+            metadata.backdropPath = TmdbImage(StringView(item["backdrop_path"]));
+        }
+
+        // Genres come as ids in list responses and as {id, name} objects in detail responses
+        if (item.contains("genre_ids") && item["genre_ids"].is_array())
+        {
+            uint64_t genreMask = 0;
+            for (const auto &genreId : item["genre_ids"])
+            {
+                if (genreId.is_number_integer())
+                {
+                    if (auto it = numericGenreIdBits_.find(genreId.get<int64_t>()); it != numericGenreIdBits_.end())
+                    {
+                        genreMask |= it->second;
+                    }
+                }
+                else if (auto it = genreIdBits_.find(std::string(StringView(genreId))); it != genreIdBits_.end())
+                {
+                    genreMask |= it->second;
+                }
+            }
+            metadata.genres = domain::GenreSet(genreMask);
+        }
+        else if (item.contains("genres") && item["genres"].is_array())
+        {
+            for (const auto &genre : item["genres"])
+            {
+                if (genre.is_object() && genre.contains("name"))
+                {
+                    metadata.genres.Add(StringView(genre["name"]));
+                }
+            }
+        }
+
+        // External ids, used to merge the same title coming from several providers
+        if (manifest_.idNamespace == "tmdb")
+        {
+            metadata.externalIds.tmdb = metadata.id.id;
+        }
+        const auto &ids = item.contains("external_ids") && item["external_ids"].is_object() ? item["external_ids"] : item;
+        if (ids.contains("imdb_id") && ids["imdb_id"].is_string())
+        {
+            metadata.externalIds.imdb = std::string(StringView(ids["imdb_id"]));
+        }
+        if (ids.contains("tmdb_id") && ids["tmdb_id"].is_number_integer())
+        {
+            metadata.externalIds.tmdb = std::to_string(ids["tmdb_id"].get<int>());
         }
 
         // Parse release date
-        if (item.contains("release_date") && !item["release_date"].is_null())
+        const char *dateField = isShow ? "first_air_date" : "release_date";
+        if (item.contains(dateField) && item[dateField].is_string())
         {
-            std::string releaseDateStr = item["release_date"].get<std::string>();
-            // Convert release date string to time_point (if needed)
-            // Example: metadata.releaseDate = ParseDate(releaseDateStr);
+            if (auto releaseDate = ParseDate(StringView(item[dateField])))
+            {
+                metadata.releaseDate = *releaseDate;
+            }
         }
 
         return metadata;
     }
-}
\ No newline at end of file
+}
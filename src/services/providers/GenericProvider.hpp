@@ -1,13 +1,33 @@
 #pragma once
 #include "../media/media_service.hpp"
 #include "core/utils/http_client.hpp"
+#include "core/utils/request_arena.hpp"
 #include "provider_repository.hpp"
+#include <atomic>
+#include <cstdint>
+#include <map>
 
 namespace app::services
 {
     class GenericProvider : public IMediaProvider
     {
     public:
+        // MediaFilter fields an endpoint can push down through its query parameters. Whether
+        // a provider is asked to sort is decided by ProviderRoutingIndex::SortsNatively.
+        enum FilterField : uint8_t
+        {
+            FilterGenre = 1 << 0,
+            FilterType = 1 << 1,
+            FilterYear = 1 << 2
+        };
+
+        struct FetchStats
+        {
+            uint64_t bytesFetched = 0;
+            uint64_t itemsParsed = 0;
+            uint64_t itemsDelivered = 0;
+        };
+
         explicit GenericProvider(const ProviderManifest &manifest, const std::string &apiKey);
 
         std::string GetProviderName() const override;
@@ -20,12 +40,33 @@ namespace app::services
         std::future<utils::Result<std::vector<domain::MediaMetadata>>>
         GetCatalog(const std::string &catalogType, const MediaFilter &filter, int page) override;
 
+        void SearchMedia(const std::string &query, const MediaFilter &filter, int page, PageCallback done) override;
+        void GetCatalog(const std::string &catalogType, const MediaFilter &filter, int page, PageCallback done) override;
+
         std::future<utils::Result<domain::MediaMetadata>>
         GetMediaDetails(const domain::MediaId &mediaId) override;
 
+        FetchStats GetFetchStats() const;
+
     private:
+        // Responses are parsed into the fetch's RequestArena, see FetchPage
+        using ArenaJson = nlohmann::basic_json<std::map, std::vector, utils::ArenaString, bool,
+                                               std::int64_t, std::uint64_t, double, utils::ArenaAllocator>;
+
         ProviderManifest manifest_;
         std::string apiKey_;
+        utils::InternedString source_;
+        std::unordered_map<std::string, std::string> genreNameToId_;
+        std::unordered_map<std::string, uint64_t> genreIdBits_; // Provider genre id -> GenreSet bit
+        std::unordered_map<int64_t, uint64_t> numericGenreIdBits_; // Same, for ids sent as JSON numbers
+
+        // Which filter fields each endpoint pushes down, computed once from the manifest
+        uint8_t searchPushdown_ = 0;
+        std::unordered_map<std::string, uint8_t> catalogPushdown_;
+
+        std::atomic<uint64_t> bytesFetched_{0};
+        std::atomic<uint64_t> itemsParsed_{0};
+        std::atomic<uint64_t> itemsDelivered_{0};
 
         std::string BuildUrl(const std::string &endpointType,
                              const std::string &query,
@@ -33,6 +74,16 @@ namespace app::services
                              int page,
                              const CatalogConfig *catalogConfig = nullptr) const;
 
-        domain::MediaMetadata ParseItem(const nlohmann::json &item) const;
+        utils::Result<std::vector<domain::MediaMetadata>> RunSearch(const std::string &query, const MediaFilter &filter, int page);
+        utils::Result<std::vector<domain::MediaMetadata>> RunCatalog(const std::string &catalogType, const MediaFilter &filter, int page);
+
+        utils::Result<std::vector<domain::MediaMetadata>> FetchPage(const std::string &url,
+                                                                    const MediaFilter &filter,
+                                                                    uint8_t pushedDown);
+
+        static uint8_t PushedDownFields(const std::unordered_map<std::string, std::string> &queryParams);
+        bool MatchesLocally(const domain::MediaMetadata &item, const MediaFilter &filter, uint8_t pushedDown) const;
+
+        domain::MediaMetadata ParseItem(const ArenaJson &item) const;
     };
-}
\ No newline at end of file
+}
@@ -3,7 +3,7 @@
 #include <fstream>
 #include <nlohmann/json.hpp>
 #include <filesystem>
-#include "utils/logger.hpp"
+#include "core/utils/logger.hpp"
 
 namespace app::services
 {
@@ -15,23 +15,109 @@ namespace app::services
 
     void ProviderRepository::LoadProvidersFromManifests(const std::string &providersDir)
     {
+        std::unordered_map<std::string, std::shared_ptr<IMediaProvider>> loaded;
+        std::unordered_map<std::string, std::string> manifestProviders;
+
         for (const auto &entry : std::filesystem::directory_iterator(providersDir))
         {
             if (entry.path().extension() == ".json" && entry.path().filename() != "providers.json")
             {
-                std::ifstream file(entry.path());
-                nlohmann::json manifestJson;
-                file >> manifestJson;
-                ProviderManifest manifest = manifestJson.get<ProviderManifest>();
-                if (ValidateManifest(manifest))
+                std::string providerId;
+                if (auto provider = LoadProvider(providersDir, entry.path(), providerId))
                 {
-                    auto provider = std::make_unique<GenericProvider>(
-                        manifest,
-                        GetApiKeyForProvider(providersDir, manifest.id));
-                    MediaService::Instance().RegisterProvider(manifest.id, std::move(provider));
+                    loaded[providerId] = std::move(provider);
+                    manifestProviders[entry.path().string()] = providerId;
                 }
             }
         }
+
+        {
+            std::lock_guard<std::mutex> lock(manifestMutex_);
+            manifestProviders_ = std::move(manifestProviders);
+        }
+        MediaService::Instance().ReplaceProviders(std::move(loaded));
+    }
+
+    void ProviderRepository::ReloadManifests(const std::string &providersDir,
+                                             const std::vector<std::filesystem::path> &changedFiles)
+    {
+        // A changed providers.json can change any API key, so rebuild everything
+        for (const auto &file : changedFiles)
+        {
+            if (file.filename() == "providers.json")
+            {
+                utils::Logger::Info("providers.json changed, reloading all providers");
+                LoadProvidersFromManifests(providersDir);
+                return;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(manifestMutex_);
+        std::unordered_map<std::string, std::shared_ptr<IMediaProvider>> upserts;
+        std::vector<std::string> removals;
+
+        for (const auto &file : changedFiles)
+        {
+            const auto key = file.string();
+            auto previous = manifestProviders_.find(key);
+
+            std::string providerId;
+            std::shared_ptr<IMediaProvider> provider;
+            if (std::filesystem::exists(file))
+            {
+                provider = LoadProvider(providersDir, file, providerId);
+            }
+
+            if (provider)
+            {
+                // The manifest may have been edited to a different id
+                if (previous != manifestProviders_.end() && previous->second != providerId)
+                {
+                    removals.push_back(previous->second);
+                }
+                manifestProviders_[key] = providerId;
+                upserts[providerId] = std::move(provider);
+            }
+            else if (previous != manifestProviders_.end() && !std::filesystem::exists(file))
+            {
+                removals.push_back(previous->second);
+                manifestProviders_.erase(previous);
+            }
+            // An existing but invalid manifest keeps serving its last good version
+        }
+
+        if (!upserts.empty() || !removals.empty())
+        {
+            MediaService::Instance().UpdateProviders(std::move(upserts), removals);
+        }
+    }
+
+    std::shared_ptr<IMediaProvider> ProviderRepository::LoadProvider(const std::string &providersDir,
+                                                                     const std::filesystem::path &manifestPath,
+                                                                     std::string &providerId)
+    {
+        try
+        {
+            std::ifstream file(manifestPath);
+            nlohmann::json manifestJson;
+            file >> manifestJson;
+            ProviderManifest manifest = manifestJson.get<ProviderManifest>();
+            if (!ValidateManifest(manifest))
+            {
+                utils::Logger::Error("Invalid provider manifest: " + manifestPath.string());
+                return nullptr;
+            }
+
+            providerId = manifest.id;
+            return std::make_shared<GenericProvider>(
+                manifest,
+                GetApiKeyForProvider(providersDir, manifest.id));
+        }
+        catch (const std::exception &e)
+        {
+            utils::Logger::Error(fmt::format("Failed to load provider manifest {}: {}", manifestPath.string(), e.what()));
+            return nullptr;
+        }
     }
 
     bool ProviderRepository::ValidateManifest(const ProviderManifest &manifest)
@@ -105,5 +191,44 @@ namespace app::services
                 manifest.catalogs[key] = value.get<CatalogConfig>();
             }
         }
+
+        // Optional capability lists, used to route requests only to providers that can serve them
+        if (j.contains("types"))
+        {
+            j.at("types").get_to(manifest.types);
+        }
+        if (j.contains("genres"))
+        {
+            j.at("genres").get_to(manifest.genres);
+        }
+        if (j.contains("sort_options"))
+        {
+            j.at("sort_options").get_to(manifest.sortOptions);
+        }
+
+        // Optional map used to push genre filters down and to resolve genre ids in results
+        if (j.contains("genre_ids"))
+        {
+            j.at("genre_ids").get_to(manifest.genreIds);
+            if (manifest.genres.empty())
+            {
+                for (const auto &[genreId, genreName] : manifest.genreIds)
+                {
+                    manifest.genres.push_back(genreName);
+                }
+            }
+        }
+
+        // Lets results from different providers be matched by id instead of by title
+        if (j.contains("id_namespace"))
+        {
+            j.at("id_namespace").get_to(manifest.idNamespace);
+        }
+
+        // Lets ratings on different scales be compared, see RatingNormalizer
+        if (j.contains("rating_scale"))
+        {
+            j.at("rating_scale").get_to(manifest.ratingScale);
+        }
     }
 }
\ No newline at end of file
@@ -3,6 +3,9 @@
 #include <vector>
 #include <optional>
 #include <unordered_map>
+#include <filesystem>
+#include <memory>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include "../media/media_service.hpp" // Add this line
 // Remove #include "GenericProvider.hpp"
@@ -46,6 +49,9 @@ namespace app::services
         std::vector<std::string> types;
         std::vector<std::string> genres;
         std::vector<std::string> sortOptions;
+        std::unordered_map<std::string, std::string> genreIds; // Provider genre id -> genre name
+        std::string idNamespace;                                // "tmdb" when the provider's own ids are TMDB ids
+        float ratingScale = 0.0f;                               // Highest rating the provider gives, 0 if not declared
     };
 
     // Declare the functions in the header file
@@ -60,12 +66,19 @@ namespace app::services
         static ProviderRepository &Instance();
 
         void LoadProvidersFromManifests(const std::string &providersDir);
+        // Rebuilds the providers whose manifests changed and publishes them as one snapshot
+        void ReloadManifests(const std::string &providersDir, const std::vector<std::filesystem::path> &changedFiles);
         bool ValidateManifest(const ProviderManifest &manifest);
         std::string GetApiKeyForProvider(const std::string &providersDir, const std::string &providerId);
 
     private:
-        std::unordered_map<std::string, std::unique_ptr<IMediaProvider>> providers_;
-        std::mutex providerMutex_;
+        std::shared_ptr<IMediaProvider> LoadProvider(const std::string &providersDir,
+                                                     const std::filesystem::path &manifestPath,
+                                                     std::string &providerId);
+
+        // Manifest file -> provider id, so deleted files can be mapped back to their provider
+        std::unordered_map<std::string, std::string> manifestProviders_;
+        std::mutex manifestMutex_;
     };
 
 } // namespace app::services
\ No newline at end of file
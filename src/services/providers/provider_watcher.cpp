@@ -0,0 +1,230 @@
+#include "provider_watcher.hpp"
+#include "core/utils/logger.hpp"
+#include <algorithm>
+#include <fmt/format.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#elif defined(__linux__)
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace app::services
+{
+    namespace
+    {
+        bool IsManifestFile(const std::filesystem::path &path)
+        {
+            return path.extension() == ".json";
+        }
+    }
+
+    ProviderWatcher::ProviderWatcher(std::chrono::milliseconds debounce)
+        : debounce_(debounce) {}
+
+    ProviderWatcher::~ProviderWatcher()
+    {
+        Stop();
+    }
+
+    bool ProviderWatcher::Start(const std::string &directory, ChangeCallback callback)
+    {
+        if (running_)
+        {
+            return true;
+        }
+
+        directory_ = directory;
+        callback_ = std::move(callback);
+        knownFiles_.clear();
+
+#ifdef _WIN32
+        changeHandle_ = FindFirstChangeNotificationW(
+            directory_.wstring().c_str(), FALSE,
+            FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE);
+        if (changeHandle_ == INVALID_HANDLE_VALUE)
+        {
+            changeHandle_ = nullptr;
+            utils::Logger::Error("Failed to watch providers directory: " + directory);
+            return false;
+        }
+        stopEvent_ = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+#elif defined(__linux__)
+        inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFd_ < 0 ||
+            inotify_add_watch(inotifyFd_, directory_.c_str(),
+                              IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE) < 0)
+        {
+            utils::Logger::Error("Failed to watch providers directory: " + directory);
+            if (inotifyFd_ >= 0)
+            {
+                close(inotifyFd_);
+                inotifyFd_ = -1;
+            }
+            return false;
+        }
+#endif
+
+#ifndef __linux__
+        // Seed the modification times so the first scan only reports real changes
+        std::vector<std::filesystem::path> ignored;
+        ScanDirectory(ignored);
+#endif
+
+        running_ = true;
+        thread_ = std::thread(&ProviderWatcher::Run, this);
+        utils::Logger::Info("Watching providers directory: " + directory);
+        return true;
+    }
+
+    void ProviderWatcher::Stop()
+    {
+        if (!running_.exchange(false))
+        {
+            return;
+        }
+
+#ifdef _WIN32
+        SetEvent(stopEvent_);
+#endif
+        if (thread_.joinable())
+        {
+            thread_.join();
+        }
+
+#ifdef _WIN32
+        FindCloseChangeNotification(changeHandle_);
+        CloseHandle(stopEvent_);
+        changeHandle_ = nullptr;
+        stopEvent_ = nullptr;
+#elif defined(__linux__)
+        close(inotifyFd_);
+        inotifyFd_ = -1;
+#endif
+    }
+
+    void ProviderWatcher::Run()
+    {
+        std::vector<std::filesystem::path> changed;
+        while (running_)
+        {
+            if (!PollChanges(changed, std::chrono::milliseconds(500)))
+            {
+                continue;
+            }
+
+            // Keep collecting until the directory goes quiet
+            while (running_ && PollChanges(changed, debounce_))
+            {
+            }
+
+            std::sort(changed.begin(), changed.end());
+            changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+
+            if (running_ && !changed.empty())
+            {
+                utils::Logger::Info(fmt::format("Detected {} changed provider manifest(s)", changed.size()));
+                try
+                {
+                    callback_(changed);
+                }
+                catch (const std::exception &e)
+                {
+                    utils::Logger::Error("Provider reload failed: " + std::string(e.what()));
+                }
+            }
+            changed.clear();
+        }
+    }
+
+    bool ProviderWatcher::PollChanges(std::vector<std::filesystem::path> &changed, std::chrono::milliseconds timeout)
+    {
+#ifdef _WIN32
+        HANDLE handles[] = {changeHandle_, stopEvent_};
+        DWORD waitResult = WaitForMultipleObjects(2, handles, FALSE, static_cast<DWORD>(timeout.count()));
+        if (waitResult != WAIT_OBJECT_0)
+        {
+            return false;
+        }
+        FindNextChangeNotification(changeHandle_);
+
+        const auto before = changed.size();
+        ScanDirectory(changed);
+        return changed.size() != before;
+#elif defined(__linux__)
+        pollfd pfd{inotifyFd_, POLLIN, 0};
+        if (poll(&pfd, 1, static_cast<int>(timeout.count())) <= 0)
+        {
+            return false;
+        }
+
+        alignas(inotify_event) char buffer[4096];
+        bool any = false;
+        ssize_t length;
+        while ((length = read(inotifyFd_, buffer, sizeof(buffer))) > 0)
+        {
+            for (char *ptr = buffer; ptr < buffer + length;)
+            {
+                const auto *event = reinterpret_cast<const inotify_event *>(ptr);
+                if (event->len > 0)
+                {
+                    std::filesystem::path file = directory_ / event->name;
+                    if (IsManifestFile(file))
+                    {
+                        changed.push_back(std::move(file));
+                        any = true;
+                    }
+                }
+                ptr += sizeof(inotify_event) + event->len;
+            }
+        }
+        return any;
+#else
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (running_ && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+
+        const auto before = changed.size();
+        ScanDirectory(changed);
+        return changed.size() != before;
+#endif
+    }
+
+    void ProviderWatcher::ScanDirectory(std::vector<std::filesystem::path> &changed)
+    {
+        std::error_code ec;
+        std::unordered_map<std::string, std::filesystem::file_time_type> current;
+        for (const auto &entry : std::filesystem::directory_iterator(directory_, ec))
+        {
+            if (!IsManifestFile(entry.path()))
+            {
+                continue;
+            }
+
+            const auto key = entry.path().string();
+            const auto writeTime = entry.last_write_time(ec);
+            current[key] = writeTime;
+
+            auto it = knownFiles_.find(key);
+            if (it == knownFiles_.end() || it->second != writeTime)
+            {
+                changed.push_back(entry.path());
+            }
+        }
+
+        // Anything we knew about that is gone was deleted
+        for (const auto &[key, writeTime] : knownFiles_)
+        {
+            if (current.find(key) == current.end())
+            {
+                changed.emplace_back(key);
+            }
+        }
+
+        knownFiles_ = std::move(current);
+    }
+} // namespace app::services
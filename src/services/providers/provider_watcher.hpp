@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace app::services
+{
+    // Watches the providers directory and reports changed manifest files.
+    // Uses inotify on Linux, change notifications on Windows and mtime polling elsewhere.
+    // Bursts of events (editors write files in several steps) are coalesced until the
+    // directory has been quiet for the debounce interval.
+    class ProviderWatcher
+    {
+    public:
+        using ChangeCallback = std::function<void(const std::vector<std::filesystem::path> &changedFiles)>;
+
+        explicit ProviderWatcher(std::chrono::milliseconds debounce = std::chrono::milliseconds(250));
+        ~ProviderWatcher();
+
+        ProviderWatcher(const ProviderWatcher &) = delete;
+        ProviderWatcher &operator=(const ProviderWatcher &) = delete;
+
+        bool Start(const std::string &directory, ChangeCallback callback);
+        void Stop();
+        bool IsRunning() const { return running_; }
+
+    private:
+        void Run();
+        bool PollChanges(std::vector<std::filesystem::path> &changed, std::chrono::milliseconds timeout);
+        void ScanDirectory(std::vector<std::filesystem::path> &changed);
+
+        std::filesystem::path directory_;
+        ChangeCallback callback_;
+        std::chrono::milliseconds debounce_;
+        std::atomic<bool> running_{false};
+        std::thread thread_;
+
+#ifdef _WIN32
+        void *changeHandle_ = nullptr;
+        void *stopEvent_ = nullptr;
+#elif defined(__linux__)
+        int inotifyFd_ = -1;
+#endif
+        // Used by the Windows and polling backends to work out which files changed
+        std::unordered_map<std::string, std::filesystem::file_time_type> knownFiles_;
+    };
+} // namespace app::services
@@ -0,0 +1,385 @@
+#include "fuzzy_matcher.hpp"
+#include "text_tokenizer.hpp"
+#include <algorithm>
+#include <array>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define APP_FUZZY_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define APP_TARGET_AVX2
+#else
+#define APP_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace app::services
+{
+    namespace
+    {
+        using PeqTable = std::array<uint64_t, 256>;
+
+        uint32_t PackTrigram(const std::string &text, size_t pos)
+        {
+            return (static_cast<uint32_t>(static_cast<unsigned char>(text[pos])) << 16) |
+                   (static_cast<uint32_t>(static_cast<unsigned char>(text[pos + 1])) << 8) |
+                   static_cast<uint32_t>(static_cast<unsigned char>(text[pos + 2]));
+        }
+
+        std::vector<uint32_t> UniqueTrigrams(const std::string &padded)
+        {
+            std::vector<uint32_t> trigrams;
+            for (size_t i = 0; i + 3 <= padded.size(); ++i)
+            {
+                trigrams.push_back(PackTrigram(padded, i));
+            }
+            std::sort(trigrams.begin(), trigrams.end());
+            trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+            return trigrams;
+        }
+
+        // Myers' algorithm, one title at a time. Returns the smallest edit distance between
+        // the pattern and any substring of the text.
+        uint32_t DistanceScalar(const PeqTable &peq, size_t m, std::string_view text)
+        {
+            const uint64_t high = uint64_t{1} << (m - 1);
+            uint64_t pv = ~uint64_t{0};
+            uint64_t mv = 0;
+            uint32_t score = static_cast<uint32_t>(m);
+            uint32_t best = score;
+            for (const char c : text)
+            {
+                const uint64_t eq = peq[static_cast<unsigned char>(c)];
+                const uint64_t xv = eq | mv;
+                const uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+                uint64_t ph = mv | ~(xh | pv);
+                uint64_t mh = pv & xh;
+                score += (ph & high) ? 1 : 0;
+                score -= (mh & high) ? 1 : 0;
+                ph <<= 1; // No carry in: a match may start anywhere in the title
+                mh <<= 1;
+                pv = mh | ~(xv | ph);
+                mv = ph & xv;
+                best = std::min(best, score);
+            }
+            return best;
+        }
+
+        // Padding past the end of a shorter title uses byte 0, which is never part of a
+        // pattern. A mismatch can never lower the last row, so the minimum is unaffected.
+        inline uint64_t PeqAt(const PeqTable &peq, std::string_view text, size_t j)
+        {
+            return j < text.size() ? peq[static_cast<unsigned char>(text[j])] : 0;
+        }
+
+#ifdef APP_FUZZY_X86
+        // Two titles per 128-bit register. Scores stay far below 2^31, so a signed 32-bit
+        // compare is enough to take the per-lane minimum (the upper halves are both zero).
+        void DistanceSse2(const PeqTable &peq, size_t m, const std::string_view *texts, uint32_t *out)
+        {
+            const size_t length = std::max(texts[0].size(), texts[1].size());
+            const __m128i ones = _mm_set1_epi64x(-1);
+            const __m128i one = _mm_set1_epi64x(1);
+            const __m128i shift = _mm_cvtsi32_si128(static_cast<int>(m - 1));
+            __m128i pv = ones;
+            __m128i mv = _mm_setzero_si128();
+            __m128i score = _mm_set1_epi64x(static_cast<int64_t>(m));
+            __m128i best = score;
+
+            for (size_t j = 0; j < length; ++j)
+            {
+                const __m128i eq = _mm_set_epi64x(static_cast<int64_t>(PeqAt(peq, texts[1], j)),
+                                                  static_cast<int64_t>(PeqAt(peq, texts[0], j)));
+                const __m128i xv = _mm_or_si128(eq, mv);
+                const __m128i xh = _mm_or_si128(_mm_xor_si128(_mm_add_epi64(_mm_and_si128(eq, pv), pv), pv), eq);
+                __m128i ph = _mm_or_si128(mv, _mm_xor_si128(_mm_or_si128(xh, pv), ones));
+                __m128i mh = _mm_and_si128(pv, xh);
+                score = _mm_add_epi64(score, _mm_and_si128(_mm_srl_epi64(ph, shift), one));
+                score = _mm_sub_epi64(score, _mm_and_si128(_mm_srl_epi64(mh, shift), one));
+                ph = _mm_slli_epi64(ph, 1);
+                mh = _mm_slli_epi64(mh, 1);
+                pv = _mm_or_si128(mh, _mm_xor_si128(_mm_or_si128(xv, ph), ones));
+                mv = _mm_and_si128(ph, xv);
+                const __m128i lower = _mm_cmplt_epi32(score, best);
+                best = _mm_or_si128(_mm_and_si128(lower, score), _mm_andnot_si128(lower, best));
+            }
+
+            alignas(16) int64_t lanes[2];
+            _mm_store_si128(reinterpret_cast<__m128i *>(lanes), best);
+            out[0] = static_cast<uint32_t>(lanes[0]);
+            out[1] = static_cast<uint32_t>(lanes[1]);
+        }
+
+        // Four titles per 256-bit register, same scheme as DistanceSse2
+        APP_TARGET_AVX2 void DistanceAvx2(const PeqTable &peq, size_t m, const std::string_view *texts, uint32_t *out)
+        {
+            const size_t length = std::max(std::max(texts[0].size(), texts[1].size()),
+                                           std::max(texts[2].size(), texts[3].size()));
+            const __m256i ones = _mm256_set1_epi64x(-1);
+            const __m256i one = _mm256_set1_epi64x(1);
+            const __m128i shift = _mm_cvtsi32_si128(static_cast<int>(m - 1));
+            __m256i pv = ones;
+            __m256i mv = _mm256_setzero_si256();
+            __m256i score = _mm256_set1_epi64x(static_cast<int64_t>(m));
+            __m256i best = score;
+
+            for (size_t j = 0; j < length; ++j)
+            {
+                const __m256i eq = _mm256_set_epi64x(static_cast<int64_t>(PeqAt(peq, texts[3], j)),
+                                                     static_cast<int64_t>(PeqAt(peq, texts[2], j)),
+                                                     static_cast<int64_t>(PeqAt(peq, texts[1], j)),
+                                                     static_cast<int64_t>(PeqAt(peq, texts[0], j)));
+                const __m256i xv = _mm256_or_si256(eq, mv);
+                const __m256i xh = _mm256_or_si256(_mm256_xor_si256(_mm256_add_epi64(_mm256_and_si256(eq, pv), pv), pv), eq);
+                __m256i ph = _mm256_or_si256(mv, _mm256_xor_si256(_mm256_or_si256(xh, pv), ones));
+                __m256i mh = _mm256_and_si256(pv, xh);
+                score = _mm256_add_epi64(score, _mm256_and_si256(_mm256_srl_epi64(ph, shift), one));
+                score = _mm256_sub_epi64(score, _mm256_and_si256(_mm256_srl_epi64(mh, shift), one));
+                ph = _mm256_slli_epi64(ph, 1);
+                mh = _mm256_slli_epi64(mh, 1);
+                pv = _mm256_or_si256(mh, _mm256_xor_si256(_mm256_or_si256(xv, ph), ones));
+                mv = _mm256_and_si256(ph, xv);
+                best = _mm256_blendv_epi8(best, score, _mm256_cmpgt_epi32(best, score));
+            }
+
+            alignas(32) int64_t lanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), best);
+            for (int i = 0; i < 4; ++i)
+            {
+                out[i] = static_cast<uint32_t>(lanes[i]);
+            }
+        }
+#endif
+
+        void Distances(FuzzyMatcher::Kernel kernel, const PeqTable &peq, size_t m,
+                       const std::vector<std::string_view> &texts, std::vector<uint32_t> &out)
+        {
+            out.resize(texts.size());
+            size_t i = 0;
+#ifdef APP_FUZZY_X86
+            if (kernel == FuzzyMatcher::Kernel::Avx2)
+            {
+                for (; i + 4 <= texts.size(); i += 4)
+                {
+                    DistanceAvx2(peq, m, &texts[i], &out[i]);
+                }
+            }
+            if (kernel != FuzzyMatcher::Kernel::Scalar)
+            {
+                for (; i + 2 <= texts.size(); i += 2)
+                {
+                    DistanceSse2(peq, m, &texts[i], &out[i]);
+                }
+            }
+#else
+            (void)kernel;
+#endif
+            for (; i < texts.size(); ++i)
+            {
+                out[i] = DistanceScalar(peq, m, texts[i]);
+            }
+        }
+
+        uint32_t MaxDistance(size_t patternLength)
+        {
+            return patternLength <= 4 ? 1 : patternLength <= 8 ? 2 : 3;
+        }
+    }
+
+    FuzzyMatcher::Kernel FuzzyMatcher::DetectKernel()
+    {
+#ifdef APP_FUZZY_X86
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        const bool osSavesYmm = (info[2] & (1 << 27)) && ((_xgetbv(0) & 0x6) == 0x6);
+        __cpuidex(info, 7, 0);
+        const bool avx2 = osSavesYmm && (info[1] & (1 << 5));
+#else
+        const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+        return avx2 ? Kernel::Avx2 : Kernel::Sse2; // SSE2 is part of x86-64
+#else
+        return Kernel::Scalar;
+#endif
+    }
+
+    void FuzzyMatcher::Add(std::string_view title, float popularity)
+    {
+        std::string folded = " " + TextTokenizer::Fold(title) + " ";
+        if (folded.size() < 3 + 2)
+        {
+            return;
+        }
+
+        auto [it, inserted] = foldedToTitle_.try_emplace(folded, static_cast<uint32_t>(titles_.size()));
+        if (!inserted)
+        {
+            auto &existing = titles_[it->second];
+            existing.popularity = std::max(existing.popularity, popularity);
+            return;
+        }
+
+        for (const uint32_t trigram : UniqueTrigrams(folded))
+        {
+            trigrams_[trigram].push_back(it->second);
+        }
+        titles_.push_back({std::string(title), std::move(folded), popularity});
+    }
+
+    std::vector<TitleSuggestion> FuzzyMatcher::Suggest(std::string_view query, size_t limit) const
+    {
+        static const Kernel kernel = DetectKernel();
+        return Suggest(query, limit, kernel);
+    }
+
+    std::vector<TitleSuggestion> FuzzyMatcher::Suggest(std::string_view query, size_t limit, Kernel kernel) const
+    {
+        std::string pattern = TextTokenizer::Fold(query);
+        if (pattern.size() > kMaxPatternLength)
+        {
+            pattern.resize(kMaxPatternLength);
+        }
+        if (pattern.size() < 3 || limit == 0 || titles_.empty())
+        {
+            return {};
+        }
+
+        // Step 1: Titles sharing enough trigrams with the query
+        const uint32_t maxDistance = MaxDistance(pattern.size());
+        const auto queryTrigrams = UniqueTrigrams(" " + pattern + " ");
+        const size_t needed = queryTrigrams.size() > 3 * maxDistance ? queryTrigrams.size() - 3 * maxDistance : 1;
+
+        // Rarest lists first. A title sharing `needed` of the T trigrams must be in at least
+        // one of the T - needed + 1 rarest lists, so only those are scanned for candidates;
+        // the long, common lists are then only probed for the titles already found.
+        std::vector<const std::vector<uint32_t> *> lists;
+        lists.reserve(queryTrigrams.size());
+        size_t missingTrigrams = 0;
+        for (const uint32_t trigram : queryTrigrams)
+        {
+            auto it = trigrams_.find(trigram);
+            if (it != trigrams_.end())
+            {
+                lists.push_back(&it->second);
+            }
+            else
+            {
+                ++missingTrigrams;
+            }
+        }
+        if (queryTrigrams.size() - missingTrigrams < needed)
+        {
+            return {};
+        }
+        std::sort(lists.begin(), lists.end(), [](const auto *a, const auto *b)
+                  { return a->size() < b->size(); });
+        size_t scanned = std::min(lists.size(), queryTrigrams.size() - needed + 1 - missingTrigrams);
+
+        // Probing only pays off while the scanned lists are short; for queries made of
+        // common trigrams it is cheaper to simply count every list
+        size_t scannedLength = 0;
+        size_t totalLength = 0;
+        for (size_t l = 0; l < lists.size(); ++l)
+        {
+            (l < scanned ? scannedLength : totalLength) += lists[l]->size();
+        }
+        totalLength += scannedLength;
+        if (scannedLength * 4 * (lists.size() - scanned) > totalLength)
+        {
+            scanned = lists.size();
+        }
+
+        thread_local std::vector<uint8_t> shared;
+        thread_local std::vector<uint32_t> touched;
+        shared.resize(titles_.size());
+        touched.clear();
+        for (size_t l = 0; l < scanned; ++l)
+        {
+            for (const uint32_t titleId : *lists[l])
+            {
+                if (shared[titleId]++ == 0)
+                {
+                    touched.push_back(titleId);
+                }
+            }
+        }
+
+        // Title ids are appended in order, so every list is sorted
+        std::vector<uint32_t> candidates;
+        for (const uint32_t titleId : touched)
+        {
+            size_t count = shared[titleId];
+            for (size_t l = scanned; l < lists.size() && count < needed && count + (lists.size() - l) >= needed; ++l)
+            {
+                count += std::binary_search(lists[l]->begin(), lists[l]->end(), titleId) ? 1 : 0;
+            }
+            shared[titleId] = static_cast<uint8_t>(count);
+            if (count >= needed)
+            {
+                candidates.push_back(titleId);
+            }
+        }
+        if (candidates.size() > kMaxCandidates)
+        {
+            std::nth_element(candidates.begin(), candidates.begin() + kMaxCandidates, candidates.end(),
+                             [&](uint32_t a, uint32_t b)
+                             { return shared[a] > shared[b]; });
+            candidates.resize(kMaxCandidates);
+        }
+        for (const uint32_t titleId : touched)
+        {
+            shared[titleId] = 0;
+        }
+
+        // Step 2: Verify with the bit-parallel edit distance
+        PeqTable peq{};
+        for (size_t i = 0; i < pattern.size(); ++i)
+        {
+            peq[static_cast<unsigned char>(pattern[i])] |= uint64_t{1} << i;
+        }
+
+        std::vector<std::string_view> texts;
+        texts.reserve(candidates.size());
+        for (const uint32_t titleId : candidates)
+        {
+            texts.emplace_back(titles_[titleId].folded);
+        }
+        std::vector<uint32_t> distances;
+        Distances(kernel, peq, pattern.size(), texts, distances);
+
+        // Step 3: Closest first, then the title closest in length, then the most popular
+        std::vector<std::pair<uint32_t, uint32_t>> matches; // (distance, titleId)
+        for (size_t i = 0; i < candidates.size(); ++i)
+        {
+            if (distances[i] <= maxDistance)
+            {
+                matches.emplace_back(distances[i], candidates[i]);
+            }
+        }
+        auto lengthGap = [&](uint32_t titleId)
+        {
+            const size_t length = titles_[titleId].folded.size() - 2;
+            return length > pattern.size() ? length - pattern.size() : pattern.size() - length;
+        };
+        std::sort(matches.begin(), matches.end(), [&](const auto &a, const auto &b)
+                  {
+            if (a.first != b.first) {
+                return a.first < b.first;
+            }
+            const size_t gapA = lengthGap(a.second);
+            const size_t gapB = lengthGap(b.second);
+            if (gapA != gapB) {
+                return gapA < gapB;
+            }
+            return titles_[a.second].popularity > titles_[b.second].popularity; });
+
+        std::vector<TitleSuggestion> suggestions;
+        for (size_t i = 0; i < matches.size() && suggestions.size() < limit; ++i)
+        {
+            suggestions.push_back({titles_[matches[i].second].display, matches[i].first});
+        }
+        return suggestions;
+    }
+} // namespace app::services
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace app::services
+{
+    struct TitleSuggestion
+    {
+        std::string title;
+        uint32_t distance = 0; // Edits between the query and the best matching part of the title
+    };
+
+    // Typo-tolerant lookup over known titles, for "did you mean" suggestions.
+    //
+    // Candidates come from a trigram index: k edits can destroy at most 3k of the query's
+    // trigrams, so titles sharing fewer are skipped without being looked at. Survivors are
+    // verified with Myers' bit-parallel edit distance, several titles per SIMD register
+    // when the CPU has AVX2 or SSE2. Matching is semi-global, "godfater" finds
+    // "The Godfather Part II" with one edit.
+    class FuzzyMatcher
+    {
+    public:
+        static constexpr size_t kMaxPatternLength = 64; // Longer queries are truncated
+        static constexpr size_t kMaxCandidates = 512;
+
+        void Add(std::string_view title, float popularity);
+        std::vector<TitleSuggestion> Suggest(std::string_view query, size_t limit) const;
+        size_t Size() const { return titles_.size(); }
+
+        // Exposed for benchmarking the kernels against each other
+        enum class Kernel
+        {
+            Scalar,
+            Sse2,
+            Avx2
+        };
+        static Kernel DetectKernel();
+        std::vector<TitleSuggestion> Suggest(std::string_view query, size_t limit, Kernel kernel) const;
+
+    private:
+        struct Title
+        {
+            std::string display;
+            std::string folded; // Space padded, see TextTokenizer::Fold
+            float popularity = 0.0f;
+        };
+
+        std::vector<Title> titles_;
+        std::unordered_map<std::string, uint32_t> foldedToTitle_;
+        std::unordered_map<uint32_t, std::vector<uint32_t>> trigrams_; // Packed trigram -> title ids
+    };
+} // namespace app::services
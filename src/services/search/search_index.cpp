@@ -0,0 +1,379 @@
+#include "search_index.hpp"
+#include "text_tokenizer.hpp"
+#include "services/cache/page_codec.hpp"
+#include "core/utils/logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <nlohmann/json.hpp>
+
+namespace app::services
+{
+    namespace
+    {
+        constexpr float kK1 = 1.2f;
+        constexpr float kB = 0.75f;
+        constexpr uint32_t kTitleWeight = 3;
+        constexpr uint32_t kOriginalTitleWeight = 2;
+        constexpr uint32_t kOverviewWeight = 1;
+        constexpr size_t kMaxPrefixExpansions = 64;
+        constexpr float kPrefixMatchFactor = 0.7f; // "matr" should rank "matrix" below an exact "matr"
+        constexpr int kJsonFormatVersion = 1;
+
+        void PutVarint(std::vector<uint8_t> &out, uint32_t value)
+        {
+            while (value >= 0x80)
+            {
+                out.push_back(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<uint8_t>(value));
+        }
+
+        uint32_t GetVarint(const uint8_t *&p)
+        {
+            uint32_t value = 0;
+            for (int shift = 0;; shift += 7)
+            {
+                const uint8_t byte = *p++;
+                value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80))
+                {
+                    return value;
+                }
+            }
+        }
+
+        std::string DocumentKey(const domain::MediaMetadata &item)
+        {
+            return item.id.source + ":" + item.id.id;
+        }
+
+        bool SameText(const domain::MediaMetadata &a, const domain::MediaMetadata &b)
+        {
+            return a.title == b.title && a.originalTitle == b.originalTitle && a.overview == b.overview;
+        }
+
+        // The JSON format written before the index was saved as a binary page, read for migration
+        domain::MediaMetadata FromJson(const nlohmann::json &json)
+        {
+            domain::MediaMetadata item;
+            item.id.id = json.at("id").get<std::string>();
+            item.id.source = json.at("source").get<std::string>();
+            item.id.type = static_cast<domain::MediaType>(json.value("type", 0));
+            item.title = json.at("title").get<std::string>();
+            item.overview = json.value("overview", std::string());
+            for (const auto &genre : json.value("genres", std::vector<std::string>()))
+            {
+                item.genres.Add(genre);
+            }
+            item.releaseDate = std::chrono::sys_days(std::chrono::days(json.value("released", 0)));
+            item.rating = json.value("rating", 0.0f);
+            item.voteCount = json.value("votes", 0);
+            item.popularity = json.value("popularity", 0.0f);
+            item.normalizedRating = json.value("normalizedRating", 0.0f);
+            item.externalIds.imdb = json.value("imdb", std::string());
+            item.externalIds.tmdb = json.value("tmdb", std::string());
+            if (json.contains("originalTitle"))
+                item.originalTitle = json["originalTitle"].get<std::string>();
+            if (json.contains("poster"))
+                item.posterPath = domain::ImagePath::FromUrl(json["poster"].get<std::string>());
+            if (json.contains("backdrop"))
+                item.backdropPath = domain::ImagePath::FromUrl(json["backdrop"].get<std::string>());
+            return item;
+        }
+    }
+
+    SearchIndex &SearchIndex::Instance()
+    {
+        static SearchIndex instance;
+        return instance;
+    }
+
+    void SearchIndex::Add(const std::vector<domain::MediaMetadata> &items)
+    {
+        std::unique_lock lock(mutex_);
+        for (const auto &item : items)
+        {
+            AddLocked(item);
+        }
+
+        // Rebuild once a quarter of the documents are stale
+        if (documents_.size() - liveDocuments_ > std::max<size_t>(1024, liveDocuments_ / 4))
+        {
+            CompactLocked();
+        }
+    }
+
+    void SearchIndex::AddLocked(const domain::MediaMetadata &item)
+    {
+        auto [it, inserted] = idToDoc_.try_emplace(DocumentKey(item), static_cast<uint32_t>(documents_.size()));
+        if (!inserted)
+        {
+            auto &existing = documents_[it->second];
+            if (SameText(existing.item, item))
+            {
+                existing.item = item; // Ratings, artwork etc. only, the postings still hold
+                return;
+            }
+
+            existing.deleted = true;
+            totalLength_ -= existing.length;
+            --liveDocuments_;
+            it->second = static_cast<uint32_t>(documents_.size());
+        }
+
+        documents_.push_back({item});
+        IndexLocked(it->second);
+
+        titles_.Add(item.title, item.popularity);
+        if (item.originalTitle && *item.originalTitle != item.title)
+        {
+            titles_.Add(*item.originalTitle, item.popularity);
+        }
+    }
+
+    void SearchIndex::IndexLocked(uint32_t docId)
+    {
+        auto &document = documents_[docId];
+
+        std::unordered_map<std::string, uint32_t> frequencies;
+        std::vector<std::string> tokens;
+        auto addField = [&](const std::string &text, uint32_t weight)
+        {
+            tokens.clear();
+            TextTokenizer::Tokenize(text, tokens);
+            for (auto &token : tokens)
+            {
+                frequencies[std::move(token)] += weight;
+                document.length += static_cast<float>(weight);
+            }
+        };
+        addField(document.item.title, kTitleWeight);
+        if (document.item.originalTitle && *document.item.originalTitle != document.item.title)
+        {
+            addField(*document.item.originalTitle, kOriginalTitleWeight);
+        }
+        addField(document.item.overview, kOverviewWeight);
+
+        for (const auto &[term, frequency] : frequencies)
+        {
+            auto &postings = terms_[term];
+            PutVarint(postings.bytes, docId - postings.lastDoc);
+            PutVarint(postings.bytes, frequency);
+            postings.lastDoc = docId;
+            ++postings.docCount;
+        }
+
+        totalLength_ += document.length;
+        ++liveDocuments_;
+    }
+
+    void SearchIndex::CompactLocked()
+    {
+        const auto started = std::chrono::steady_clock::now();
+        std::vector<Document> live;
+        live.reserve(liveDocuments_);
+        for (auto &document : documents_)
+        {
+            if (!document.deleted)
+            {
+                live.push_back({std::move(document.item)});
+            }
+        }
+
+        documents_ = std::move(live);
+        idToDoc_.clear();
+        terms_.clear();
+        liveDocuments_ = 0;
+        totalLength_ = 0.0;
+        for (uint32_t docId = 0; docId < documents_.size(); ++docId)
+        {
+            idToDoc_[DocumentKey(documents_[docId].item)] = docId;
+            IndexLocked(docId);
+        }
+
+        utils::Logger::Debug(fmt::format("Search index compacted to {} documents in {}ms", documents_.size(),
+                                         std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started).count()));
+    }
+
+    void SearchIndex::ScoreTermLocked(const PostingList &postings, std::vector<float> &scores) const
+    {
+        const float n = static_cast<float>(liveDocuments_);
+        const float df = static_cast<float>(postings.docCount);
+        const float idf = std::log(1.0f + (n - df + 0.5f) / (df + 0.5f));
+        const float averageLength = static_cast<float>(totalLength_ / static_cast<double>(std::max<size_t>(liveDocuments_, 1)));
+
+        const uint8_t *p = postings.bytes.data();
+        const uint8_t *end = p + postings.bytes.size();
+        uint32_t docId = 0;
+        while (p < end)
+        {
+            docId += GetVarint(p);
+            const float tf = static_cast<float>(GetVarint(p));
+            const float norm = kK1 * (1.0f - kB + kB * documents_[docId].length / averageLength);
+            scores[docId] += idf * tf * (kK1 + 1.0f) / (tf + norm);
+        }
+    }
+
+    std::vector<domain::MediaMetadata> SearchIndex::Search(const std::string &query, size_t limit, const Filter &accept) const
+    {
+        std::vector<std::string> tokens;
+        TextTokenizer::Tokenize(query, tokens);
+        if (tokens.empty() || limit == 0)
+        {
+            return {};
+        }
+
+        std::shared_lock lock(mutex_);
+        std::vector<float> scores(documents_.size(), 0.0f);
+        for (size_t i = 0; i < tokens.size(); ++i)
+        {
+            if (i + 1 < tokens.size())
+            {
+                if (auto it = terms_.find(tokens[i]); it != terms_.end())
+                {
+                    ScoreTermLocked(it->second, scores);
+                }
+                continue;
+            }
+
+            // The last token may still be incomplete, so it also matches as a prefix
+            std::vector<float> prefixScores(documents_.size(), 0.0f);
+            size_t expansions = 0;
+            for (auto it = terms_.lower_bound(tokens[i]);
+                 it != terms_.end() && it->first.starts_with(tokens[i]) && expansions < kMaxPrefixExpansions;
+                 ++it, ++expansions)
+            {
+                ScoreTermLocked(it->second, it->first == tokens[i] ? scores : prefixScores);
+            }
+            for (size_t docId = 0; docId < scores.size(); ++docId)
+            {
+                scores[docId] += kPrefixMatchFactor * prefixScores[docId];
+            }
+        }
+
+        std::vector<std::pair<float, uint32_t>> hits;
+        for (uint32_t docId = 0; docId < scores.size(); ++docId)
+        {
+            if (scores[docId] > 0.0f && !documents_[docId].deleted && (!accept || accept(documents_[docId].item)))
+            {
+                hits.emplace_back(scores[docId], docId);
+            }
+        }
+
+        const size_t count = std::min(limit, hits.size());
+        std::partial_sort(hits.begin(), hits.begin() + static_cast<std::ptrdiff_t>(count), hits.end(),
+                          [](const auto &a, const auto &b)
+                          { return a.first > b.first; });
+
+        std::vector<domain::MediaMetadata> results;
+        results.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            results.push_back(documents_[hits[i].second].item);
+        }
+        return results;
+    }
+
+    std::vector<TitleSuggestion> SearchIndex::Suggest(const std::string &query, size_t limit) const
+    {
+        std::shared_lock lock(mutex_);
+        return titles_.Suggest(query, limit);
+    }
+
+    size_t SearchIndex::Size() const
+    {
+        std::shared_lock lock(mutex_);
+        return liveDocuments_;
+    }
+
+    std::vector<domain::MediaMetadata> SearchIndex::Items() const
+    {
+        std::shared_lock lock(mutex_);
+        std::vector<domain::MediaMetadata> items;
+        items.reserve(liveDocuments_);
+        for (const auto &document : documents_)
+        {
+            if (!document.deleted)
+            {
+                items.push_back(document.item);
+            }
+        }
+        return items;
+    }
+
+    utils::Result<void> SearchIndex::Save(const std::string &path) const
+    {
+        try
+        {
+            const auto page = PageCodec::Encode(Items());
+
+            // Write next to the target and rename, so a crash never leaves a torn file
+            const std::string tempPath = path + ".tmp";
+            {
+                std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+                if (!file.is_open())
+                {
+                    return utils::Result<void>::Error("Failed to open search index file: " + tempPath);
+                }
+                file.write(reinterpret_cast<const char *>(page.data()), static_cast<std::streamsize>(page.size()));
+            }
+            std::filesystem::rename(tempPath, path);
+            return utils::Result<void>();
+        }
+        catch (const std::exception &e)
+        {
+            return utils::Result<void>::Error(std::string("Failed to save search index: ") + e.what());
+        }
+    }
+
+    utils::Result<void> SearchIndex::Load(const std::string &path)
+    {
+        try
+        {
+            std::ifstream file(path, std::ios::binary);
+            if (!file.is_open())
+            {
+                return utils::Result<void>::Error("Failed to open search index file: " + path);
+            }
+            const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+            std::vector<domain::MediaMetadata> items;
+            if (PageCodec::IsPage(bytes))
+            {
+                auto page = PageView::Open(bytes);
+                if (page.IsError())
+                {
+                    return utils::Result<void>::Error(fmt::format("Unreadable search index {}: {}", path, page.GetError().message));
+                }
+                items = page.Value().ToMetadata();
+            }
+            else
+            {
+                const auto json = nlohmann::json::parse(bytes);
+                if (json.value("version", 0) != kJsonFormatVersion)
+                {
+                    return utils::Result<void>::Error("Unsupported search index version in " + path);
+                }
+                for (const auto &item : json.at("items"))
+                {
+                    items.push_back(FromJson(item));
+                }
+            }
+            Add(items);
+
+            utils::Logger::Info(fmt::format("Loaded {} search index entries from {}", items.size(), path));
+            return utils::Result<void>();
+        }
+        catch (const std::exception &e)
+        {
+            return utils::Result<void>::Error(std::string("Failed to load search index: ") + e.what());
+        }
+    }
+} // namespace app::services
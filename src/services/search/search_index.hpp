@@ -0,0 +1,75 @@
+#pragma once
+#include "domain/models/media_types.hpp"
+#include "core/utils/result.hpp"
+#include "services/search/fuzzy_matcher.hpp"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace app::services
+{
+    // In-process full-text index over every item the providers have returned, so search
+    // can answer from memory while the network requests are still in flight.
+    //
+    // Title, original title and overview are tokenized with TextTokenizer and scored with
+    // BM25, title matches weighing the most. The last query token also matches as a prefix
+    // so results show up while the user is still typing. Posting lists are delta + varint
+    // encoded and only ever appended to: an updated item gets a new document id and its
+    // old one is tombstoned until the next compaction.
+    class SearchIndex
+    {
+    public:
+        using Filter = std::function<bool(const domain::MediaMetadata &)>;
+
+        static SearchIndex &Instance();
+
+        // Adds or updates items, keyed by "source:id"
+        void Add(const std::vector<domain::MediaMetadata> &items);
+        std::vector<domain::MediaMetadata> Search(const std::string &query, size_t limit, const Filter &accept = {}) const;
+
+        // "Did you mean" titles for a query that may be misspelled
+        std::vector<TitleSuggestion> Suggest(const std::string &query, size_t limit) const;
+
+        size_t Size() const;
+        std::vector<domain::MediaMetadata> Items() const; // Every live item, in insertion order
+
+        // Persisted as a PageCodec page of the indexed items; postings are rebuilt on load.
+        // Load also reads the JSON files written by earlier versions.
+        utils::Result<void> Save(const std::string &path) const;
+        utils::Result<void> Load(const std::string &path);
+
+    private:
+        SearchIndex() = default;
+
+        struct PostingList
+        {
+            std::vector<uint8_t> bytes; // (docId delta, weighted tf) varint pairs
+            uint32_t lastDoc = 0;
+            uint32_t docCount = 0;
+        };
+
+        struct Document
+        {
+            domain::MediaMetadata item;
+            float length = 0.0f; // Weighted token count
+            bool deleted = false;
+        };
+
+        void AddLocked(const domain::MediaMetadata &item);
+        void IndexLocked(uint32_t docId);
+        void CompactLocked();
+        void ScoreTermLocked(const PostingList &postings, std::vector<float> &scores) const;
+
+        mutable std::shared_mutex mutex_;
+        std::vector<Document> documents_;
+        std::unordered_map<std::string, uint32_t> idToDoc_;
+        std::map<std::string, PostingList, std::less<>> terms_; // Ordered for prefix lookups
+        FuzzyMatcher titles_;                                   // Every title ever indexed
+        size_t liveDocuments_ = 0;
+        double totalLength_ = 0.0;
+    };
+} // namespace app::services
@@ -0,0 +1,240 @@
+#include "text_tokenizer.hpp"
+#include <array>
+#include <cstdint>
+
+namespace app::services
+{
+    namespace
+    {
+        enum class CharClass
+        {
+            Separator,
+            Letter,
+            Ideograph // Stands alone as a token
+        };
+
+        // Decodes one UTF-8 sequence, advancing pos. Malformed bytes decode as U+FFFD.
+        char32_t NextCodepoint(std::string_view text, size_t &pos)
+        {
+            const auto lead = static_cast<unsigned char>(text[pos++]);
+            if (lead < 0x80)
+            {
+                return lead;
+            }
+
+            size_t extra = 0;
+            char32_t cp = 0;
+            if ((lead & 0xE0) == 0xC0)
+            {
+                extra = 1;
+                cp = lead & 0x1F;
+            }
+            else if ((lead & 0xF0) == 0xE0)
+            {
+                extra = 2;
+                cp = lead & 0x0F;
+            }
+            else if ((lead & 0xF8) == 0xF0)
+            {
+                extra = 3;
+                cp = lead & 0x07;
+            }
+            else
+            {
+                return 0xFFFD;
+            }
+
+            for (size_t i = 0; i < extra; ++i)
+            {
+                if (pos >= text.size() || (static_cast<unsigned char>(text[pos]) & 0xC0) != 0x80)
+                {
+                    return 0xFFFD;
+                }
+                cp = (cp << 6) | (static_cast<unsigned char>(text[pos++]) & 0x3F);
+            }
+            return cp;
+        }
+
+        void AppendUtf8(char32_t cp, std::string &out)
+        {
+            if (cp < 0x80)
+            {
+                out.push_back(static_cast<char>(cp));
+            }
+            else if (cp < 0x800)
+            {
+                out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+                out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            }
+            else if (cp < 0x10000)
+            {
+                out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+                out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            }
+            else
+            {
+                out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+                out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            }
+        }
+
+        // Base letters for U+00C0..U+00FF; '*' marks multi-letter folds, ' ' separators
+        constexpr std::string_view kLatin1Fold = "aaaaaa*ceeeeiiiidnooooo ouuuuy**aaaaaa*ceeeeiiiidnooooo ouuuuy*y";
+
+        // Base letters for U+0100..U+017F (Latin Extended-A); '*' marks multi-letter folds
+        constexpr std::string_view kLatinExtAFold =
+            "aaaaaaccccccccddddeeeeeeeeeegggggggghhhhiiiiiiiiii**jjkkklllllllllln"
+            "nnnnnnnnoooooo**rrrrrrssssssssttttttuuuuuuuuuuuuwwyyyzzzzzzs";
+
+        static_assert(kLatin1Fold.size() == 0x40 && kLatinExtAFold.size() == 0x80);
+
+        std::string_view MultiLetterFold(char32_t cp)
+        {
+            switch (cp)
+            {
+            case 0xC6:
+            case 0xE6:
+                return "ae";
+            case 0xDE:
+            case 0xFE:
+                return "th";
+            case 0xDF:
+                return "ss";
+            case 0x132:
+            case 0x133:
+                return "ij";
+            case 0x152:
+            case 0x153:
+                return "oe";
+            default:
+                return {};
+            }
+        }
+
+        CharClass Classify(char32_t cp)
+        {
+            if (cp < 0x80)
+            {
+                return ((cp >= 'a' && cp <= 'z') || (cp >= 'A' && cp <= 'Z') || (cp >= '0' && cp <= '9'))
+                           ? CharClass::Letter
+                           : CharClass::Separator;
+            }
+            if (cp < 0xC0 || cp == 0xD7 || cp == 0xF7 ||               // Latin-1 punctuation, × and ÷
+                (cp >= 0x2000 && cp <= 0x206F) ||                    // General punctuation (dashes, quotes)
+                (cp >= 0x3000 && cp <= 0x303F) || (cp >= 0xFF00 && cp <= 0xFF0F) || // CJK punctuation
+                cp == 0xFFFD)
+            {
+                return CharClass::Separator;
+            }
+            if ((cp >= 0x3040 && cp <= 0x30FF) || // Kana
+                (cp >= 0x3400 && cp <= 0x9FFF) || // CJK ideographs
+                (cp >= 0xAC00 && cp <= 0xD7AF))   // Hangul syllables
+            {
+                return CharClass::Ideograph;
+            }
+            return CharClass::Letter;
+        }
+
+        // Appends the folded form of a letter
+        void AppendFolded(char32_t cp, std::string &out)
+        {
+            if (cp < 0x80)
+            {
+                out.push_back(static_cast<char>(cp >= 'A' && cp <= 'Z' ? cp - 'A' + 'a' : cp));
+                return;
+            }
+
+            char base = 0;
+            if (cp >= 0xC0 && cp <= 0xFF)
+            {
+                base = kLatin1Fold[cp - 0xC0];
+            }
+            else if (cp >= 0x100 && cp <= 0x17F)
+            {
+                base = kLatinExtAFold[cp - 0x100];
+            }
+
+            if (base == '*')
+            {
+                out.append(MultiLetterFold(cp));
+                return;
+            }
+            if (base != 0)
+            {
+                out.push_back(base);
+                return;
+            }
+
+            // Greek and Cyrillic capitals
+            if ((cp >= 0x391 && cp <= 0x3A9) || (cp >= 0x410 && cp <= 0x42F))
+            {
+                cp += 0x20;
+            }
+            else if (cp >= 0x400 && cp <= 0x40F)
+            {
+                cp += 0x50;
+            }
+            AppendUtf8(cp, out);
+        }
+
+        template <typename OnToken>
+        void Split(std::string_view text, OnToken &&onToken)
+        {
+            std::string token;
+            size_t pos = 0;
+            while (pos < text.size())
+            {
+                const char32_t cp = NextCodepoint(text, pos);
+                switch (Classify(cp))
+                {
+                case CharClass::Letter:
+                    AppendFolded(cp, token);
+                    break;
+                case CharClass::Ideograph:
+                    if (!token.empty())
+                    {
+                        onToken(token);
+                        token.clear();
+                    }
+                    AppendUtf8(cp, token);
+                    onToken(token);
+                    token.clear();
+                    break;
+                case CharClass::Separator:
+                    if (!token.empty())
+                    {
+                        onToken(token);
+                        token.clear();
+                    }
+                    break;
+                }
+            }
+            if (!token.empty())
+            {
+                onToken(token);
+            }
+        }
+    }
+
+    void TextTokenizer::Tokenize(std::string_view text, std::vector<std::string> &tokens)
+    {
+        Split(text, [&](const std::string &token)
+              { tokens.push_back(token); });
+    }
+
+    std::string TextTokenizer::Fold(std::string_view text)
+    {
+        std::string folded;
+        folded.reserve(text.size());
+        Split(text, [&](const std::string &token)
+              {
+            if (!folded.empty()) {
+                folded.push_back(' ');
+            }
+            folded += token; });
+        return folded;
+    }
+} // namespace app::services
@@ -0,0 +1,20 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace app::services
+{
+    // Splits text into search tokens. Tokens are case- and accent-folded ("Amélie" and
+    // "AMELIE" both give "amelie"), punctuation separates tokens, and CJK ideographs,
+    // kana and hangul become one token per character since they are not space separated.
+    class TextTokenizer
+    {
+    public:
+        static void Tokenize(std::string_view text, std::vector<std::string> &tokens);
+
+        // Folded form of the whole string with separators collapsed to single spaces,
+        // e.g. "Spider-Man: Homecoming" -> "spider man homecoming"
+        static std::string Fold(std::string_view text);
+    };
+} // namespace app::services
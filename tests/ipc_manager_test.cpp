@@ -0,0 +1,225 @@
+#include "ipc/ipc_manager.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <semaphore>
+#include <thread>
+#include <vector>
+
+using namespace app::ipc;
+using namespace std::chrono_literals;
+
+namespace
+{
+    // Long enough that only a blocked thread misses it
+    constexpr auto kTimeout = 5s;
+
+    // The page's side of a LoopbackTransport: collects responses by request id, batched or not
+    class Peer
+    {
+    public:
+        explicit Peer(LoopbackTransport &transport)
+        {
+            transport.SetPeerHandler([this](std::string_view message)
+                                     {
+                const auto response = json::parse(message);
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (response.contains("batch"))
+                    responses_.insert(responses_.end(), response["batch"].begin(), response["batch"].end());
+                else
+                    responses_.push_back(response);
+                arrived_.notify_all(); });
+        }
+
+        std::optional<json> Response(const std::string &id)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return Find(id);
+        }
+
+        std::optional<json> WaitFor(const std::string &id)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            std::optional<json> response;
+            arrived_.wait_for(lock, kTimeout, [&]
+                              { return (response = Find(id)).has_value(); });
+            return response;
+        }
+
+    private:
+        std::optional<json> Find(const std::string &id) const
+        {
+            for (const auto &response : responses_)
+            {
+                if (response.value("id", std::string()) == id)
+                    return response["payload"];
+            }
+            return std::nullopt;
+        }
+
+        std::mutex mutex_;
+        std::condition_variable arrived_;
+        std::vector<json> responses_;
+    };
+
+    // Holds worker handlers until the test lets them go
+    class Gate
+    {
+    public:
+        void Wait() { opened_.wait(); }
+        void Open() { promise_.set_value(); }
+
+    private:
+        std::promise<void> promise_;
+        std::shared_future<void> opened_ = promise_.get_future().share();
+    };
+
+    std::string Request(const std::string &type, const std::string &id)
+    {
+        return json{{"type", type}, {"id", id}, {"payload", json::object()}}.dump();
+    }
+
+    class IpcManagerTest : public ::testing::Test
+    {
+    protected:
+        void Start(size_t workers = IpcManager::kDefaultWorkers, size_t queueCapacity = IpcManager::kDefaultQueueCapacity)
+        {
+            manager_ = std::make_unique<IpcManager>(workers, queueCapacity);
+            manager_->RegisterHandler("blocking", [this](const json &, Responder respond)
+                                      {
+                started_.release();
+                gate_.Wait();
+                respond({{"success", true}}); });
+            manager_->RegisterHandler("ping", [this](const json &, Responder respond)
+                                      {
+                inlineThread_ = std::this_thread::get_id();
+                respond({{"success", true}, {"pong", true}}); }, IpcManager::Dispatch::Inline);
+
+            auto transport = std::make_unique<LoopbackTransport>();
+            transport_ = transport.get();
+            peer_ = std::make_unique<Peer>(*transport);
+            manager_->SetTransport(std::move(transport));
+        }
+
+        void TearDown() override
+        {
+            if (!opened_)
+                gate_.Open();
+            deliveries_.clear(); // A delivery that blocked returns once the gate is open
+            manager_.reset();
+        }
+
+        // Delivers on a thread of its own, as a transport's receiving thread would, and
+        // reports whether it came back in time
+        bool DeliverReturns(const std::string &message)
+        {
+            deliveries_.push_back(std::async(std::launch::async, [this, message]
+                                             { transport_->DeliverToHost(message); }));
+            return deliveries_.back().wait_for(kTimeout) == std::future_status::ready;
+        }
+
+        void OpenGate()
+        {
+            opened_ = true;
+            gate_.Open();
+        }
+
+        std::unique_ptr<IpcManager> manager_;
+        LoopbackTransport *transport_ = nullptr; // Owned by manager_
+        std::vector<std::future<void>> deliveries_;
+        std::unique_ptr<Peer> peer_;
+        Gate gate_;
+        bool opened_ = false;
+        std::counting_semaphore<> started_{0}; // Released as each blocking handler starts
+        std::thread::id inlineThread_;
+    };
+}
+
+TEST_F(IpcManagerTest, WorkerDispatchReturnsWhileTheHandlerBlocks)
+{
+    Start();
+    ASSERT_TRUE(DeliverReturns(Request("blocking", "1")));
+    ASSERT_TRUE(started_.try_acquire_for(kTimeout));
+    EXPECT_FALSE(peer_->Response("1"));
+
+    OpenGate();
+    const auto response = peer_->WaitFor("1");
+    ASSERT_TRUE(response);
+    EXPECT_TRUE(response->value("success", false));
+}
+
+TEST_F(IpcManagerTest, InlineDispatchAnswersOnTheReceivingThread)
+{
+    Start();
+    std::thread::id receivingThread;
+    deliveries_.push_back(std::async(std::launch::async, [&]
+                                     {
+        receivingThread = std::this_thread::get_id();
+        transport_->DeliverToHost(Request("ping", "1")); }));
+    ASSERT_EQ(deliveries_.back().wait_for(kTimeout), std::future_status::ready);
+
+    // Answered before DeliverToHost returned, on the thread that delivered it
+    EXPECT_EQ(inlineThread_, receivingThread);
+    const auto response = peer_->Response("1");
+    ASSERT_TRUE(response);
+    EXPECT_TRUE(response->value("pong", false));
+}
+
+TEST_F(IpcManagerTest, InlineRequestIsAnsweredWhileEveryWorkerIsBlocked)
+{
+    Start(2);
+    ASSERT_TRUE(DeliverReturns(Request("blocking", "1")));
+    ASSERT_TRUE(DeliverReturns(Request("blocking", "2")));
+    ASSERT_TRUE(started_.try_acquire_for(kTimeout));
+    ASSERT_TRUE(started_.try_acquire_for(kTimeout));
+
+    ASSERT_TRUE(DeliverReturns(Request("ping", "3")));
+    EXPECT_TRUE(peer_->Response("3"));
+    EXPECT_FALSE(peer_->Response("1"));
+    EXPECT_FALSE(peer_->Response("2"));
+}
+
+TEST_F(IpcManagerTest, FullQueueIsAnsweredBusyWithoutWaiting)
+{
+    Start(1, 1);
+    ASSERT_TRUE(DeliverReturns(Request("blocking", "1"))); // Runs
+    ASSERT_TRUE(started_.try_acquire_for(kTimeout));
+    ASSERT_TRUE(DeliverReturns(Request("blocking", "2"))); // Queued
+    ASSERT_TRUE(DeliverReturns(Request("blocking", "3"))); // No room
+
+    const auto busy = peer_->Response("3");
+    ASSERT_TRUE(busy);
+    EXPECT_FALSE(busy->value("success", true));
+    EXPECT_EQ(busy->value("code", 0), IpcManager::kBusyCode);
+    EXPECT_FALSE(peer_->Response("2"));
+
+    OpenGate();
+    EXPECT_TRUE(peer_->WaitFor("1"));
+    EXPECT_TRUE(peer_->WaitFor("2"));
+}
+
+TEST_F(IpcManagerTest, RequestsThatCannotBeDispatchedAreAnswered)
+{
+    Start();
+    const json batch = {{"type", "batch"},
+                        {"payload", {json::parse(Request("ping", "1")),
+                                     json::parse(Request("unknown", "2")),
+                                     {{"type", "ping"}, {"id", "3"}},
+                                     {{"type", "ping"}, {"payload", json::object()}}}}};
+    ASSERT_TRUE(DeliverReturns(batch.dump()));
+    ASSERT_TRUE(DeliverReturns(Request("unknown", "4")));
+
+    const auto ping = peer_->WaitFor("1");
+    ASSERT_TRUE(ping);
+    EXPECT_TRUE(ping->value("pong", false));
+    for (const auto *id : {"2", "3", "4"})
+    {
+        const auto rejected = peer_->WaitFor(id);
+        ASSERT_TRUE(rejected) << id;
+        EXPECT_FALSE(rejected->value("success", true)) << id;
+        EXPECT_FALSE(rejected->value("error", std::string()).empty()) << id;
+    }
+}
@@ -0,0 +1,330 @@
+#include "services/cache/page_codec.hpp"
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace app;
+using namespace app::services;
+
+namespace
+{
+    // Every optional field is present on some items and absent on others
+    domain::MediaMetadata MakeItem(int i)
+    {
+        domain::MediaMetadata item;
+        item.id.id = std::to_string(1000 + i);
+        item.id.type = static_cast<domain::MediaType>(i % 3);
+        item.id.source = i % 2 ? "tmdb" : "imdb";
+        if (i % 4 == 0)
+            item.id.original_id = "original-" + std::to_string(i);
+        item.title = "Title " + std::to_string(i);
+        if (i % 3 == 0)
+            item.originalTitle = "Original title " + std::to_string(i);
+        item.overview = std::string(50 + i, 'o');
+        item.genres.Add("Action");
+        if (i % 2)
+            item.genres.Add("Drama");
+        if (i % 5)
+            item.releaseDate = std::chrono::sys_days(std::chrono::days(10000 + i));
+        item.rating = static_cast<float>(i % 100) / 10.0f;
+        item.voteCount = i * 37;
+        item.popularity = static_cast<float>(i) * 1.5f;
+        item.normalizedRating = item.rating / 2;
+        item.posterPath = domain::ImagePath::FromUrl("https://image.tmdb.org/t/p/w500/poster" + std::to_string(i) + ".jpg");
+        if (i % 2)
+            item.backdropPath = domain::ImagePath::FromUrl("https://image.tmdb.org/t/p/w1280/backdrop" + std::to_string(i) + ".jpg");
+        if (i % 5)
+            item.externalIds.imdb = "tt" + std::to_string(1000000 + i);
+        item.externalIds.tmdb = item.id.id;
+        if (i % 3 == 1)
+            item.sourceRatings.push_back({"IMDb", 7.5f, "https://www.imdb.com/title/tt" + std::to_string(i), 120});
+        return item;
+    }
+
+    domain::MediaDetails MakeDetails(int i)
+    {
+        domain::MediaDetails details;
+        static_cast<domain::MediaMetadata &>(details) = MakeItem(i);
+        details.ratings.push_back({"RottenTomatoes", 0.9f, "https://www.rottentomatoes.com/m/" + std::to_string(i), 40});
+        details.reviews.push_back({"critic", "Great", "tmdb"});
+        details.availableProviders = {"netflix", "hulu"};
+        domain::EpisodeInfo episode;
+        episode.title = "Pilot";
+        episode.overview = "The first one";
+        episode.episodeNumber = 1;
+        episode.seasonNumber = i;
+        episode.airDate = std::chrono::sys_days(std::chrono::days(-5)); // Before the epoch
+        if (i % 2)
+            episode.stillPath = "/still.jpg";
+        details.episodes.push_back(episode);
+        return details;
+    }
+
+    std::vector<domain::MediaMetadata> MakePage(int count)
+    {
+        std::vector<domain::MediaMetadata> items;
+        for (int i = 0; i < count; ++i)
+        {
+            items.push_back(MakeItem(i));
+        }
+        return items;
+    }
+
+    void ExpectSameImage(const std::optional<domain::ImagePath> &expected, const std::optional<domain::ImagePath> &actual)
+    {
+        ASSERT_EQ(expected.has_value(), actual.has_value());
+        if (expected)
+        {
+            EXPECT_EQ(expected->Url(), actual->Url());
+        }
+    }
+
+    void ExpectSameRatings(const std::vector<domain::RatingSource> &expected, const std::vector<domain::RatingSource> &actual)
+    {
+        ASSERT_EQ(expected.size(), actual.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            EXPECT_EQ(expected[i].source, actual[i].source);
+            EXPECT_EQ(expected[i].value, actual[i].value);
+            EXPECT_EQ(expected[i].url, actual[i].url);
+            EXPECT_EQ(expected[i].votes, actual[i].votes);
+        }
+    }
+
+    void ExpectSameMetadata(const domain::MediaMetadata &expected, const domain::MediaMetadata &actual)
+    {
+        EXPECT_EQ(expected.id.id, actual.id.id);
+        EXPECT_EQ(expected.id.type, actual.id.type);
+        EXPECT_EQ(expected.id.source, actual.id.source);
+        EXPECT_EQ(expected.id.original_id, actual.id.original_id);
+        EXPECT_EQ(expected.title, actual.title);
+        EXPECT_EQ(expected.originalTitle, actual.originalTitle);
+        EXPECT_EQ(expected.overview, actual.overview);
+        EXPECT_TRUE(expected.genres == actual.genres);
+        EXPECT_EQ(expected.releaseDate, actual.releaseDate);
+        EXPECT_EQ(expected.rating, actual.rating);
+        EXPECT_EQ(expected.voteCount, actual.voteCount);
+        EXPECT_EQ(expected.popularity, actual.popularity);
+        EXPECT_EQ(expected.normalizedRating, actual.normalizedRating);
+        ExpectSameImage(expected.posterPath, actual.posterPath);
+        ExpectSameImage(expected.backdropPath, actual.backdropPath);
+        EXPECT_EQ(expected.externalIds.imdb, actual.externalIds.imdb);
+        EXPECT_EQ(expected.externalIds.tmdb, actual.externalIds.tmdb);
+        ExpectSameRatings(expected.sourceRatings, actual.sourceRatings);
+    }
+
+    void PutU32(std::vector<uint8_t> &bytes, size_t at, uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            bytes[at + i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+
+    uint32_t U32At(const std::vector<uint8_t> &bytes, size_t at)
+    {
+        return uint32_t{bytes[at]} | uint32_t{bytes[at + 1]} << 8 | uint32_t{bytes[at + 2]} << 16 | uint32_t{bytes[at + 3]} << 24;
+    }
+
+    constexpr size_t kRecordBytesAt = 20; // In the header
+    constexpr size_t kItemIndexAt = 24;
+}
+
+TEST(PageCodecTest, MetadataPageRoundTrips)
+{
+    const auto items = MakePage(60);
+    const auto bytes = PageCodec::Encode(items);
+    EXPECT_TRUE(PageCodec::IsPage(bytes));
+
+    const auto page = PageView::Open(bytes);
+    ASSERT_TRUE(page.IsOk()) << page.GetError().message;
+    EXPECT_EQ(page.Value().GetKind(), PageCodec::Kind::Metadata);
+    EXPECT_EQ(page.Value().MinorVersion(), PageCodec::kMinorVersion);
+
+    const auto decoded = page.Value().ToMetadata();
+    ASSERT_EQ(decoded.size(), items.size());
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        SCOPED_TRACE(i);
+        ExpectSameMetadata(items[i], decoded[i]);
+    }
+}
+
+TEST(PageCodecTest, DetailsPageRoundTrips)
+{
+    std::vector<domain::MediaDetails> items;
+    for (int i = 0; i < 4; ++i)
+    {
+        items.push_back(MakeDetails(i));
+    }
+
+    const auto bytes = PageCodec::Encode(items);
+    const auto page = PageView::Open(bytes);
+    ASSERT_TRUE(page.IsOk()) << page.GetError().message;
+    EXPECT_EQ(page.Value().GetKind(), PageCodec::Kind::Details);
+
+    const auto decoded = page.Value().ToDetails();
+    ASSERT_EQ(decoded.size(), items.size());
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        SCOPED_TRACE(i);
+        ExpectSameMetadata(items[i], decoded[i]);
+        ExpectSameRatings(items[i].ratings, decoded[i].ratings);
+        ASSERT_EQ(decoded[i].reviews.size(), 1u);
+        EXPECT_EQ(decoded[i].reviews[0].author, items[i].reviews[0].author);
+        EXPECT_EQ(decoded[i].reviews[0].content, items[i].reviews[0].content);
+        EXPECT_EQ(decoded[i].reviews[0].source, items[i].reviews[0].source);
+        EXPECT_EQ(decoded[i].availableProviders, items[i].availableProviders);
+        ASSERT_EQ(decoded[i].episodes.size(), 1u);
+        EXPECT_EQ(decoded[i].episodes[0].title, items[i].episodes[0].title);
+        EXPECT_EQ(decoded[i].episodes[0].overview, items[i].episodes[0].overview);
+        EXPECT_EQ(decoded[i].episodes[0].episodeNumber, items[i].episodes[0].episodeNumber);
+        EXPECT_EQ(decoded[i].episodes[0].seasonNumber, items[i].episodes[0].seasonNumber);
+        EXPECT_EQ(decoded[i].episodes[0].airDate, items[i].episodes[0].airDate);
+        EXPECT_EQ(decoded[i].episodes[0].stillPath, items[i].episodes[0].stillPath);
+    }
+}
+
+TEST(PageCodecTest, EmptyPageRoundTrips)
+{
+    const auto page = PageView::Open(PageCodec::Encode(std::vector<domain::MediaMetadata>{}));
+    ASSERT_TRUE(page.IsOk());
+    EXPECT_TRUE(page.Value().empty());
+}
+
+TEST(PageCodecTest, MetadataPageReadsAsDetailsWithEmptyDetailsFields)
+{
+    const auto bytes = PageCodec::Encode(MakePage(3));
+    const auto details = PageView::Open(bytes).Value().ToDetails();
+    ASSERT_EQ(details.size(), 3u);
+    for (const auto &item : details)
+    {
+        EXPECT_TRUE(item.ratings.empty());
+        EXPECT_TRUE(item.reviews.empty());
+        EXPECT_TRUE(item.availableProviders.empty());
+        EXPECT_TRUE(item.episodes.empty());
+    }
+}
+
+TEST(PageCodecTest, ItemViewsPointIntoThePage)
+{
+    const auto items = MakePage(5);
+    const auto bytes = PageCodec::Encode(items);
+    const auto page = PageView::Open(bytes);
+    ASSERT_TRUE(page.IsOk());
+
+    const auto *begin = reinterpret_cast<const char *>(bytes.data());
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        const auto title = page.Value()[i].Title();
+        EXPECT_EQ(title, items[i].title);
+        EXPECT_GE(title.data(), begin);
+        EXPECT_LE(title.data() + title.size(), begin + bytes.size());
+    }
+}
+
+TEST(PageCodecTest, NewerMinorVersionSkipsTrailingFields)
+{
+    const auto items = MakePage(3);
+    auto bytes = PageCodec::Encode(items);
+
+    // One more byte at the end of the last record, as a newer writer would append a field
+    bytes[5] = PageCodec::kMinorVersion + 1;
+    bytes.push_back(0x42);
+    const uint32_t recordBytes = U32At(bytes, kRecordBytesAt) + 1;
+    PutU32(bytes, kRecordBytesAt, recordBytes);
+    PutU32(bytes, kItemIndexAt + 4 * items.size(), recordBytes);
+
+    const auto page = PageView::Open(bytes);
+    ASSERT_TRUE(page.IsOk()) << page.GetError().message;
+    EXPECT_EQ(page.Value().MinorVersion(), PageCodec::kMinorVersion + 1);
+    ExpectSameMetadata(items.back(), page.Value().ToMetadata().back());
+}
+
+TEST(PageViewTest, RejectsEveryTruncation)
+{
+    std::vector<domain::MediaDetails> items = {MakeDetails(0), MakeDetails(1)};
+    const auto bytes = PageCodec::Encode(items);
+    for (size_t size = 0; size < bytes.size(); ++size)
+    {
+        EXPECT_TRUE(PageView::Open(std::span(bytes.data(), size)).IsError()) << "truncated to " << size << " bytes";
+    }
+}
+
+TEST(PageViewTest, RejectsTrailingBytes)
+{
+    auto bytes = PageCodec::Encode(MakePage(2));
+    bytes.push_back(0);
+    EXPECT_TRUE(PageView::Open(bytes).IsError());
+}
+
+TEST(PageViewTest, RejectsOtherFormatsAndVersions)
+{
+    const auto bytes = PageCodec::Encode(MakePage(2));
+
+    auto json = bytes;
+    json[0] = '{';
+    EXPECT_FALSE(PageCodec::IsPage(json));
+    EXPECT_TRUE(PageView::Open(json).IsError());
+
+    auto major = bytes;
+    major[4] = PageCodec::kMajorVersion + 1;
+    EXPECT_FALSE(PageCodec::IsPage(major));
+    EXPECT_TRUE(PageView::Open(major).IsError());
+
+    auto kind = bytes;
+    kind[6] = 7;
+    EXPECT_TRUE(PageView::Open(kind).IsError());
+}
+
+TEST(PageViewTest, RejectsIndexesOutOfOrder)
+{
+    auto bytes = PageCodec::Encode(MakePage(3));
+    // The second item would start past the third
+    PutU32(bytes, kItemIndexAt + 4, U32At(bytes, kItemIndexAt + 8) + 1);
+    const auto page = PageView::Open(bytes);
+    ASSERT_TRUE(page.IsError());
+    EXPECT_EQ(page.GetError().message, "Corrupt media page index");
+}
+
+TEST(PageViewTest, RejectsCountsThatOverflow)
+{
+    auto bytes = PageCodec::Encode(MakePage(1));
+    PutU32(bytes, 8, 0xFFFFFFFF); // Item count
+    EXPECT_TRUE(PageView::Open(bytes).IsError());
+}
+
+TEST(PageViewTest, RejectsStringReferencesPastTheTable)
+{
+    auto bytes = PageCodec::Encode(MakePage(1));
+    // The record's id is its first string reference, after u16 present, u8 type, three f32
+    // and the one-byte vote count varint (0 for item 0)
+    const size_t records = bytes.size() - U32At(bytes, kRecordBytesAt);
+    const size_t idRef = records + 2 + 1 + 12 + 1;
+    ASSERT_LT(idRef, bytes.size());
+    bytes[idRef] = 0x7F; // A varint index beyond the few strings of this page
+    const auto page = PageView::Open(bytes);
+    ASSERT_TRUE(page.IsError());
+    EXPECT_EQ(page.GetError().message, "Corrupt media page record 0");
+}
+
+TEST(PageViewTest, CorruptBytesAreRejectedOrReadSafely)
+{
+    std::vector<domain::MediaDetails> items = {MakeDetails(0), MakeDetails(1), MakeDetails(2)};
+    const auto bytes = PageCodec::Encode(items);
+
+    // Whatever Open accepts must read back without running off the buffer; the sanitizer
+    // builds are what catch it if one does
+    std::mt19937 random(1);
+    for (int i = 0; i < 20000; ++i)
+    {
+        auto corrupt = bytes;
+        corrupt[random() % corrupt.size()] ^= static_cast<uint8_t>(1 + random() % 255);
+        const auto page = PageView::Open(corrupt);
+        if (page.IsOk())
+        {
+            EXPECT_EQ(page.Value().ToDetails().size(), items.size());
+        }
+    }
+}